@@ -18,7 +18,7 @@ interface DashQLModuleExports {
     dashql_script_parse: (ptr: number) => number;
     dashql_script_analyze: (ptr: number) => number;
     dashql_script_move_cursor: (ptr: number, offset: number) => number;
-    dashql_script_complete_at_cursor: (ptr: number, limit: number) => number;
+    dashql_script_complete_at_cursor: (ptr: number, limit: number, budgetMs: number) => number;
     dashql_script_get_statistics: (ptr: number) => number;
 
     dashql_catalog_new: (
@@ -30,6 +30,7 @@ interface DashQLModuleExports {
     dashql_catalog_describe_entries: (catalog_ptr: number) => number;
     dashql_catalog_describe_entries_of: (catalog_ptr: number, external_id: number) => number;
     dashql_catalog_flatten: (catalog_ptr: number) => number;
+    dashql_catalog_flatten_delta: (catalog_ptr: number, since_version: number) => number;
     dashql_catalog_load_script: (catalog_ptr: number, script_ptr: number, rank: number) => number;
     dashql_catalog_update_script: (catalog_ptr: number, script_ptr: number) => number;
     dashql_catalog_drop_script: (catalog_ptr: number, script_ptr: number) => void;
@@ -113,6 +114,7 @@ export class DashQL {
             dashql_script_complete_at_cursor: instance.exports['dashql_script_complete_at_cursor'] as (
                 ptr: number,
                 limit: number,
+                budgetMs: number,
             ) => number,
 
             dashql_catalog_new: instance.exports['dashql_catalog_new'] as (
@@ -131,6 +133,10 @@ export class DashQL {
             dashql_catalog_flatten: instance.exports['dashql_catalog_flatten'] as (
                 catalog_ptr: number,
             ) => number,
+            dashql_catalog_flatten_delta: instance.exports['dashql_catalog_flatten_delta'] as (
+                catalog_ptr: number,
+                since_version: number,
+            ) => number,
             dashql_catalog_load_script: instance.exports['dashql_catalog_load_script'] as (
                 catalog_ptr: number,
                 index: number,
@@ -558,10 +564,11 @@ export class DashQLScript {
         const resultPtr = this.ptr.api.instanceExports.dashql_script_move_cursor(scriptPtr, textOffset);
         return this.ptr.api.readFlatBufferResult<proto.ScriptCursor>(resultPtr, () => new proto.ScriptCursor());
     }
-    /// Complete at the cursor position
-    public completeAtCursor(limit: number): FlatBufferPtr<proto.Completion> {
+    /// Complete at the cursor position.
+    /// A non-zero budget bounds the completion time, the result is marked as partial if it was cut off.
+    public completeAtCursor(limit: number, budgetMs: number = 0): FlatBufferPtr<proto.Completion> {
         const scriptPtr = this.ptr.assertNotNull();
-        const resultPtr = this.ptr.api.instanceExports.dashql_script_complete_at_cursor(scriptPtr, limit);
+        const resultPtr = this.ptr.api.instanceExports.dashql_script_complete_at_cursor(scriptPtr, limit, budgetMs);
         return this.ptr.api.readFlatBufferResult<proto.Completion>(resultPtr, () => new proto.Completion());
     }
     /// Get the script statistics.
@@ -662,6 +669,12 @@ export class DashQLCatalog {
         this.snapshot = new DashQLCatalogSnapshot(snapshot);
         return this.snapshot;
     }
+    /// Flatten the changes of the catalog since a version
+    public flattenDelta(sinceVersion: number): FlatBufferPtr<proto.FlatCatalogDelta> {
+        const catalogPtr = this.ptr.assertNotNull();
+        const result = this.ptr.api.instanceExports.dashql_catalog_flatten_delta(catalogPtr, sinceVersion);
+        return this.ptr.api.readFlatBufferResult<proto.FlatCatalogDelta>(result, () => new proto.FlatCatalogDelta());
+    }
     /// Add a script in the registry
     public loadScript(script: DashQLScript, rank: number) {
         this.deleteSnapshot();
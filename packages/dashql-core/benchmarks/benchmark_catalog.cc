@@ -1,8 +1,15 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
 #include <format>
+#include <fstream>
 
 #include "benchmark/benchmark.h"
+#include "dashql/analyzer/completion.h"
 #include "dashql/catalog.h"
 #include "dashql/buffers/index_generated.h"
+#include "dashql/script.h"
 
 using namespace dashql;
 
@@ -56,7 +63,52 @@ std::tuple<std::span<const std::byte>, std::unique_ptr<const std::byte[]>, size_
     return {data_span, std::move(buffer_owned), buffer_size};
 }
 
-std::vector<Schema> generate_test_data(size_t schemas, size_t table_per_schema, size_t columns_per_table) {
+std::tuple<std::span<const std::byte>, std::unique_ptr<const std::byte[]>, size_t> pack_schemas(
+    const std::vector<Schema>& schemas) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<buffers::SchemaDescriptor>> descriptors;
+    std::vector<flatbuffers::Offset<buffers::SchemaTable>> tables;
+    std::vector<flatbuffers::Offset<buffers::SchemaTableColumn>> table_columns;
+    for (auto& schema : schemas) {
+        tables.clear();
+        for (auto& table : schema.tables) {
+            table_columns.clear();
+            for (auto& column : table.table_columns) {
+                auto column_name = fbb.CreateString(column.column_name);
+                buffers::SchemaTableColumnBuilder column_builder{fbb};
+                column_builder.add_column_name(column_name);
+                table_columns.push_back(column_builder.Finish());
+            }
+            auto table_columns_ofs = fbb.CreateVector(table_columns);
+            auto table_name_ofs = fbb.CreateString(table.table_name);
+            buffers::SchemaTableBuilder table_builder{fbb};
+            table_builder.add_table_name(table_name_ofs);
+            table_builder.add_columns(table_columns_ofs);
+            tables.push_back(table_builder.Finish());
+        }
+        auto tables_ofs = fbb.CreateVector(tables);
+        auto database_name = fbb.CreateString(schema.database_name);
+        auto schema_name = fbb.CreateString(schema.schema_name);
+        buffers::SchemaDescriptorBuilder descriptor_builder{fbb};
+        descriptor_builder.add_database_name(database_name);
+        descriptor_builder.add_schema_name(schema_name);
+        descriptor_builder.add_tables(tables_ofs);
+        descriptors.push_back(descriptor_builder.Finish());
+    }
+    auto descriptors_ofs = fbb.CreateVector(descriptors);
+    buffers::SchemaDescriptorsBuilder descriptors_builder{fbb};
+    descriptors_builder.add_schemas(descriptors_ofs);
+    fbb.Finish(descriptors_builder.Finish());
+    size_t buffer_size = 0;
+    size_t buffer_offset = 0;
+    auto buffer = fbb.ReleaseRaw(buffer_size, buffer_offset);
+    auto buffer_owned = std::unique_ptr<const std::byte[]>(reinterpret_cast<const std::byte*>(buffer));
+    std::span<const std::byte> data_span{buffer_owned.get() + buffer_offset, buffer_size - buffer_offset};
+    return {data_span, std::move(buffer_owned), buffer_size};
+}
+
+std::vector<Schema> generate_test_data(size_t schemas, size_t table_per_schema, size_t columns_per_table,
+                                       bool shared_column_names = false) {
     std::vector<Schema> out;
     for (size_t i = 0; i < schemas; ++i) {
         auto& schema = out.emplace_back();
@@ -67,7 +119,8 @@ std::vector<Schema> generate_test_data(size_t schemas, size_t table_per_schema,
             table.table_name = std::format("table_{}_{}", i, j);
             for (size_t k = 0; k < columns_per_table; ++k) {
                 auto& column = table.table_columns.emplace_back();
-                column.column_name = std::format("column_{}_{}_{}", i, j, k);
+                column.column_name =
+                    shared_column_names ? std::format("column_{}", k) : std::format("column_{}_{}_{}", i, j, k);
             }
         }
     }
@@ -94,6 +147,671 @@ static void catalog_update(benchmark::State& state) {
     }
 }
 
+static void catalog_load(benchmark::State& state) {
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2), state.range(3));
+    std::unique_ptr<buffers::CatalogStatisticsT> stats;
+
+    for (auto _ : state) {
+        Catalog catalog;
+        catalog.AddDescriptorPool(1, 1);
+        for (auto& schema : schemas) {
+            state.PauseTiming();
+            auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+            state.ResumeTiming();
+            catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+        }
+        state.PauseTiming();
+        stats = catalog.GetStatistics();
+        state.ResumeTiming();
+    }
+
+    // Report the memory footprint of the names
+    size_t name_registry_bytes = 0;
+    for (auto& entry : stats->entries) {
+        name_registry_bytes += entry->memory->name_registry_bytes();
+    }
+    state.counters["columns"] = stats->content->table_column_count();
+    state.counters["name_registry_bytes"] = name_registry_bytes;
+    state.counters["interned_names"] = stats->interned_names;
+    state.counters["interned_name_bytes"] = stats->interned_name_bytes;
+}
+
+static void catalog_load_parallel(benchmark::State& state) {
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2), true);
+    size_t worker_count = state.range(3);
+    auto [packed, packed_buffer, packed_buffer_size] = pack_schemas(schemas);
+    auto packed_offset = packed.data() - packed_buffer.get();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto catalog = std::make_unique<Catalog>();
+        catalog->AddDescriptorPool(1, 1);
+        auto buffer = std::make_unique<std::byte[]>(packed_buffer_size);
+        std::memcpy(buffer.get(), packed_buffer.get(), packed_buffer_size);
+        std::span<const std::byte> descriptor{buffer.get() + packed_offset, packed.size()};
+        state.ResumeTiming();
+        auto status = catalog->AddSchemaDescriptors(1, descriptor, std::move(buffer), packed_buffer_size, worker_count);
+        if (status != buffers::StatusCode::OK) {
+            state.SkipWithError("failed to load the schema descriptors");
+            break;
+        }
+        // Don't measure the teardown
+        state.PauseTiming();
+        catalog.reset();
+        state.ResumeTiming();
+    }
+    state.counters["tables"] = state.range(0) * state.range(1);
+    state.counters["workers"] = worker_count;
+}
+
+static void catalog_cold_start(benchmark::State& state) {
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2), true);
+    bool use_image = state.range(3) != 0;
+    auto [packed, packed_buffer, packed_buffer_size] = pack_schemas(schemas);
+    auto packed_offset = packed.data() - packed_buffer.get();
+    auto descriptor_path = (std::filesystem::temp_directory_path() / "dashql_benchmark_descriptors.fb").string();
+    auto image_path = (std::filesystem::temp_directory_path() / "dashql_benchmark_catalog.img").string();
+    {
+        std::ofstream out{descriptor_path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+    }
+    {
+        Catalog catalog;
+        catalog.AddDescriptorPool(1, 1);
+        auto buffer = std::make_unique<std::byte[]>(packed_buffer_size);
+        std::memcpy(buffer.get(), packed_buffer.get(), packed_buffer_size);
+        std::span<const std::byte> descriptor{buffer.get() + packed_offset, packed.size()};
+        catalog.AddSchemaDescriptors(1, descriptor, std::move(buffer), packed_buffer_size);
+        if (catalog.SaveImage(image_path) != buffers::StatusCode::OK) {
+            state.SkipWithError("failed to save the catalog image");
+            return;
+        }
+    }
+
+    // Measure the time until the catalog can serve completions
+    for (auto _ : state) {
+        auto catalog = std::make_unique<Catalog>();
+        buffers::StatusCode status;
+        if (use_image) {
+            status = catalog->LoadImage(image_path);
+        } else {
+            catalog->AddDescriptorPool(1, 1);
+            status = catalog->AddSchemaDescriptorsFile(1, descriptor_path);
+        }
+        if (status != buffers::StatusCode::OK) {
+            state.SkipWithError("failed to load the catalog");
+            break;
+        }
+        catalog->Iterate(
+            [](CatalogEntryID, CatalogEntry& entry) { benchmark::DoNotOptimize(entry.GetNameSearchIndex()); });
+        // Don't measure the teardown
+        state.PauseTiming();
+        catalog.reset();
+        state.ResumeTiming();
+    }
+    state.counters["tables"] = state.range(0) * state.range(1);
+    state.counters["image"] = use_image;
+    std::filesystem::remove(descriptor_path);
+    std::filesystem::remove(image_path);
+}
+
+static void catalog_attach_sessions(benchmark::State& state) {
+    std::vector<Schema> schemas = generate_test_data(100, 100, 10, true);
+    size_t session_count = state.range(0);
+    bool shared = state.range(1) != 0;
+    auto [packed, packed_buffer, packed_buffer_size] = pack_schemas(schemas);
+    auto packed_offset = packed.data() - packed_buffer.get();
+    auto load_pool = [&](std::shared_ptr<DescriptorPool> pool) {
+        auto buffer = std::make_unique<std::byte[]>(packed_buffer_size);
+        std::memcpy(buffer.get(), packed_buffer.get(), packed_buffer_size);
+        std::span<const std::byte> descriptor_data{buffer.get() + packed_offset, packed.size()};
+        auto& descriptor = *flatbuffers::GetRoot<buffers::SchemaDescriptors>(descriptor_data.data());
+        CatalogDatabaseID db_id;
+        CatalogSchemaID schema_id;
+        return pool->AddSchemaDescriptor(descriptor, descriptor_data, std::move(buffer), packed_buffer_size, db_id,
+                                         schema_id);
+    };
+
+    // Shared pools are loaded and frozen once for all sessions
+    std::shared_ptr<DescriptorPool> shared_pool;
+    if (shared) {
+        shared_pool = DescriptorPool::CreateShared(std::make_shared<SharedCatalogIds>(), 1, 1);
+        if (load_pool(shared_pool) != buffers::StatusCode::OK) {
+            state.SkipWithError("failed to load the schema descriptors");
+            return;
+        }
+        shared_pool->Freeze();
+    }
+    size_t name_index_names = 0;
+    size_t interned_name_bytes = 0;
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<Catalog>> sessions;
+        for (size_t i = 0; i < session_count; ++i) {
+            auto& catalog = *sessions.emplace_back(std::make_unique<Catalog>());
+            if (shared) {
+                catalog.AttachDescriptorPool(shared_pool);
+            } else {
+                auto pool = catalog.CreateDescriptorPool(1, 1);
+                load_pool(pool);
+                catalog.PublishDescriptorPool(std::move(pool));
+            }
+        }
+        // Don't measure the teardown
+        state.PauseTiming();
+        name_index_names = 0;
+        interned_name_bytes = 0;
+        for (auto& catalog : sessions) {
+            auto stats = catalog->GetStatistics();
+            name_index_names += stats->name_index_names;
+            interned_name_bytes += stats->interned_name_bytes;
+        }
+        sessions.clear();
+        state.ResumeTiming();
+    }
+    state.counters["sessions"] = session_count;
+    state.counters["name_index_names"] = name_index_names;
+    state.counters["interned_name_bytes"] = interned_name_bytes;
+}
+
+static void catalog_flatten(benchmark::State& state) {
+    Catalog catalog;
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2));
+    bool use_delta = state.range(3) != 0;
+    catalog.AddDescriptorPool(1, 1);
+    for (auto& schema : schemas) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+        catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    }
+    std::vector<Schema> changed = generate_test_data(1, 1, state.range(2));
+    changed[0].schema_name = "changed";
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(catalog.Flatten(fb));
+    auto flattened_version = catalog.GetVersion();
+
+    // Flatten the catalog after adding or dropping a small descriptor pool
+    bool add = true;
+    for (auto _ : state) {
+        state.PauseTiming();
+        if (add) {
+            catalog.AddDescriptorPool(2, 2);
+            auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(changed[0]);
+            catalog.AddSchemaDescriptor(2, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+        } else {
+            catalog.DropDescriptorPool(2);
+        }
+        add = !add;
+        fb.Clear();
+        state.ResumeTiming();
+
+        if (use_delta) {
+            fb.Finish(catalog.FlattenDelta(fb, flattened_version));
+        } else {
+            fb.Finish(catalog.Flatten(fb));
+        }
+        flattened_version = catalog.GetVersion();
+        benchmark::DoNotOptimize(fb.GetBufferPointer());
+    }
+    state.counters["tables"] = state.range(0) * state.range(1);
+    state.counters["delta"] = use_delta;
+}
+
+static void catalog_flatten_window(benchmark::State& state) {
+    Catalog catalog;
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2));
+    catalog.AddDescriptorPool(1, 1);
+    for (auto& schema : schemas) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+        catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    }
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(catalog.Flatten(fb));
+    auto flat = flatbuffers::GetRoot<buffers::FlatCatalog>(fb.GetBufferPointer());
+
+    // Expand the database, every 10th schema and every 10th table
+    Catalog::FlatCatalogExpansion expanded;
+    for (auto* database : *flat->databases()) {
+        expanded.databases.push_back(static_cast<CatalogDatabaseID>(database->catalog_object_id()));
+    }
+    for (size_t i = 0; i < flat->schemas()->size(); i += 10) {
+        expanded.schemas.push_back(static_cast<CatalogSchemaID>(flat->schemas()->Get(i)->catalog_object_id()));
+    }
+    for (size_t i = 0; i < flat->tables()->size(); i += 10) {
+        expanded.tables.push_back(flat->tables()->Get(i)->catalog_object_id());
+    }
+    fb.Clear();
+    fb.Finish(catalog.FlattenWindow(fb, expanded, 0, 0));
+    size_t row_count = flatbuffers::GetRoot<buffers::FlatCatalogWindow>(fb.GetBufferPointer())->row_count();
+    if (row_count == 0) {
+        state.SkipWithError("the catalog tree is empty");
+        return;
+    }
+
+    // Scroll through the tree, 100 rows at a time
+    size_t row_offset = 0;
+    for (auto _ : state) {
+        fb.Clear();
+        fb.Finish(catalog.FlattenWindow(fb, expanded, row_offset, 100));
+        benchmark::DoNotOptimize(fb.GetBufferPointer());
+        row_offset = (row_offset + 7919) % row_count;
+    }
+    state.counters["rows"] = row_count;
+}
+
+static void catalog_resolve_table(benchmark::State& state) {
+    Catalog catalog;
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2));
+    catalog.AddDescriptorPool(1, 1);
+    for (auto& schema : schemas) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+        catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    }
+
+    // Register the qualified table names, we resolve every table once per iteration
+    NameRegistry names;
+    std::vector<CatalogEntry::QualifiedTableName> table_names;
+    for (auto& schema : schemas) {
+        auto& db_name = names.Register(schema.database_name);
+        auto& schema_name = names.Register(schema.schema_name);
+        for (auto& table : schema.tables) {
+            table_names.emplace_back(std::nullopt, db_name, schema_name, names.Register(table.table_name));
+        }
+    }
+
+    for (auto _ : state) {
+        for (auto& table_name : table_names) {
+            auto* resolved = catalog.ResolveTable(table_name, 0);
+            benchmark::DoNotOptimize(resolved);
+        }
+    }
+    auto stats = catalog.GetStatistics();
+    state.SetItemsProcessed(state.iterations() * table_names.size());
+    state.counters["cache_hits"] = stats->resolution->table_cache_hits();
+    state.counters["lookups"] = stats->resolution->table_lookups();
+}
+
+static void catalog_resolve_miss(benchmark::State& state) {
+    size_t entry_count = state.range(0);
+    size_t mode = state.range(1);
+
+    // Every descriptor pool declares one table in the same schema
+    Catalog catalog;
+    for (size_t i = 0; i < entry_count; ++i) {
+        Schema schema{.database_name = "db", .schema_name = "schema"};
+        auto& table = schema.tables.emplace_back();
+        table.table_name = std::format("table_{}", i);
+        for (size_t k = 0; k < 10; ++k) {
+            table.table_columns.push_back(SchemaTableColumn{.column_name = std::format("column_{}_{}", i, k)});
+        }
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+        catalog.AddDescriptorPool(i + 1, i + 1);
+        catalog.AddSchemaDescriptor(i + 1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    }
+    Script script{catalog, static_cast<CatalogEntryID>(entry_count + 1)};
+    script.InsertTextAt(0, "select 1");
+    script.Scan();
+    script.Parse();
+    auto [analyzed, analyzer_status] = script.Analyze();
+    if (analyzer_status != buffers::StatusCode::OK) {
+        state.SkipWithError("failed to analyze the script");
+        return;
+    }
+
+    // Mode 0 and 1 resolve missing and existing columns, mode 2 resolves tables that only the ignored entry declares
+    std::vector<std::string> column_names;
+    NameRegistry names;
+    std::vector<CatalogEntry::QualifiedTableName> table_names;
+    auto& db_name = names.Register("db");
+    auto& schema_name = names.Register("schema");
+    for (size_t i = 0; i < 100; ++i) {
+        column_names.push_back(mode == 0 ? std::format("missing_{}", i) : std::format("column_{}_0", i));
+        table_names.emplace_back(std::nullopt, db_name, schema_name, names.Register(std::format("table_{}", i)));
+    }
+    std::vector<CatalogEntry::TableColumn> columns;
+    for (auto _ : state) {
+        if (mode == 2) {
+            for (size_t i = 0; i < table_names.size(); ++i) {
+                auto* resolved = catalog.ResolveTable(table_names[i], i + 1);
+                benchmark::DoNotOptimize(resolved);
+            }
+        } else {
+            for (auto& column_name : column_names) {
+                columns.clear();
+                analyzed->ResolveTableColumnsWithCatalog(catalog, column_name, columns);
+                benchmark::DoNotOptimize(columns.data());
+            }
+        }
+    }
+    auto stats = catalog.GetStatistics();
+    state.SetItemsProcessed(state.iterations() * column_names.size());
+    state.counters["entries"] = entry_count;
+    state.counters["filter_skips"] = stats->resolution->table_filter_skips();
+}
+
+static void catalog_name_index_build(benchmark::State& state) {
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2), state.range(3));
+    NameRegistry names;
+    for (auto& schema : schemas) {
+        names.Register(schema.database_name);
+        names.Register(schema.schema_name);
+        for (auto& table : schema.tables) {
+            names.Register(table.table_name);
+            for (auto& column : table.table_columns) {
+                names.Register(column.column_name);
+            }
+        }
+    }
+
+    auto layout = static_cast<CatalogEntry::NameSearchIndex::Layout>(state.range(4));
+
+    size_t index_entries = 0;
+    size_t index_bytes = 0;
+    for (auto _ : state) {
+        CatalogEntry::NameSearchIndex index{names, nullptr, layout};
+        index_entries = index.GetEntryCount();
+        index_bytes = index.GetByteSize();
+        benchmark::DoNotOptimize(index);
+    }
+    state.counters["names"] = names.GetSize();
+    state.counters["name_search_index_entries"] = index_entries;
+    state.counters["name_search_index_bytes"] = index_bytes;
+}
+
+static void catalog_name_search_index_lookup(benchmark::State& state) {
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2));
+    NameRegistry names;
+    for (auto& schema : schemas) {
+        for (auto& table : schema.tables) {
+            names.Register(table.table_name);
+            for (auto& column : table.table_columns) {
+                names.Register(column.column_name);
+            }
+        }
+    }
+    auto layout = static_cast<CatalogEntry::NameSearchIndex::Layout>(state.range(3));
+    CatalogEntry::NameSearchIndex index{names, nullptr, layout};
+
+    // Look up a substring that is shared by a few thousand names
+    std::string_view prefix = "_42_";
+    size_t matches = 0;
+    for (auto _ : state) {
+        matches = 0;
+        index.IteratePrefix(fuzzy_ci_string_view{prefix.data(), prefix.size()},
+                            [&](const RegisteredName&) { ++matches; });
+        benchmark::DoNotOptimize(matches);
+    }
+    state.counters["matches"] = matches;
+    state.counters["name_search_index_bytes"] = index.GetByteSize();
+}
+
+static void catalog_name_index_complete(benchmark::State& state) {
+    Catalog catalog;
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2), state.range(3));
+    catalog.AddDescriptorPool(1, 1);
+    for (auto& schema : schemas) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+        catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    }
+
+    // Complete a column name prefix
+    Script main{catalog, 2};
+    std::string_view text = "select column_4";
+    main.InsertTextAt(0, text);
+    main.Scan();
+    main.Parse();
+    main.Analyze();
+    main.MoveCursor(text.size());
+    // Build the name search indexes outside of the measurement
+    main.CompleteAtCursor(10);
+
+    for (auto _ : state) {
+        auto completion = main.CompleteAtCursor(10);
+        benchmark::DoNotOptimize(completion);
+    }
+
+    auto stats = catalog.GetStatistics();
+    size_t index_entries = 0;
+    size_t index_bytes = 0;
+    for (auto& entry : stats->entries) {
+        index_entries += entry->memory->name_search_index_entries();
+        index_bytes += entry->memory->name_search_index_bytes();
+    }
+    state.counters["columns"] = stats->content->table_column_count();
+    state.counters["name_search_index_entries"] = index_entries;
+    state.counters["name_search_index_bytes"] = index_bytes;
+}
+
+static void catalog_name_index_fuzzy(benchmark::State& state) {
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2), state.range(3));
+    NameRegistry names;
+    for (auto& schema : schemas) {
+        names.Register(schema.database_name);
+        names.Register(schema.schema_name);
+        for (auto& table : schema.tables) {
+            names.Register(table.table_name);
+            for (auto& column : table.table_columns) {
+                names.Register(column.column_name);
+            }
+        }
+    }
+    NameInterner interner;
+    CatalogNameIndex index{interner};
+    index.AddEntryNames(1, 0, names);
+
+    // Complete a column name prefix with a missing character
+    std::string_view query = "colmn_500_5";
+    std::vector<CatalogNameIndex::FuzzyMatch> matches;
+    for (auto _ : state) {
+        matches.clear();
+        index.FindFuzzyPrefixMatches(fuzzy_ci_string_view{query.data(), query.size()}, 2, matches);
+        benchmark::DoNotOptimize(matches);
+    }
+    state.counters["names"] = index.GetNameCount();
+    state.counters["matches"] = matches.size();
+}
+
+static void catalog_complete_typing(benchmark::State& state) {
+    Catalog catalog;
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2));
+    catalog.AddDescriptorPool(1, 1);
+    for (auto& schema : schemas) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+        catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    }
+    bool use_cache = state.range(3) != 0;
+
+    // Replay typing a column name, every keystroke is edited, analyzed and completed
+    std::string_view typed = "column_4_5_6";
+    std::string_view prefix = "select ";
+    std::vector<double> keystroke_micros;
+    for (auto _ : state) {
+        Script main{catalog, 2};
+        main.InsertTextAt(0, prefix);
+        main.InsertTextAt(prefix.size(), "\n");
+        size_t cursor_ofs = prefix.size();
+        for (auto c : typed) {
+            auto start = std::chrono::steady_clock::now();
+            main.InsertCharAt(cursor_ofs++, c);
+            main.Scan();
+            main.Parse();
+            main.Analyze();
+            main.MoveCursor(cursor_ofs);
+            if (use_cache) {
+                auto completion = main.CompleteAtCursor(10);
+                benchmark::DoNotOptimize(completion);
+            } else {
+                auto completion = Completion::Compute(*main.cursor, 10);
+                benchmark::DoNotOptimize(completion);
+            }
+            auto stop = std::chrono::steady_clock::now();
+            keystroke_micros.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+        }
+    }
+
+    // Report the per-keystroke latency distribution
+    std::sort(keystroke_micros.begin(), keystroke_micros.end());
+    auto percentile = [&](double p) {
+        return keystroke_micros[std::min<size_t>(keystroke_micros.size() - 1, keystroke_micros.size() * p)];
+    };
+    state.SetItemsProcessed(keystroke_micros.size());
+    state.counters["keystroke_median_us"] = percentile(0.5);
+    state.counters["keystroke_p99_us"] = percentile(0.99);
+}
+
+static void catalog_complete_concurrent(benchmark::State& state) {
+    // All sessions complete against the same catalog with 100k columns.
+    // The catalog is static since it has to outlive the sessions of all threads.
+    static Catalog catalog;
+    static bool loaded = [] {
+        catalog.AddDescriptorPool(1, 1);
+        for (auto& schema : generate_test_data(100, 100, 10)) {
+            auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+            catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+        }
+        return true;
+    }();
+    benchmark::DoNotOptimize(loaded);
+
+    // Every thread is a session that keeps typing a column name
+    std::string_view typed = "column_4_5_6";
+    std::string_view prefix = "select ";
+    Script main{catalog, static_cast<CatalogEntryID>(2 + state.thread_index())};
+    main.InsertTextAt(0, prefix);
+    main.InsertTextAt(prefix.size(), "\n");
+    size_t typed_chars = 0;
+    for (auto _ : state) {
+        if (typed_chars == typed.size()) {
+            main.EraseTextRange(prefix.size(), typed_chars);
+            typed_chars = 0;
+        }
+        main.InsertCharAt(prefix.size() + typed_chars, typed[typed_chars]);
+        ++typed_chars;
+        main.Scan();
+        main.Parse();
+        main.Analyze();
+        main.MoveCursor(prefix.size() + typed_chars);
+        auto completion = main.CompleteAtCursor(10);
+        benchmark::DoNotOptimize(completion);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void catalog_complete_single_char(benchmark::State& state) {
+    Catalog catalog;
+    std::vector<Schema> schemas = generate_test_data(state.range(0), state.range(1), state.range(2));
+    catalog.AddDescriptorPool(1, 1);
+    for (auto& schema : schemas) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+        catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    }
+
+    // A single character matches almost every name in the catalog, scoring and selection dominate
+    std::string_view text = "select c\n";
+    Script main{catalog, 2};
+    main.InsertTextAt(0, text);
+    main.Scan();
+    main.Parse();
+    main.Analyze();
+    main.MoveCursor(text.size() - 1);
+
+    size_t candidates = 0;
+    for (auto _ : state) {
+        auto [completion, status] = Completion::Compute(*main.cursor, 10);
+        candidates = completion->GetHeap().GetEntries().size();
+        benchmark::DoNotOptimize(completion);
+    }
+    state.counters["results"] = candidates;
+}
+
+static void catalog_complete_deadline(benchmark::State& state) {
+    Catalog catalog;
+    std::vector<Schema> schemas = generate_test_data(state.range(0), 100, 10);
+    catalog.AddDescriptorPool(1, 1);
+    for (auto& schema : schemas) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = pack_schema(schema);
+        catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    }
+    auto budget = std::chrono::microseconds{state.range(1)};
+
+    std::string_view text = "select c\n";
+    Script main{catalog, 2};
+    main.InsertTextAt(0, text);
+    main.Scan();
+    main.Parse();
+    main.Analyze();
+    main.MoveCursor(text.size() - 1);
+
+    // A zero budget completes without deadline
+    size_t partial = 0;
+    for (auto _ : state) {
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        if (budget.count() > 0) {
+            deadline = std::chrono::steady_clock::now() + budget;
+        }
+        auto [completion, status] = Completion::Compute(*main.cursor, 10, nullptr, deadline);
+        partial += completion->IsPartial();
+        benchmark::DoNotOptimize(completion);
+    }
+    state.counters["partial"] = benchmark::Counter(partial, benchmark::Counter::kAvgIterations);
+}
+
 BENCHMARK(catalog_update)->Args({1, 10, 10})->Args({50, 10, 10})->Args({100, 10, 10});
+BENCHMARK(catalog_load)
+    ->Args({100, 10, 10, 0})
+    ->Args({100, 10, 10, 1})
+    ->Args({1000, 10, 10, 0})
+    ->Args({1000, 10, 10, 1});
+// 50k tables with 10 columns each, loaded by 1 to 8 workers
+BENCHMARK(catalog_load_parallel)
+    ->ArgsProduct({{500}, {100}, {10}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+// Starting with 50k tables from descriptor files or a catalog image
+BENCHMARK(catalog_cold_start)
+    ->Args({500, 100, 10, 0})
+    ->Args({500, 100, 10, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+// 1 to 50 sessions with their own copy of 10k tables or attaching a shared frozen pool
+BENCHMARK(catalog_attach_sessions)
+    ->ArgsProduct({{1, 10, 50}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+// Flattening 100k tables completely or as delta after a small change
+BENCHMARK(catalog_flatten)
+    ->Args({1000, 100, 10, 0})
+    ->Args({1000, 100, 10, 1})
+    ->Unit(benchmark::kMicrosecond);
+// Scrolling through a tree with 1M columns
+BENCHMARK(catalog_flatten_window)->Args({1000, 100, 10})->Unit(benchmark::kMicrosecond);
+BENCHMARK(catalog_resolve_table)->Args({10, 100, 10})->Args({100, 100, 10})->Args({1000, 100, 10});
+// Missing columns, existing columns and tables that all but one of 500 entries don't declare
+BENCHMARK(catalog_resolve_miss)->ArgsProduct({{500}, {0, 1, 2}})->Unit(benchmark::kMicrosecond);
+// 100k columns with unique or shared column names
+BENCHMARK(catalog_name_index_build)
+    ->Args({100, 100, 10, 0, 0})
+    ->Args({100, 100, 10, 1, 0})
+    ->Args({100, 100, 10, 0, 1})
+    ->Args({100, 100, 10, 1, 1});
+// 1M column names with a suffix trie and a suffix array
+BENCHMARK(catalog_name_search_index_lookup)
+    ->Args({1000, 100, 10, 0})
+    ->Args({1000, 100, 10, 1})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(catalog_name_index_complete)->Args({100, 100, 10, 0})->Args({100, 100, 10, 1});
+// Typing with and without the completion cache
+BENCHMARK(catalog_complete_typing)->Args({100, 100, 10, 0})->Args({100, 100, 10, 1})->Unit(benchmark::kMillisecond);
+// Completions per second of 1 to 16 concurrent sessions
+BENCHMARK(catalog_complete_concurrent)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+// Completing a single character against 100k columns
+BENCHMARK(catalog_complete_single_char)->Args({100, 100, 10})->Unit(benchmark::kMicrosecond);
+// Completing with and without a 2ms budget as the catalog grows from 10k to 1M columns
+BENCHMARK(catalog_complete_deadline)
+    ->ArgsProduct({{10, 100, 1000}, {0, 2000}})
+    ->Unit(benchmark::kMillisecond);
+// 1M distinct column names
+BENCHMARK(catalog_name_index_fuzzy)->Args({1000, 100, 10, 0})->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,428 @@
+// Scaling benchmarks of the catalog with synthetic catalogs of 1k, 100k and 1M tables.
+//
+// The catalogs are generated deterministically as a single SchemaDescriptors buffer, every run sees the same names.
+// Run `make benchmark_catalog_scale` to write the results as JSON, or pass `--benchmark_format=json` directly.
+// The 1M tables take a few gigabytes of memory, use `--benchmark_filter` to skip them on small machines.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "dashql/analyzer/completion.h"
+#include "dashql/buffers/index_generated.h"
+#include "dashql/catalog.h"
+#include "dashql/script.h"
+
+using namespace dashql;
+
+namespace {
+
+/// The tables per schema
+constexpr size_t TABLES_PER_SCHEMA = 1000;
+/// The schemas per database
+constexpr size_t SCHEMAS_PER_DATABASE = 10;
+/// The columns per table
+constexpr size_t COLUMNS_PER_TABLE = 10;
+/// The number of distinct column names, column names repeat across tables like in real warehouses
+constexpr size_t DISTINCT_COLUMN_NAMES = 10000;
+/// The number of names that a lookup benchmark resolves per iteration
+constexpr size_t LOOKUPS_PER_ITERATION = 1024;
+/// The external id of the descriptor pool
+constexpr CatalogEntryID POOL_ID = 1;
+/// The external id of the benchmark scripts
+constexpr CatalogEntryID SCRIPT_ID = 2;
+
+/// Get the names of a synthetic table
+std::string GetDatabaseName(size_t table) {
+    return std::format("db_{}", table / TABLES_PER_SCHEMA / SCHEMAS_PER_DATABASE);
+}
+std::string GetSchemaName(size_t table) { return std::format("schema_{}", table / TABLES_PER_SCHEMA); }
+std::string GetTableName(size_t table) { return std::format("table_{}", table); }
+/// Get a column name of a synthetic table.
+/// 7919 is prime, the names of the columns within a table are therefore distinct.
+std::string GetColumnName(size_t table, size_t column) {
+    return std::format("col_{}", (table * 31 + column * 7919) % DISTINCT_COLUMN_NAMES);
+}
+
+/// A synthetic catalog
+struct SyntheticCatalog {
+    /// The number of tables
+    size_t table_count;
+    /// The descriptor buffer
+    std::unique_ptr<const std::byte[]> descriptor_buffer;
+    /// The descriptor buffer size
+    size_t descriptor_buffer_size = 0;
+    /// The offset of the descriptors in the buffer
+    size_t descriptor_offset = 0;
+    /// The size of the descriptors
+    size_t descriptor_size = 0;
+    /// The loaded catalog, shared by the benchmarks that only read the catalog
+    std::unique_ptr<Catalog> catalog;
+
+    /// Constructor
+    explicit SyntheticCatalog(size_t table_count) : table_count(table_count) {
+        flatbuffers::FlatBufferBuilder fbb;
+        std::vector<flatbuffers::Offset<buffers::SchemaDescriptor>> descriptors;
+        std::vector<flatbuffers::Offset<buffers::SchemaTable>> tables;
+        std::vector<flatbuffers::Offset<buffers::SchemaTableColumn>> columns;
+        for (size_t schema_begin = 0; schema_begin < table_count; schema_begin += TABLES_PER_SCHEMA) {
+            tables.clear();
+            auto schema_end = std::min(schema_begin + TABLES_PER_SCHEMA, table_count);
+            for (size_t table = schema_begin; table < schema_end; ++table) {
+                columns.clear();
+                for (size_t column = 0; column < COLUMNS_PER_TABLE; ++column) {
+                    auto column_name = fbb.CreateSharedString(GetColumnName(table, column));
+                    buffers::SchemaTableColumnBuilder column_builder{fbb};
+                    column_builder.add_column_name(column_name);
+                    column_builder.add_ordinal_position(column);
+                    columns.push_back(column_builder.Finish());
+                }
+                auto columns_ofs = fbb.CreateVector(columns);
+                auto table_name = fbb.CreateString(GetTableName(table));
+                buffers::SchemaTableBuilder table_builder{fbb};
+                table_builder.add_table_name(table_name);
+                table_builder.add_columns(columns_ofs);
+                tables.push_back(table_builder.Finish());
+            }
+            auto tables_ofs = fbb.CreateVector(tables);
+            auto database_name = fbb.CreateSharedString(GetDatabaseName(schema_begin));
+            auto schema_name = fbb.CreateString(GetSchemaName(schema_begin));
+            buffers::SchemaDescriptorBuilder descriptor_builder{fbb};
+            descriptor_builder.add_database_name(database_name);
+            descriptor_builder.add_schema_name(schema_name);
+            descriptor_builder.add_tables(tables_ofs);
+            descriptors.push_back(descriptor_builder.Finish());
+        }
+        auto descriptors_ofs = fbb.CreateVector(descriptors);
+        buffers::SchemaDescriptorsBuilder descriptors_builder{fbb};
+        descriptors_builder.add_schemas(descriptors_ofs);
+        fbb.Finish(descriptors_builder.Finish());
+        auto buffer = fbb.ReleaseRaw(descriptor_buffer_size, descriptor_offset);
+        descriptor_buffer.reset(reinterpret_cast<const std::byte*>(buffer));
+        descriptor_size = descriptor_buffer_size - descriptor_offset;
+    }
+
+    /// Load the descriptors into a catalog, using a copy of the descriptor buffer
+    buffers::StatusCode Load(Catalog& target, size_t worker_count) const {
+        auto copy = std::make_unique<std::byte[]>(descriptor_buffer_size);
+        std::memcpy(copy.get(), descriptor_buffer.get(), descriptor_buffer_size);
+        std::unique_ptr<const std::byte[]> buffer{std::move(copy)};
+        std::span<const std::byte> descriptor{buffer.get() + descriptor_offset, descriptor_size};
+        if (auto status = target.AddDescriptorPool(POOL_ID, 1); status != buffers::StatusCode::OK) {
+            return status;
+        }
+        return target.AddSchemaDescriptors(POOL_ID, descriptor, std::move(buffer), descriptor_buffer_size,
+                                           worker_count);
+    }
+    /// Get the loaded catalog
+    Catalog* GetCatalog() {
+        if (!catalog) {
+            catalog = std::make_unique<Catalog>();
+            if (Load(*catalog, GetWorkerCount()) != buffers::StatusCode::OK) {
+                catalog.reset();
+            }
+        }
+        return catalog.get();
+    }
+    /// Get the tables that the lookup benchmarks resolve, spread evenly across the catalog
+    std::vector<size_t> SampleTables() const {
+        std::vector<size_t> out;
+        for (size_t i = 0; i < LOOKUPS_PER_ITERATION; ++i) {
+            out.push_back(i * table_count / LOOKUPS_PER_ITERATION);
+        }
+        return out;
+    }
+
+    /// Get the number of workers for loading descriptors
+    static size_t GetWorkerCount() { return std::max<size_t>(std::thread::hardware_concurrency(), 1); }
+    /// Get a synthetic catalog, catalogs are generated once per size
+    static SyntheticCatalog& Get(size_t table_count) {
+        static std::map<size_t, std::unique_ptr<SyntheticCatalog>> catalogs;
+        auto& catalog = catalogs[table_count];
+        if (!catalog) {
+            catalog = std::make_unique<SyntheticCatalog>(table_count);
+        }
+        return *catalog;
+    }
+};
+
+/// Get a percentile of sorted latencies
+double GetPercentile(const std::vector<double>& sorted, double p) {
+    return sorted.empty() ? 0 : sorted[std::min<size_t>(sorted.size() - 1, sorted.size() * p)];
+}
+
+/// Measure the latency of a function in microseconds
+template <typename Fn> double MeasureMicros(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+/// Analyze a script
+buffers::StatusCode AnalyzeScript(Script& script) {
+    if (auto status = script.Scan().second; status != buffers::StatusCode::OK) {
+        return status;
+    }
+    if (auto status = script.Parse().second; status != buffers::StatusCode::OK) {
+        return status;
+    }
+    return script.Analyze().second;
+}
+
+}  // namespace
+
+static void scale_load(benchmark::State& state) {
+    auto& synthetic = SyntheticCatalog::Get(state.range(0));
+    auto worker_count = SyntheticCatalog::GetWorkerCount();
+    std::unique_ptr<buffers::CatalogStatisticsT> stats;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto catalog = std::make_unique<Catalog>();
+        state.ResumeTiming();
+        if (synthetic.Load(*catalog, worker_count) != buffers::StatusCode::OK) {
+            state.SkipWithError("failed to load the schema descriptors");
+            break;
+        }
+        // Don't measure the statistics and the teardown
+        state.PauseTiming();
+        stats = catalog->GetStatistics();
+        catalog.reset();
+        state.ResumeTiming();
+    }
+    if (!stats) {
+        return;
+    }
+
+    // Report the memory footprint
+    size_t descriptor_bytes = 0;
+    size_t name_registry_bytes = 0;
+    size_t name_search_index_bytes = 0;
+    size_t name_filter_bytes = 0;
+    for (auto& entry : stats->entries) {
+        descriptor_bytes += entry->memory->descriptor_buffer_bytes();
+        name_registry_bytes += entry->memory->name_registry_bytes();
+        name_search_index_bytes += entry->memory->name_search_index_bytes();
+        name_filter_bytes += entry->memory->name_filter_bytes();
+    }
+    state.counters["tables"] = stats->content->table_count();
+    state.counters["columns"] = stats->content->table_column_count();
+    state.counters["workers"] = worker_count;
+    state.counters["descriptor_bytes"] = descriptor_bytes;
+    state.counters["name_registry_bytes"] = name_registry_bytes;
+    state.counters["name_search_index_bytes"] = name_search_index_bytes;
+    state.counters["name_filter_bytes"] = name_filter_bytes;
+    state.counters["interned_name_bytes"] = stats->interned_name_bytes;
+    state.counters["name_index_names"] = stats->name_index_names;
+    state.counters["name_index_suffixes"] = stats->name_index_suffixes;
+}
+
+static void scale_resolve_table(benchmark::State& state) {
+    auto& synthetic = SyntheticCatalog::Get(state.range(0));
+    bool miss = state.range(1) != 0;
+    auto* catalog = synthetic.GetCatalog();
+    if (!catalog) {
+        state.SkipWithError("failed to load the schema descriptors");
+        return;
+    }
+
+    // Misses look for existing table names in the next schema.
+    // All names are known to the catalog, the lookup is only answered by the schema.
+    NameRegistry names;
+    std::vector<CatalogEntry::QualifiedTableName> table_names;
+    for (auto table : synthetic.SampleTables()) {
+        auto schema_table = miss ? (table + TABLES_PER_SCHEMA) % synthetic.table_count : table;
+        auto& db_name = names.Register(GetDatabaseName(schema_table));
+        auto& schema_name = names.Register(GetSchemaName(schema_table));
+        table_names.emplace_back(std::nullopt, db_name, schema_name, names.Register(GetTableName(table)));
+    }
+    size_t resolved_count = 0;
+    for (auto _ : state) {
+        resolved_count = 0;
+        for (auto& table_name : table_names) {
+            auto* resolved = catalog->ResolveTable(table_name, SCRIPT_ID);
+            resolved_count += resolved != nullptr;
+            benchmark::DoNotOptimize(resolved);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * table_names.size());
+    state.counters["resolved"] = resolved_count;
+}
+
+static void scale_resolve_column(benchmark::State& state) {
+    auto& synthetic = SyntheticCatalog::Get(state.range(0));
+    bool miss = state.range(1) != 0;
+    auto* catalog = synthetic.GetCatalog();
+    if (!catalog) {
+        state.SkipWithError("failed to load the schema descriptors");
+        return;
+    }
+    Script script{*catalog, SCRIPT_ID};
+    script.InsertTextAt(0, "select 1");
+    if (AnalyzeScript(script) != buffers::StatusCode::OK) {
+        state.SkipWithError("failed to analyze the script");
+        return;
+    }
+
+    // Resolve unqualified column names against all catalog entries
+    std::vector<std::string> column_names;
+    for (auto table : synthetic.SampleTables()) {
+        column_names.push_back(miss ? std::format("missing_{}", table) : GetColumnName(table, 0));
+    }
+    std::vector<CatalogEntry::TableColumn> columns;
+    size_t resolved_count = 0;
+    for (auto _ : state) {
+        resolved_count = 0;
+        for (auto& column_name : column_names) {
+            columns.clear();
+            script.analyzed_script->ResolveTableColumnsWithCatalog(*catalog, column_name, columns);
+            resolved_count += columns.size();
+            benchmark::DoNotOptimize(columns.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * column_names.size());
+    state.counters["resolved"] = resolved_count;
+}
+
+static void scale_flatten(benchmark::State& state) {
+    auto& synthetic = SyntheticCatalog::Get(state.range(0));
+    bool use_delta = state.range(1) != 0;
+    auto* catalog = synthetic.GetCatalog();
+    if (!catalog) {
+        state.SkipWithError("failed to load the schema descriptors");
+        return;
+    }
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(catalog->Flatten(fb));
+    auto flattened_version = catalog->GetVersion();
+
+    // Flatten the catalog after loading or dropping a small schema script
+    Script script{*catalog, SCRIPT_ID};
+    script.InsertTextAt(0, "create table db_0.schema_0.flatten_table (a integer, b integer)");
+    if (AnalyzeScript(script) != buffers::StatusCode::OK) {
+        state.SkipWithError("failed to analyze the script");
+        return;
+    }
+    bool load = true;
+    size_t flat_bytes = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        if (load) {
+            catalog->LoadScript(script, 0);
+        } else {
+            catalog->DropScript(script);
+        }
+        load = !load;
+        fb.Clear();
+        state.ResumeTiming();
+
+        if (use_delta) {
+            fb.Finish(catalog->FlattenDelta(fb, flattened_version));
+        } else {
+            fb.Finish(catalog->Flatten(fb));
+        }
+        flattened_version = catalog->GetVersion();
+        flat_bytes = fb.GetSize();
+        benchmark::DoNotOptimize(fb.GetBufferPointer());
+    }
+    catalog->DropScript(script);
+    state.counters["flat_bytes"] = flat_bytes;
+}
+
+static void scale_script_churn(benchmark::State& state) {
+    auto& synthetic = SyntheticCatalog::Get(state.range(0));
+    auto* catalog = synthetic.GetCatalog();
+    if (!catalog) {
+        state.SkipWithError("failed to load the schema descriptors");
+        return;
+    }
+
+    // A schema script that declares a table next to the catalog tables and queries both
+    auto make_text = [](size_t column_count) {
+        std::string text = "create table db_0.schema_0.churn_table (";
+        for (size_t i = 0; i < column_count; ++i) {
+            text += std::format("{}churn_{} integer", i == 0 ? "" : ", ", i);
+        }
+        text += ");\nselect * from db_0.schema_0.churn_table c, db_0.schema_0.table_1 t where c.churn_0 = t.col_0;";
+        return text;
+    };
+    std::vector<double> load_micros;
+    std::vector<double> update_micros;
+    std::vector<double> drop_micros;
+    for (auto _ : state) {
+        Script script{*catalog, SCRIPT_ID};
+        script.InsertTextAt(0, make_text(4));
+        AnalyzeScript(script);
+        load_micros.push_back(MeasureMicros([&]() { catalog->LoadScript(script, 0); }));
+        script.ReplaceText(make_text(5));
+        AnalyzeScript(script);
+        update_micros.push_back(MeasureMicros([&]() { catalog->LoadScript(script, 0); }));
+        drop_micros.push_back(MeasureMicros([&]() { catalog->DropScript(script); }));
+    }
+    std::sort(load_micros.begin(), load_micros.end());
+    std::sort(update_micros.begin(), update_micros.end());
+    std::sort(drop_micros.begin(), drop_micros.end());
+    state.counters["load_median_us"] = GetPercentile(load_micros, 0.5);
+    state.counters["update_median_us"] = GetPercentile(update_micros, 0.5);
+    state.counters["drop_median_us"] = GetPercentile(drop_micros, 0.5);
+    state.counters["update_p99_us"] = GetPercentile(update_micros, 0.99);
+}
+
+static void scale_complete(benchmark::State& state) {
+    auto& synthetic = SyntheticCatalog::Get(state.range(0));
+    auto* catalog = synthetic.GetCatalog();
+    if (!catalog) {
+        state.SkipWithError("failed to load the schema descriptors");
+        return;
+    }
+
+    // Replay typing a column name, every keystroke is edited, analyzed and completed
+    std::string_view prefix = "select * from db_0.schema_0.table_1 where ";
+    std::string_view typed = "col_123";
+    std::vector<double> keystroke_micros;
+    for (auto _ : state) {
+        Script main{*catalog, SCRIPT_ID};
+        main.InsertTextAt(0, prefix);
+        main.InsertTextAt(prefix.size(), "\n");
+        size_t cursor_ofs = prefix.size();
+        for (auto c : typed) {
+            keystroke_micros.push_back(MeasureMicros([&]() {
+                main.InsertCharAt(cursor_ofs++, c);
+                AnalyzeScript(main);
+                main.MoveCursor(cursor_ofs);
+                auto completion = main.CompleteAtCursor(10);
+                benchmark::DoNotOptimize(completion);
+            }));
+        }
+    }
+    std::sort(keystroke_micros.begin(), keystroke_micros.end());
+    state.SetItemsProcessed(keystroke_micros.size());
+    state.counters["keystroke_median_us"] = GetPercentile(keystroke_micros, 0.5);
+    state.counters["keystroke_p99_us"] = GetPercentile(keystroke_micros, 0.99);
+}
+
+// 1k, 100k and 1M tables with 10 columns each
+BENCHMARK(scale_load)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+// Table hits and misses
+BENCHMARK(scale_resolve_table)->ArgsProduct({{1000, 100000, 1000000}, {0, 1}})->Unit(benchmark::kMicrosecond);
+// Unqualified column hits and misses
+BENCHMARK(scale_resolve_column)->ArgsProduct({{1000, 100000, 1000000}, {0, 1}})->Unit(benchmark::kMicrosecond);
+// Flattening completely or as delta after loading or dropping a script
+BENCHMARK(scale_flatten)->ArgsProduct({{1000, 100000, 1000000}, {0, 1}})->Unit(benchmark::kMillisecond);
+// Loading, updating and dropping a schema script
+BENCHMARK(scale_script_churn)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+// Typing a column name with completion after every keystroke
+BENCHMARK(scale_complete)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -692,9 +692,51 @@ static void complete_cursor(benchmark::State& state) {
     }
 }
 
+static void complete_after_edit(benchmark::State& state) {
+    Catalog catalog;
+    Script external{catalog, 2};
+    external.InsertTextAt(0, external_script);
+    external.Scan();
+    external.Parse();
+    external.Analyze();
+    catalog.LoadScript(external, 0);
+
+    Script main{catalog, 1};
+    main.InsertTextAt(0, main_script);
+    main.Scan();
+    main.Parse();
+    main.Analyze();
+
+    std::string_view text = ",customer";
+    auto text_offset = main.scanned_script->text_buffer.find(text);
+    text_offset += text.size();
+    main.MoveCursor(text_offset);
+    main.CompleteAtCursor(10);
+
+    // Alternately append and remove a character at the cursor.
+    // Measures the edit, the analysis and the first completion after the edit.
+    bool appended = false;
+    for (auto _ : state) {
+        if (appended) {
+            main.EraseTextRange(text_offset, 1);
+        } else {
+            main.InsertCharAt(text_offset, 'x');
+        }
+        auto cursor_offset = text_offset + (appended ? 0 : 1);
+        appended = !appended;
+        main.Scan();
+        main.Parse();
+        main.Analyze();
+        main.MoveCursor(cursor_offset);
+        auto completion = main.CompleteAtCursor(10);
+        benchmark::DoNotOptimize(completion);
+    }
+}
+
 BENCHMARK(scan_query);
 BENCHMARK(parse_query);
 BENCHMARK(analyze_query);
 BENCHMARK(move_cursor);
 BENCHMARK(complete_cursor);
+BENCHMARK(complete_after_edit);
 BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+#include <format>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "dashql/catalog.h"
+#include "dashql/script.h"
+#include "dashql/search/search_index.h"
+
+using namespace dashql;
+
+namespace {
+
+/// A corpus of scanned scripts
+struct Corpus {
+    /// The catalog
+    Catalog catalog;
+    /// The scripts
+    std::vector<std::unique_ptr<Script>> scripts;
+    /// The file names
+    std::vector<std::string> file_names;
+
+    /// Constructor
+    Corpus(size_t file_count) {
+        for (size_t i = 0; i < file_count; ++i) {
+            auto text = std::format(
+                "-- report {0}\n"
+                "select t{0}.customer_id, t{0}.order_{1}_total, sum(t{0}.amount_{2}) as revenue_{0}\n"
+                "from sales_{3}.orders_{1} t{0}\n"
+                "where t{0}.region = 'region_{2}' and t{0}.order_date > date '2024-01-01'\n"
+                "group by t{0}.customer_id, t{0}.order_{1}_total\n",
+                i, i % 100, i % 10, i % 1000);
+            auto& script = scripts.emplace_back(std::make_unique<Script>(catalog, static_cast<CatalogEntryID>(i + 1)));
+            script->InsertTextAt(0, text);
+            script->Scan();
+            file_names.push_back(std::format("file_{}.sql", i));
+        }
+    }
+    /// Build a search index over the corpus
+    void Index(SearchIndex& index) {
+        for (size_t i = 0; i < scripts.size(); ++i) {
+            index.AddFile(file_names[i], *scripts[i]->scanned_script);
+        }
+    }
+};
+
+}  // namespace
+
+static void search_index_build(benchmark::State& state) {
+    Corpus corpus{static_cast<size_t>(state.range(0))};
+    size_t trigrams = 0;
+    for (auto _ : state) {
+        SearchIndex index;
+        corpus.Index(index);
+        trigrams = index.GetTrigramCount();
+        benchmark::DoNotOptimize(index);
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.scripts.size());
+    state.counters["trigrams"] = trigrams;
+}
+
+static void search_index_query(benchmark::State& state, std::string_view query) {
+    Corpus corpus{static_cast<size_t>(state.range(0))};
+    SearchIndex index;
+    corpus.Index(index);
+    size_t matches = 0;
+    for (auto _ : state) {
+        auto result = index.SearchFile(query, 1000);
+        matches = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["matches"] = matches;
+}
+
+static void search_index_query_after_removal(benchmark::State& state) {
+    Corpus corpus{static_cast<size_t>(state.range(0))};
+    SearchIndex index;
+    corpus.Index(index);
+    // Remove every third file, leaving tombstones
+    for (size_t i = 0; i < corpus.scripts.size(); i += 3) {
+        index.RemoveFile(corpus.file_names[i]);
+    }
+    bool compact = state.range(1) != 0;
+    if (compact) {
+        index.Compact();
+    }
+    size_t matches = 0;
+    for (auto _ : state) {
+        auto result = index.SearchFile("revenue_12", 1000);
+        matches = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["matches"] = matches;
+    state.counters["tombstones"] = index.GetTombstoneCount();
+}
+
+// Index 10k scripts
+BENCHMARK(search_index_build)->Arg(10000)->Unit(benchmark::kMillisecond);
+// A selective query, a frequent query and a short query without trigrams
+BENCHMARK_CAPTURE(search_index_query, selective, "revenue_4242")->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(search_index_query, frequent, "customer_id")->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(search_index_query, short, "t1")->Arg(10000)->Unit(benchmark::kMicrosecond);
+// Searching with tombstones and after compaction
+BENCHMARK(search_index_query_after_removal)->Args({10000, 0})->Args({10000, 1})->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -29,11 +29,12 @@ struct Analyzer {
 
    public:
     /// Constructor
-    Analyzer(std::shared_ptr<ParsedScript> parsed, Catalog& catalog);
+    Analyzer(std::shared_ptr<ParsedScript> parsed, Catalog& catalog, const AnalyzedScript* previous = nullptr);
 
-    /// Analyze a program
-    static std::pair<std::shared_ptr<AnalyzedScript>, buffers::StatusCode> Analyze(std::shared_ptr<ParsedScript> parsed,
-                                                                                 Catalog& catalog);
+    /// Analyze a program.
+    /// If the previous analysis of the same script is provided, table ids of unchanged table declarations are kept.
+    static std::pair<std::shared_ptr<AnalyzedScript>, buffers::StatusCode> Analyze(
+        std::shared_ptr<ParsedScript> parsed, Catalog& catalog, const AnalyzedScript* previous = nullptr);
 };
 
 }  // namespace dashql
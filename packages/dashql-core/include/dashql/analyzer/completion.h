@@ -1,5 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
 #include "dashql/catalog_object.h"
 #include "dashql/buffers/index_generated.h"
 #include "dashql/script.h"
@@ -8,9 +15,42 @@
 
 namespace dashql {
 
+/// The catalog names that were found by the last completion of a script.
+/// When the user keeps typing the same symbol, the cursor prefix only grows and the names matching the new prefix
+/// are a subset of the cached names. Completion then filters the cached names instead of probing the name index.
+struct CompletionCache {
+    /// The catalog version
+    Catalog::Version catalog_version = 0;
+    /// The statement id of the cursor
+    std::optional<uint32_t> statement_id;
+    /// The text offset of the completed symbol
+    uint32_t symbol_offset = 0;
+    /// The expected parser symbols
+    std::vector<parser::Parser::ExpectedSymbol> expected_symbols;
+    /// The lowercase search text
+    std::string search_text;
+    /// The names in the catalog name index that contain the search text
+    std::vector<const CatalogNameIndex::NamePostings*> catalog_names;
+    /// The number of refined completions
+    size_t hits = 0;
+    /// The number of completions that had to probe the name index
+    size_t misses = 0;
+
+    /// Can we refine the cached names for a new search text?
+    bool CanRefine(Catalog::Version version, std::optional<uint32_t> statement, uint32_t symbol,
+                   std::span<const parser::Parser::ExpectedSymbol> expected, fuzzy_ci_string_view text) const {
+        return !catalog_names.empty() && catalog_version == version && statement_id == statement &&
+               symbol_offset == symbol && std::equal(expected.begin(), expected.end(), expected_symbols.begin(),
+                                                     expected_symbols.end()) &&
+               text.starts_with(fuzzy_ci_string_view{search_text.data(), search_text.size()});
+    }
+};
+
 struct Completion {
     /// A score value
     using ScoreValueType = uint32_t;
+    /// A point in time at which candidate collection stops
+    using Deadline = std::chrono::steady_clock::time_point;
     /// A bitset for candidate tags
     using CandidateTags = EnumBitset<uint16_t, buffers::CandidateTag, buffers::CandidateTag::MAX>;
 
@@ -42,6 +82,8 @@ struct Completion {
         IntrusiveList<CandidateCatalogObject> catalog_objects;
         /// The score (if computed)
         ScoreValueType score = 0;
+        /// The edit distance to the cursor prefix, 0 unless the candidate was only found with typos
+        uint32_t edit_distance = 0;
         /// Is less in the min-heap?
         /// We want to kick a candidate A before candidate B if
         ///     1) the score of A is less than the score of B
@@ -66,14 +108,21 @@ struct Completion {
         std::optional<std::reference_wrapper<RegisteredName>> name;
     };
 
-    /// Helper to find candidates in an index
-    void findCandidatesInIndex(const CatalogEntry::NameSearchIndex& index, bool through_catalog);
-
    protected:
     /// The script cursor
     const ScriptCursor& cursor;
+    /// The pinned catalog snapshot, candidates point into its descriptor pools
+    std::shared_ptr<const Catalog::Snapshot> catalog_snapshot;
     /// The completion strategy
     const buffers::CompletionStrategy strategy;
+    /// The completion cache of the script (if any)
+    CompletionCache* cache;
+    /// The deadline (if any)
+    std::optional<Deadline> deadline;
+    /// The number of candidate visits since the last deadline check
+    size_t visits_since_deadline_check = 0;
+    /// Did we stop collecting candidates at the deadline?
+    bool partial = false;
 
     /// The candidate buffer
     ChunkBuffer<Candidate, 16> candidates;
@@ -90,12 +139,19 @@ struct Completion {
     /// The result heap, holding up to k entries
     TopKHeap<Candidate> result_heap;
 
+    /// Check if the deadline passed, marks the completion as partial.
+    /// Reading the clock is not free, so only every n-th call checks the time unless forced.
+    bool DeadlineExceeded(bool force = false);
     /// Read the name path of the current cursor
     std::vector<Completion::NameComponent> ReadCursorNamePath(sx::Location& name_path_loc) const;
     /// Complete after a dot
     void FindCandidatesForNamePath();
+    /// Add a name that matched the cursor prefix as candidate.
+    /// A non-zero edit distance marks names that only matched the prefix with typos.
+    void AddNameCandidate(const RegisteredName& name, fuzzy_ci_string_view prefix, bool through_catalog,
+                          uint32_t edit_distance = 0);
     /// Find the candidates in completion indexes
-    void FindCandidatesInIndexes();
+    void FindCandidatesInIndexes(std::span<const parser::Parser::ExpectedSymbol> expected_symbols);
     /// Promote tables that contain column names that are still unresolved in the current statement
     void PromoteTablesAndPeersForUnresolvedColumns();
     /// Add expected keywords in the grammar directly to the result heap.
@@ -108,7 +164,8 @@ struct Completion {
 
    public:
     /// Constructor
-    Completion(const ScriptCursor& cursor, size_t k);
+    Completion(const ScriptCursor& cursor, size_t k, CompletionCache* cache = nullptr,
+               std::optional<Deadline> deadline = std::nullopt);
 
     /// Get the cursor
     auto& GetCursor() const { return cursor; }
@@ -116,11 +173,17 @@ struct Completion {
     auto& GetStrategy() const { return strategy; }
     /// Get the result heap
     auto& GetHeap() const { return result_heap; }
+    /// Is the result partial since we stopped at the deadline?
+    bool IsPartial() const { return partial; }
 
     /// Pack the completion result
     flatbuffers::Offset<buffers::Completion> Pack(flatbuffers::FlatBufferBuilder& builder);
-    // Compute completion at a cursor
-    static std::pair<std::unique_ptr<Completion>, buffers::StatusCode> Compute(const ScriptCursor& cursor, size_t k);
+    // Compute completion at a cursor.
+    // With a deadline, candidates are collected from the script first and then from the catalog entries in rank
+    // order until the deadline passes.
+    static std::pair<std::unique_ptr<Completion>, buffers::StatusCode> Compute(
+        const ScriptCursor& cursor, size_t k, CompletionCache* cache = nullptr,
+        std::optional<Deadline> deadline = std::nullopt);
 };
 
 }  // namespace dashql
@@ -45,6 +45,8 @@ class NameResolutionPass : public PassManager::LTRPass {
     Catalog& catalog;
     /// The attribute index
     AttributeIndex& attribute_index;
+    /// The previous analysis of the same script (if any)
+    const AnalyzedScript* previous;
     /// The ast
     std::span<const buffers::Node> ast;
 
@@ -93,12 +95,15 @@ class NameResolutionPass : public PassManager::LTRPass {
     /// Resolve all column refs in a scope
     void ResolveColumnRefsInScope(AnalyzedScript::NameScope& scope, ColumnRefsByAlias& refs_by_alias,
                                   ColumnRefsByName& refs_by_name);
+    /// Assign stable table ids that reuse the ids of the previous analysis
+    void AssignStableTableIds();
     /// Resolve all names
     void ResolveNames();
 
    public:
     /// Constructor
-    NameResolutionPass(AnalyzedScript& script, Catalog& registry, AttributeIndex& attribute_index);
+    NameResolutionPass(AnalyzedScript& script, Catalog& registry, AttributeIndex& attribute_index,
+                       const AnalyzedScript* previous = nullptr);
 
     /// Prepare the analysis pass
     void Prepare() override;
@@ -58,8 +58,8 @@ extern "C" FFIResult* dashql_script_format(dashql::Script* script);
 extern "C" FFIResult* dashql_script_get_statistics(dashql::Script* script);
 /// Move the cursor in a script to a position
 extern "C" FFIResult* dashql_script_move_cursor(dashql::Script* script, size_t text_offset);
-/// Complete at a cursor in the script
-extern "C" FFIResult* dashql_script_complete_at_cursor(dashql::Script* script, size_t limit);
+/// Complete at a cursor in the script, a non-zero budget bounds the completion time in milliseconds
+extern "C" FFIResult* dashql_script_complete_at_cursor(dashql::Script* script, size_t limit, size_t budget_ms = 0);
 
 /// Create a catalog
 extern "C" FFIResult* dashql_catalog_new(const char* database_name_ptr = nullptr, size_t database_name_length = 0,
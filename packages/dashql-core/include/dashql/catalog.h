@@ -3,22 +3,38 @@
 #include <flatbuffers/buffer.h>
 #include <flatbuffers/flatbuffer_builder.h>
 
+#include <atomic>
 #include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <span>
+#include <string>
 #include <string_view>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <variant>
+#include <vector>
 
+#include "ankerl/unordered_dense.h"
+#include "dashql/catalog_name_index.h"
 #include "dashql/catalog_object.h"
 #include "dashql/external.h"
 #include "dashql/buffers/index_generated.h"
+#include "dashql/text/name_interner.h"
 #include "dashql/text/names.h"
 #include "dashql/utils/btree/map.h"
+#include "dashql/utils/bloom_filter.h"
 #include "dashql/utils/btree/set.h"
 #include "dashql/utils/chunk_buffer.h"
+#include "dashql/utils/mapped_file.h"
+#include "dashql/utils/shared_latch.h"
 #include "dashql/utils/string_conversion.h"
+#include "dashql/utils/suffix_array.h"
+#include "dashql/utils/suffix_trie.h"
 
 namespace dashql {
 
@@ -31,6 +47,18 @@ using CatalogSchemaID = uint32_t;
 constexpr uint32_t PROTO_NULL_U32 = std::numeric_limits<uint32_t>::max();
 constexpr CatalogDatabaseID INITIAL_DATABASE_ID = 1 << 8;
 constexpr CatalogSchemaID INITIAL_SCHEMA_ID = 1 << 16;
+/// The first database id of shared descriptor pools, catalogs allocate their own ids below
+constexpr CatalogDatabaseID SHARED_DATABASE_ID_BASE = 1u << 30;
+/// The first schema id of shared descriptor pools, catalogs allocate their own ids below
+constexpr CatalogSchemaID SHARED_SCHEMA_ID_BASE = 1u << 31;
+/// The number of names that a name search index scans linearly before rebuilding its suffix trie
+constexpr size_t MAX_NAME_SEARCH_INDEX_DELTA = 64;
+/// The number of names from which descriptor pools index their names with a succinct suffix array
+constexpr size_t SUCCINCT_NAME_SEARCH_INDEX_THRESHOLD = 1 << 14;
+/// The format version of catalog images
+constexpr uint32_t CATALOG_IMAGE_VERSION = 1;
+/// The number of flat catalog changes that are kept for deltas
+constexpr size_t MAX_FLAT_CATALOG_CHANGES = 1 << 16;
 
 /// A schema stores database metadata.
 /// It is used as a virtual container to expose table and column information to the analyzer.
@@ -43,7 +71,153 @@ class CatalogEntry {
     using NameID = uint32_t;
     using Rank = uint32_t;
 
-    using NameSearchIndex = btree::multimap<fuzzy_ci_string_view, std::reference_wrapper<const RegisteredName>>;
+    /// A name search index.
+    /// Finds names with a suffix that starts with a given text.
+    ///
+    /// The suffix trie is bulk-loaded over the distinct name texts and is immutable, it can therefore be shared with
+    /// the indexes of later versions of the same catalog entry. Most names survive an edit, a new index version only
+    /// scans the few names that are missing in the shared trie and rebuilds the trie once these deltas grow too large.
+    ///
+    /// Very large descriptor pools use a suffix array instead of the trie.
+    /// The suffix array is a single flat buffer that is queried in place and may be memory-mapped from disk.
+    struct NameSearchIndex {
+        /// The layout of the shared suffixes
+        enum class Layout : uint8_t { SuffixTrie, SuffixArray };
+        /// An immutable suffix trie over name texts
+        struct SharedTrie {
+            /// The text buffer, owned by the trie since the names of the original registry may be released
+            std::unique_ptr<char[]> text_buffer;
+            /// The name texts, the trie entries reference them by position
+            std::vector<std::string_view> texts;
+            /// The name texts as set
+            ankerl::unordered_dense::set<std::string_view> text_set;
+            /// The suffix trie
+            std::unique_ptr<SuffixTrie> trie;
+
+            /// Constructor
+            explicit SharedTrie(const NameRegistry& name_registry);
+        };
+        /// An immutable suffix array over name texts
+        struct SharedSuffixArray {
+            /// The buffer, empty if the suffix array lives in external memory
+            std::vector<std::byte> buffer;
+            /// The owner of external memory (if any), e.g. a memory mapping
+            std::shared_ptr<const void> external_owner;
+            /// The suffix array
+            SuffixArray suffix_array;
+
+            /// Constructor
+            explicit SharedSuffixArray(const NameRegistry& name_registry);
+            /// Constructor for a suffix array in external memory, the owner keeps the memory alive
+            SharedSuffixArray(SuffixArray suffix_array, std::shared_ptr<const void> owner)
+                : external_owner(std::move(owner)), suffix_array(suffix_array) {}
+            /// Get the flat buffer, e.g. to write it to disk
+            std::span<const std::byte> GetBuffer() const {
+                return {suffix_array.GetBuffer(), suffix_array.GetByteSize()};
+            }
+        };
+
+       protected:
+        /// The name registry
+        const NameRegistry* name_registry = nullptr;
+        /// The size of the name registry when building the index
+        size_t name_registry_size = 0;
+        /// The indexed names
+        std::vector<std::reference_wrapper<const RegisteredName>> names;
+        /// The shared suffix trie (if any)
+        std::shared_ptr<const SharedTrie> shared_trie;
+        /// The shared suffix array (if any)
+        std::shared_ptr<const SharedSuffixArray> shared_suffix_array;
+        /// The names that are missing in the shared trie
+        std::vector<std::reference_wrapper<const RegisteredName>> delta_names;
+        /// The number of suffixes of the delta names
+        size_t delta_suffix_count = 0;
+
+       public:
+        /// Constructor
+        NameSearchIndex() = default;
+        /// Constructor, reuses the shared suffixes of a previous index version if most names are still present
+        explicit NameSearchIndex(const NameRegistry& name_registry, const NameSearchIndex* previous = nullptr,
+                                 Layout layout = Layout::SuffixTrie);
+        /// Constructor for an existing suffix array, e.g. one that was memory-mapped from disk
+        NameSearchIndex(const NameRegistry& name_registry, std::shared_ptr<const SharedSuffixArray> suffix_array);
+
+        /// Get the number of indexed names
+        size_t GetNameCount() const { return names.size(); }
+        /// Get the number of registered names when building the index
+        size_t GetNameRegistrySize() const { return name_registry_size; }
+        /// Get the number of names that are missing in the shared trie
+        size_t GetDeltaCount() const { return delta_names.size(); }
+        /// Get the shared trie
+        auto& GetSharedTrie() const { return shared_trie; }
+        /// Get the shared suffix array
+        auto& GetSharedSuffixArray() const { return shared_suffix_array; }
+        /// Get the layout
+        Layout GetLayout() const { return shared_suffix_array ? Layout::SuffixArray : Layout::SuffixTrie; }
+        /// Get the number of indexed suffixes
+        size_t GetEntryCount() const {
+            return (shared_trie ? shared_trie->trie->GetEntries().size() : 0) +
+                   (shared_suffix_array ? shared_suffix_array->suffix_array.GetSuffixCount() : 0) + delta_suffix_count;
+        }
+        /// Get the number of allocated bytes
+        size_t GetByteSize() const {
+            return (names.capacity() + delta_names.capacity()) * sizeof(std::reference_wrapper<const RegisteredName>) +
+                   (shared_trie ? shared_trie->trie->GetByteSize() : 0) +
+                   (shared_suffix_array ? shared_suffix_array->suffix_array.GetByteSize() : 0);
+        }
+        /// Visit all indexed names
+        template <typename Fn> void IterateNames(Fn fn) const {
+            for (auto& name : names) {
+                fn(name.get());
+            }
+        }
+        /// Visit all names with a suffix that starts with a prefix.
+        /// A name is visited once, no matter how many of its suffixes match.
+        template <typename Fn> void IteratePrefix(fuzzy_ci_string_view prefix, Fn fn) const {
+            // Texts with several matching suffixes are reported once per suffix, we only visit them the first time
+            ankerl::unordered_dense::set<size_t> visited;
+            if (shared_trie) {
+                // Texts of the shared trie are only visited if the registry still contains them
+                std::tuple<const NameSearchIndex*, Fn*, ankerl::unordered_dense::set<size_t>*> ctx{this, &fn, &visited};
+                SuffixTrie::IterationCallback callback = [](void* ctx, std::span<SuffixTrie::Entry> entries) {
+                    auto& [index, fn, visited] =
+                        *static_cast<std::tuple<const NameSearchIndex*, Fn*, ankerl::unordered_dense::set<size_t>*>*>(
+                            ctx);
+                    auto& names_by_text = index->name_registry->names_by_text;
+                    for (auto& entry : entries) {
+                        if (!visited->insert(entry.value_id).second) {
+                            continue;
+                        }
+                        auto iter = names_by_text.find(index->shared_trie->texts[entry.value_id]);
+                        if (iter != names_by_text.end()) {
+                            (*fn)(iter->second.get());
+                        }
+                    }
+                };
+                shared_trie->trie->IteratePrefix(prefix, callback, &ctx);
+            }
+            if (shared_suffix_array) {
+                auto& names_by_text = name_registry->names_by_text;
+                auto& suffix_array = shared_suffix_array->suffix_array;
+                suffix_array.IteratePrefix(prefix, [&](size_t text_id, size_t) {
+                    if (!visited.insert(text_id).second) {
+                        return;
+                    }
+                    auto iter = names_by_text.find(suffix_array.GetText(text_id));
+                    if (iter != names_by_text.end()) {
+                        fn(iter->second.get());
+                    }
+                });
+            }
+            for (auto& name_ref : delta_names) {
+                auto& name = name_ref.get();
+                fuzzy_ci_string_view text{name.text.data(), name.text.size()};
+                if (text.find(prefix) != fuzzy_ci_string_view::npos) {
+                    fn(name);
+                }
+            }
+        }
+    };
 
     /// A key for a qualified table name
     /// A qualified table name
@@ -195,8 +369,8 @@ class CatalogEntry {
     };
 
    protected:
-    /// The catalog
-    Catalog& catalog;
+    /// The catalog, null for shared descriptor pools that are attached to many catalogs
+    Catalog* catalog;
     /// The catalog entry id
     const CatalogEntryID catalog_entry_id;
     /// The referenced databases
@@ -205,6 +379,9 @@ class CatalogEntry {
     ChunkBuffer<SchemaReference, 16> schema_references;
     /// The table definitions
     ChunkBuffer<TableDeclaration, 16> table_declarations;
+    /// The positions of the table declarations, indexed by the table id.
+    /// Empty if every table id is the position of the table declaration.
+    std::vector<uint32_t> table_positions_by_id;
     /// The databases, indexed by name
     std::unordered_map<std::string_view, std::reference_wrapper<const DatabaseReference>> databases_by_name;
     /// The schema, indexed by name
@@ -216,10 +393,26 @@ class CatalogEntry {
     std::unordered_multimap<std::string_view, std::reference_wrapper<const TableColumn>> table_columns_by_name;
     /// The name search index
     std::optional<CatalogEntry::NameSearchIndex> name_search_index;
+    /// The registry size that the name search index covers, published once the index is built.
+    /// Readers only take the latch if the index is missing or outdated.
+    std::atomic<size_t> name_search_index_size = std::numeric_limits<size_t>::max();
+    /// The latch for building the name search index
+    std::mutex name_search_index_latch;
+    /// The bloom filter over the case-folded table and column names
+    BloomFilter name_filter;
+    /// The number of table declarations that the name filter covers
+    size_t name_filter_table_count = 0;
 
    public:
+    /// The seed of table names in the name filter
+    static constexpr uint64_t NAME_FILTER_TABLE_SEED = 1;
+    /// The seed of column names in the name filter
+    static constexpr uint64_t NAME_FILTER_COLUMN_SEED = 2;
+
     /// Construcutor
     CatalogEntry(Catalog& catalog, CatalogEntryID external_id);
+    /// Constructor of an entry that does not belong to a single catalog
+    CatalogEntry(CatalogEntryID external_id);
 
     /// Get the external id
     CatalogEntryID GetCatalogEntryId() const { return catalog_entry_id; }
@@ -233,39 +426,87 @@ class CatalogEntry {
     auto& GetSchemasByName() const { return schemas_by_name; }
     /// Get the table declarations
     auto& GetTables() const { return table_declarations; }
+    /// Get the table declaration with a table id, the ids are a permutation of the declaration positions
+    auto& GetTableById(uint32_t table_id) const {
+        return table_declarations[table_positions_by_id.empty() ? table_id : table_positions_by_id[table_id]];
+    }
     /// Get the table declarations by name
     auto& GetTablesByName() const { return tables_by_name; }
     /// Get the table columns by name
     auto& GetTableColumnsByName() const { return table_columns_by_name; }
+    /// Get the name filter
+    auto& GetNameFilter() const { return name_filter; }
+    /// Might the entry declare a table with a hashed name?
+    /// Entries with tables that the name filter doesn't cover yet are always probed.
+    bool MayContainTable(uint64_t table_name_hash) const {
+        return name_filter_table_count != table_declarations.GetSize() || name_filter.MayContain(table_name_hash);
+    }
+    /// Might the entry declare a column with a hashed name?
+    bool MayContainColumn(uint64_t column_name_hash) const {
+        return name_filter_table_count != table_declarations.GetSize() || name_filter.MayContain(column_name_hash);
+    }
+    /// Add the names of new table declarations to the name filter.
+    /// The filter is rebuilt with twice the capacity once it is full.
+    void UpdateNameFilter();
 
-    /// Get the qualified name
-    QualifiedTableName QualifyTableName(NameRegistry& name_registry, QualifiedTableName name) const;
+    /// Get the qualified name, using the default names of a catalog
+    QualifiedTableName QualifyTableName(const Catalog& catalog, NameRegistry& name_registry,
+                                        QualifiedTableName name) const;
 
     /// Describe the catalog entry
     virtual flatbuffers::Offset<buffers::CatalogEntry> DescribeEntry(flatbuffers::FlatBufferBuilder& builder) const = 0;
     /// Get the name search index
     virtual const NameSearchIndex& GetNameSearchIndex() = 0;
+    /// Get the owner of the memory that a registered name points into, if indexes may borrow the text.
+    /// Returns nullptr if the text has to be copied.
+    virtual std::shared_ptr<const void> GetNameOwner(std::string_view text) const { return nullptr; }
 
-    /// Resolve a database reference
+    /// Resolve a database reference.
+    /// The lookups *WithCatalog search the entry first and then the catalog that the caller resolves against.
     void ResolveDatabaseSchemasWithCatalog(
-        std::string_view database_name,
+        const Catalog& catalog, std::string_view database_name,
         std::vector<std::pair<std::reference_wrapper<const SchemaReference>, bool>>& out) const;
     /// Find table columns by name
     void ResolveSchemaTablesWithCatalog(
-        std::string_view database_name, std::string_view schema_name,
+        const Catalog& catalog, std::string_view database_name, std::string_view schema_name,
         std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>>& out) const;
     /// Resolve a table by id
     const TableDeclaration* ResolveTable(ContextObjectID table_id) const;
     /// Resolve a table by id
-    const TableDeclaration* ResolveTableWithCatalog(ContextObjectID table_id) const;
+    const TableDeclaration* ResolveTableWithCatalog(const Catalog& catalog, ContextObjectID table_id) const;
     /// Resolve a table by name
     const TableDeclaration* ResolveTable(QualifiedTableName table_name) const;
     /// Resolve a table by name
-    const TableDeclaration* ResolveTableWithCatalog(QualifiedTableName table_name) const;
+    const TableDeclaration* ResolveTableWithCatalog(const Catalog& catalog, QualifiedTableName table_name) const;
     /// Find table columns by name
     void ResolveTableColumns(std::string_view table_column, std::vector<TableColumn>& out) const;
     /// Find table columns by name
-    void ResolveTableColumnsWithCatalog(std::string_view table_column, std::vector<TableColumn>& out) const;
+    void ResolveTableColumnsWithCatalog(const Catalog& catalog, std::string_view table_column,
+                                        std::vector<TableColumn>& out) const;
+};
+
+/// The database and schema ids of shared descriptor pools.
+/// Shared pools are attached to many catalogs at once, their ids must therefore not depend on a single catalog.
+/// A database or schema name always maps to the same id, catalogs reuse these ids for names of attached shared pools.
+/// The ids are owned by the shared pools that allocate from them and live as long as the last of these pools.
+class SharedCatalogIds {
+   protected:
+    /// The latch
+    mutable std::mutex latch;
+    /// The database ids by name
+    btree::map<std::string, CatalogDatabaseID> database_ids;
+    /// The schema ids by <database, schema>
+    btree::map<std::pair<std::string, std::string>, CatalogSchemaID> schema_ids;
+
+   public:
+    /// Find the id of a database
+    std::optional<CatalogDatabaseID> FindDatabaseId(std::string_view database) const;
+    /// Find the id of a schema
+    std::optional<CatalogSchemaID> FindSchemaId(std::string_view database, std::string_view schema) const;
+    /// Get the id of a database, allocates an id if we didn't see the database before
+    CatalogDatabaseID AllocateDatabaseId(std::string_view database);
+    /// Get the id of a schema, allocates an id if we didn't see the schema before
+    CatalogSchemaID AllocateSchemaId(std::string_view database, std::string_view schema);
 };
 
 class DescriptorPool : public CatalogEntry {
@@ -273,12 +514,18 @@ class DescriptorPool : public CatalogEntry {
     /// A reference to a flatbuffer descriptor
     using DescriptorRefVariant = std::variant<std::reference_wrapper<const buffers::SchemaDescriptor>,
                                               std::reference_wrapper<const buffers::SchemaDescriptors>>;
+    /// The owner of a descriptor buffer, either an owned copy or a file mapping.
+    /// Registered names point into the buffer, it has to outlive the pool.
+    /// Buffers are shared with the copies of the pool, see Clone.
+    using DescriptorBuffer = std::variant<std::shared_ptr<const std::byte[]>, std::shared_ptr<const MappedFile>>;
     /// A schema descriptors
     struct Descriptor {
         /// The schema descriptor
         DescriptorRefVariant descriptor;
+        /// The serialized descriptor
+        std::span<const std::byte> descriptor_data;
         /// The descriptor buffer
-        std::unique_ptr<const std::byte[]> descriptor_buffer;
+        DescriptorBuffer descriptor_buffer;
         /// The descriptor buffer size
         size_t descriptor_buffer_size;
     };
@@ -290,27 +537,68 @@ class DescriptorPool : public CatalogEntry {
     std::vector<Descriptor> descriptor_buffers;
     /// The name registry
     NameRegistry name_registry;
+    /// The shared ids, null if the pool allocates its ids in the catalog
+    std::shared_ptr<SharedCatalogIds> shared_ids;
+    /// Is the pool frozen?
+    std::atomic<bool> frozen = false;
+    /// The interned names of a frozen pool
+    NameInterner frozen_name_interner;
+    /// The name index of a frozen pool.
+    /// Catalogs consult the index of an attached frozen pool instead of merging its names into their own index.
+    CatalogNameIndex frozen_name_index{frozen_name_interner};
 
    public:
     /// Construcutor
     DescriptorPool(Catalog& catalog, CatalogEntryID external_id, Rank rank);
+    /// Constructor of a shared pool that does not belong to a single catalog
+    DescriptorPool(std::shared_ptr<SharedCatalogIds> shared_ids, CatalogEntryID external_id, Rank rank);
     /// Get the rank
     auto GetRank() const { return rank; }
+    /// Does the pool allocate its ids in the shared id space?
+    bool IsShared() const { return shared_ids != nullptr; }
+    /// Get the shared ids, null if the pool is not shared
+    auto& GetSharedIds() const { return shared_ids; }
+    /// Is the pool frozen?
+    bool IsFrozen() const { return frozen.load(std::memory_order_acquire); }
+    /// Get the name index of a frozen pool
+    auto& GetFrozenNameIndex() const { return frozen_name_index; }
 
     /// Describe the catalog entry
     flatbuffers::Offset<buffers::CatalogEntry> DescribeEntry(flatbuffers::FlatBufferBuilder& builder) const override;
     /// Get the name search index
     const NameSearchIndex& GetNameSearchIndex() override;
+    /// Get the owner of a name, names that point into a file mapping are borrowed
+    std::shared_ptr<const void> GetNameOwner(std::string_view text) const override;
     /// Get the name registry
     const NameRegistry& GetNameRegistry() const { return name_registry; }
     /// Get the descriptors
     std::span<const Descriptor> GetDescriptors() const { return descriptor_buffers; }
 
-    /// Add a schema descriptor
-    buffers::StatusCode AddSchemaDescriptor(DescriptorRefVariant descriptor,
-                                          std::unique_ptr<const std::byte[]> descriptor_buffer,
-                                          size_t descriptor_buffer_size, CatalogDatabaseID& db_id,
-                                          CatalogSchemaID& schema_id);
+    /// Add a schema descriptor.
+    /// Large descriptors are loaded by multiple workers that read the tables and collect the names in parallel.
+    /// The workers only split the work, the loaded pool does not depend on the number of workers.
+    buffers::StatusCode AddSchemaDescriptor(DescriptorRefVariant descriptor, std::span<const std::byte> descriptor_data,
+                                          DescriptorBuffer descriptor_buffer, size_t descriptor_buffer_size,
+                                          CatalogDatabaseID& db_id, CatalogSchemaID& schema_id,
+                                          size_t worker_count = 1);
+    /// Declare a schema with the catalog ids of a persisted image, before adding its descriptors
+    void DeclareSchema(std::string_view database_name, CatalogDatabaseID database_id, std::string_view schema_name,
+                       CatalogSchemaID schema_id);
+    /// Use a persisted suffix array as name search index.
+    /// Returns false if the suffix array does not cover all registered names.
+    bool RestoreNameSearchIndex(std::shared_ptr<const NameSearchIndex::SharedSuffixArray> suffix_array);
+    /// Freeze the pool.
+    /// Builds the name indexes eagerly, a frozen pool is immutable and can be attached to any number of catalogs.
+    void Freeze();
+    /// Copy the pool as new version that can be modified while readers still use this one.
+    /// The copy shares the descriptor buffers, keeps the catalog ids and reuses the shared suffixes of the name search
+    /// index, only the tables and name registry are rebuilt.
+    std::shared_ptr<DescriptorPool> Clone();
+
+    /// Create a shared descriptor pool that does not belong to a single catalog.
+    /// The pool allocates its database and schema ids in the given shared ids and is attached once it is frozen.
+    static std::shared_ptr<DescriptorPool> CreateShared(std::shared_ptr<SharedCatalogIds> shared_ids,
+                                                        CatalogEntryID external_id, Rank rank);
 };
 
 class Catalog {
@@ -318,12 +606,28 @@ class Catalog {
 
    public:
     using Version = uint64_t;
+    /// A lock of the catalog latch in shared mode
+    using SharedLock = std::shared_lock<SharedLatch>;
+    /// A lock of the catalog latch in exclusive mode
+    using ExclusiveLock = std::unique_lock<SharedLatch>;
 
     /// The default database name
     constexpr static std::string_view DEFAULT_DATABASE_NAME = "dashql";
     /// The default schema name
     constexpr static std::string_view DEFAULT_SCHEMA_NAME = "public";
 
+    /// A pinned version of the catalog.
+    /// Readers pin a snapshot for their whole run. The descriptor pools and analyzed scripts of a snapshot stay alive
+    /// until the last reader releases it, even if the catalog replaced or dropped them in the meantime.
+    struct Snapshot {
+        /// The catalog version
+        Version version;
+        /// The descriptor pools
+        std::vector<std::shared_ptr<const DescriptorPool>> descriptor_pools;
+        /// The analyzed scripts
+        std::vector<std::shared_ptr<const AnalyzedScript>> analyzed_scripts;
+    };
+
    protected:
     /// A catalog entry backed by an analyzed script
     struct ScriptEntry {
@@ -334,6 +638,28 @@ class Catalog {
         /// The current rank
         CatalogEntry::Rank rank;
     };
+    /// The cached table resolutions of a schema
+    struct SchemaResolutionCache {
+        /// The highest-ranked catalog entry declaring a table, by interned table name.
+        /// Tables are resolved without ignoring any catalog entry.
+        ankerl::unordered_dense::map<InternedNameID, CatalogEntryID> entries_by_table;
+    };
+    /// The table resolution statistics.
+    /// Sessions resolve tables while holding the latch in shared mode, the counters are therefore atomic.
+    struct ResolutionStatistics {
+        /// The number of table lookups through the catalog
+        std::atomic<uint64_t> table_lookups = 0;
+        /// The number of table lookups served by the resolution cache
+        std::atomic<uint64_t> table_cache_hits = 0;
+        /// The number of cache hits for tables that could not be resolved
+        std::atomic<uint64_t> table_cache_negative_hits = 0;
+        /// The number of cached resolutions that were replaced or evicted by modifications
+        std::atomic<uint64_t> table_cache_invalidations = 0;
+        /// The number of catalog entries that the name filters skipped when resolving tables
+        std::atomic<uint64_t> table_filter_skips = 0;
+    };
+    /// The key of an entry in `entries_by_schema` as <database, schema, rank, entry>
+    using SchemaEntryKey = std::tuple<InternedNameID, InternedNameID, CatalogEntry::Rank, CatalogEntryID>;
     /// Information about a catalog entry referenced through the schema name
     struct CatalogSchemaEntryInfo {
         /// The id of the catalog entry
@@ -382,6 +708,129 @@ class Catalog {
         SchemaDeclaration& operator=(SchemaDeclaration&&) = default;
     };
 
+    /// A statement of an analyzed script that depends on catalog objects
+    struct DependentStatement {
+        /// The catalog entry id of the dependent script
+        CatalogEntryID catalog_entry_id;
+        /// The AST statement id in the dependent script
+        uint32_t ast_statement_id;
+    };
+    /// A reference of a table or column in an analyzed script
+    struct ObjectReference {
+        /// The catalog entry id of the referencing script
+        CatalogEntryID catalog_entry_id;
+        /// The table reference id or the expression id in the referencing script
+        uint32_t reference_id;
+        /// The location in the referencing script
+        sx::Location location;
+    };
+    /// The key of a referenced table or column
+    struct ObjectReferenceKey {
+        /// The column id of table references
+        static constexpr uint32_t TABLE = std::numeric_limits<uint32_t>::max();
+        /// The table id
+        ContextObjectID table_id;
+        /// The column id, TABLE for references of the table itself
+        uint32_t column_id = TABLE;
+
+        /// Comparison
+        bool operator==(const ObjectReferenceKey& other) const {
+            return table_id == other.table_id && column_id == other.column_id;
+        }
+        /// A hasher
+        struct Hasher {
+            size_t operator()(const ObjectReferenceKey& key) const {
+                size_t hash = ContextObjectID::Hasher{}(key.table_id);
+                hash_combine(hash, key.column_id);
+                return hash;
+            }
+        };
+    };
+    /// The outdated statements, ordered by <catalog entry id, statement id>
+    using OutdatedStatements = btree::map<CatalogEntryID, btree::set<uint32_t>>;
+    /// The table declarations that changed with the last update of a script entry.
+    /// Table ids of unchanged table declarations stay stable when the script is re-analyzed.
+    struct TableDelta {
+        /// The ids of added tables
+        std::vector<ContextObjectID> added_tables;
+        /// The ids of tables with changed columns
+        std::vector<ContextObjectID> changed_tables;
+        /// The ids of removed tables in the previous version of the script.
+        /// The ids may be reused by added tables.
+        std::vector<ContextObjectID> removed_tables;
+    };
+
+    /// A database or schema of the flat catalog
+    struct FlatObject {
+        /// The database or schema id
+        uint32_t object_id;
+        /// The database id of schemas, 0 for databases
+        uint32_t parent_id;
+        /// The name id
+        uint32_t name_id;
+    };
+    /// A table of the flat catalog
+    struct FlatTable {
+        /// The table id
+        ContextObjectID table_id;
+        /// The schema id
+        CatalogSchemaID schema_id;
+        /// The name id of the table
+        uint32_t name_id;
+        /// The name ids of the columns
+        std::vector<uint32_t> column_name_ids;
+    };
+    /// The expanded nodes of the flat catalog tree
+    struct FlatCatalogExpansion {
+        /// The expanded databases
+        std::vector<CatalogDatabaseID> databases;
+        /// The expanded schemas
+        std::vector<CatalogSchemaID> schemas;
+        /// The expanded tables as packed table ids
+        std::vector<uint64_t> tables;
+    };
+    /// The flat catalog, maintained incrementally across versions
+    struct FlatCatalogState {
+        /// The version that was flattened last, 0 if the catalog was never flattened
+        Version version = 0;
+        /// Do all tables have to be resolved again?
+        bool all_tables_dirty = true;
+        /// The tables that have to be resolved again, using interned names
+        btree::set<CatalogEntry::QualifiedTableName::Key> dirty_tables;
+        /// The text buffers of the name dictionary.
+        /// The flat catalog owns the texts of its names, the keys below point into them.
+        std::vector<std::unique_ptr<char[]>> name_buffers;
+        /// The name dictionary, name ids are stable across versions until a full flatten compacts the dictionary
+        std::vector<std::string_view> names;
+        /// The name ids by text
+        ankerl::unordered_dense::map<std::string_view, uint32_t> name_ids;
+        /// The databases by name
+        btree::map<std::string_view, FlatObject> databases;
+        /// The schemas by <database, schema>
+        btree::map<std::pair<std::string_view, std::string_view>, FlatObject> schemas;
+        /// The effective tables by <database, schema, table>
+        btree::map<CatalogEntry::QualifiedTableName::Key, FlatTable> tables;
+        /// The database names in order, the root of the flat catalog tree
+        std::vector<std::string_view> database_order;
+        /// The schemas of every database in order
+        btree::map<std::string_view, std::vector<std::pair<std::string_view, std::string_view>>> database_schemas;
+        /// The tables of every schema in order
+        btree::map<std::pair<std::string_view, std::string_view>, std::vector<CatalogEntry::QualifiedTableName::Key>>
+            schema_tables;
+        /// The database names by id
+        ankerl::unordered_dense::map<CatalogDatabaseID, std::string_view> database_names_by_id;
+        /// The schema names by id
+        ankerl::unordered_dense::map<CatalogSchemaID, std::pair<std::string_view, std::string_view>> schema_names_by_id;
+        /// The table names by packed table id
+        ankerl::unordered_dense::map<uint64_t, CatalogEntry::QualifiedTableName::Key> table_names_by_id;
+        /// The changes of all flattened versions after the horizon, ordered by version
+        std::vector<std::pair<Version, buffers::FlatCatalogChange>> changes;
+        /// The size of the name dictionary by flattened version
+        btree::map<Version, uint32_t> name_counts;
+        /// The oldest version that deltas can start from
+        Version horizon = 0;
+    };
+
    protected:
     /// The catalog version.
     /// Every modification bumps the version counter, the analyzer reads the version counter which protects all refs.
@@ -390,24 +839,28 @@ class Catalog {
     const std::string default_database_name;
     /// The default schema name
     const std::string default_schema_name;
+    /// The interned names.
+    /// Contains the database, schema and table names of all catalog entries and the names of the merged name index.
+    /// Every entry holds references to the names of its tables and schemas, and releases them when it is dropped.
+    NameInterner name_interner;
+    /// The merged name index of all catalog entries
+    CatalogNameIndex name_index{name_interner};
 
     /// The catalog entries
     std::unordered_map<CatalogEntryID, CatalogEntry*> entries;
     /// The script entries
     std::unordered_map<Script*, ScriptEntry> script_entries;
     /// The descriptor pool entries
-    std::unordered_map<CatalogEntryID, std::unique_ptr<DescriptorPool>> descriptor_pool_entries;
+    std::unordered_map<CatalogEntryID, std::shared_ptr<DescriptorPool>> descriptor_pool_entries;
     /// The entries ordered by <rank>
     btree::set<std::tuple<CatalogEntry::Rank, CatalogEntryID>> entries_ranked;
-    /// The entries ordered by <database, schema, rank>
-    btree::map<std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID>,
-               CatalogSchemaEntryInfo>
-        entries_by_schema;
-
-    /// The next database id
-    CatalogDatabaseID next_database_id = INITIAL_DATABASE_ID;
-    /// The next schema id
-    CatalogSchemaID next_schema_id = INITIAL_SCHEMA_ID;
+    /// The entries ordered by <database, schema, rank>, using interned database and schema names
+    btree::map<SchemaEntryKey, CatalogSchemaEntryInfo> entries_by_schema;
+
+    /// The next database id, allocated by concurrent analyzers
+    std::atomic<CatalogDatabaseID> next_database_id = INITIAL_DATABASE_ID;
+    /// The next schema id, allocated by concurrent analyzers
+    std::atomic<CatalogSchemaID> next_schema_id = INITIAL_SCHEMA_ID;
     /// The databases.
     /// The btrees contain all the databases that are currently referenced by catalog entries.
     btree::map<std::string_view, std::unique_ptr<DatabaseDeclaration>> databases;
@@ -416,8 +869,97 @@ class Catalog {
     /// Ordered by <database, schema>
     btree::map<std::pair<std::string_view, std::string_view>, std::unique_ptr<SchemaDeclaration>> schemas;
 
+    /// The analyzed scripts with registered dependencies.
+    /// We keep the analyzed scripts alive since the dependency keys point into their name registries.
+    std::unordered_map<CatalogEntryID, std::shared_ptr<AnalyzedScript>> dependency_owners;
+    /// The dependent statements by qualified table name
+    btree::multimap<CatalogEntry::QualifiedTableName::Key, DependentStatement> table_dependents;
+    /// The dependent statements by <database, schema>
+    btree::multimap<std::pair<std::string_view, std::string_view>, DependentStatement> schema_dependents;
+    /// The dependent statements by unresolved column name
+    std::unordered_multimap<std::string_view, DependentStatement> column_dependents;
+    /// The references of tables and columns in all analyzed scripts.
+    /// The references of a script are appended when registering its dependencies, the lists are therefore ordered by
+    /// registration and not by script.
+    std::unordered_map<ObjectReferenceKey, std::vector<ObjectReference>, ObjectReferenceKey::Hasher> object_references;
+    /// The statements that resolved against catalog objects that changed since
+    OutdatedStatements outdated_statements;
+    /// The table deltas of the last script updates
+    std::unordered_map<CatalogEntryID, TableDelta> table_deltas;
+    /// The latch of the catalog.
+    /// Sessions analyze and complete while holding the latch in shared mode, modifications hold it exclusively.
+    mutable SharedLatch latch;
+    /// The snapshot of the current version, created when the version is pinned for the first time
+    mutable std::shared_ptr<const Snapshot> snapshot;
+    /// The latch for pinning snapshots
+    mutable std::mutex snapshot_latch;
+
+    /// The table resolution cache, by packed interned <database, schema>.
+    /// Modifications update the resolutions of all tables they add or remove, lookups never write to the cache.
+    /// The cache therefore only holds tables that are declared by a catalog entry.
+    ankerl::unordered_dense::map<uint64_t, SchemaResolutionCache> resolution_cache;
+    /// The resolution statistics
+    mutable ResolutionStatistics resolution_statistics;
+    /// The flat catalog
+    FlatCatalogState flat_catalog;
+
     /// Update a script entry
     buffers::StatusCode UpdateScript(ScriptEntry& entry);
+    /// Intern the database, schema and table names of the tables of a catalog entry, starting at a table id
+    void InternNames(const CatalogEntry& entry, size_t first_table = 0);
+    /// Release the names of all tables of a catalog entry
+    void ReleaseNames(const CatalogEntry& entry);
+    /// Register a catalog entry that populates a schema, the key holds a reference to the interned names
+    void AddSchemaEntry(std::string_view database_name, std::string_view schema_name, CatalogEntry::Rank rank,
+                        CatalogSchemaEntryInfo info);
+    /// Unregister a catalog entry that populates a schema
+    void RemoveSchemaEntry(std::string_view database_name, std::string_view schema_name, CatalogEntry::Rank rank,
+                           CatalogEntryID entry_id);
+    /// Find the range of entries populating a schema
+    std::pair<btree::map<SchemaEntryKey, CatalogSchemaEntryInfo>::const_iterator,
+              btree::map<SchemaEntryKey, CatalogSchemaEntryInfo>::const_iterator>
+    FindSchemaEntries(std::string_view database_name, std::string_view schema_name) const;
+    /// Find the shared id of a database that is declared by an attached shared pool
+    std::optional<CatalogDatabaseID> FindSharedDatabaseId(std::string_view database) const;
+    /// Find the shared id of a schema that is declared by an attached shared pool
+    std::optional<CatalogSchemaID> FindSharedSchemaId(std::string_view database, std::string_view schema) const;
+    /// Mark all statements depending on a table name as outdated
+    void InvalidateTable(const CatalogEntry::QualifiedTableName::Key& table_name);
+    /// Mark all statements depending on a table declaration or one of its column names as outdated
+    void InvalidateTable(const CatalogEntry::TableDeclaration& table);
+    /// Diff the tables of two versions of a script, mark dependents of changed tables as outdated
+    TableDelta DiffTables(const AnalyzedScript& prev, const AnalyzedScript& next);
+    /// Retire a replaced or dropped analyzed script.
+    /// Snapshots that were pinned before keep the script alive, it is released with the last of them.
+    void RetireScript(const Script& script, std::shared_ptr<AnalyzedScript> analyzed);
+    /// Drop the cached snapshot
+    void ResetSnapshot();
+    /// Is a descriptor pool pinned by a snapshot?
+    /// Drops the cached snapshot of the current version, only snapshots of readers count.
+    bool IsPinned(const std::shared_ptr<DescriptorPool>& pool);
+    /// Register the tables, schemas and names of a descriptor pool
+    void RegisterDescriptorPool(std::shared_ptr<DescriptorPool> pool);
+    /// Unregister the tables, schemas and names of a descriptor pool
+    void UnregisterDescriptorPool(const DescriptorPool& pool);
+    /// Mark all statements depending on a schema as outdated
+    void InvalidateSchema(std::string_view database_name, std::string_view schema_name);
+    /// Mark all statements depending on a column name as outdated
+    void InvalidateColumnName(std::string_view column_name);
+    /// Resolve a table name again and update the resolution cache
+    void UpdateResolutionCache(const CatalogEntry::QualifiedTableName::Key& table_name);
+    /// Update the cached resolutions of the tables of a catalog entry, starting at a table id
+    void UpdateResolutionCache(const CatalogEntry& entry, size_t first_table = 0);
+    /// Add a name to the flat name dictionary, the text stays valid until the dictionary is compacted
+    std::string_view InternFlatName(std::string_view name);
+    /// Get the id of a name in the flat name dictionary
+    uint32_t GetFlatNameId(std::string_view name);
+    /// Bring the flat catalog up to date, recording the changes since the last flattened version
+    void RefreshFlatCatalog();
+    /// Rebuild the flat catalog with a compacted name dictionary if most of its names are no longer referenced
+    void CompactFlatCatalog();
+    /// Resolve a table by name without consulting the resolution cache
+    const CatalogEntry::TableDeclaration* ResolveTableUncached(const CatalogEntry::QualifiedTableName::Key& table_name,
+                                                               std::optional<CatalogEntryID> ignore_entry) const;
 
    public:
     /// Explicit constructor needed due to deleted copy constructor
@@ -438,7 +980,18 @@ class Catalog {
     auto& GetDatabases() const { return databases; }
     /// Get the schemas ordered by <database, schema>
     auto& GetSchemas() const { return schemas; }
+    /// Get the name interner
+    auto& GetNameInterner() const { return name_interner; }
 
+    /// Lock the catalog for reading, many sessions may read at the same time
+    SharedLock LockShared() const { return SharedLock{latch}; }
+    /// Lock the catalog for modifications
+    ExclusiveLock LockExclusive() { return ExclusiveLock{latch}; }
+    /// Lock the catalog for a modification unless the calling thread holds the latch exclusively already.
+    /// Every modification calls this, callers may therefore group several modifications under one LockExclusive().
+    ExclusiveLock LockForModification() {
+        return latch.IsHeldExclusively() ? ExclusiveLock{} : ExclusiveLock{latch};
+    }
     /// Contains an entry id?
     bool Contains(CatalogEntryID id) const { return entries.contains(id); }
     /// Iterate all entries in arbitrary order
@@ -454,20 +1007,35 @@ class Catalog {
             f(id, *entry, rank);
         }
     }
-    /// Register a database name
+    /// Iterate the name indexes, the merged index of the catalog and the indexes of attached frozen pools
+    template <typename Fn> void IterateNameIndexes(Fn f) const {
+        f(name_index);
+        for (auto& [entry_id, pool] : descriptor_pool_entries) {
+            if (pool->IsFrozen()) {
+                f(pool->GetFrozenNameIndex());
+            }
+        }
+    }
+    /// Register a database name.
+    /// Names of attached shared descriptor pools keep their shared id.
     CatalogDatabaseID AllocateDatabaseId(std::string_view database) {
         auto iter = databases.find(database);
         if (iter != databases.end()) {
             return iter->second->catalog_database_id;
+        } else if (auto shared_id = FindSharedDatabaseId(database)) {
+            return *shared_id;
         } else {
             return next_database_id++;
         }
     }
-    /// Register a schema name
+    /// Register a schema name.
+    /// Names of attached shared descriptor pools keep their shared id.
     CatalogSchemaID AllocateSchemaId(std::string_view database, std::string_view schema) {
         auto iter = schemas.find({database, schema});
         if (iter != schemas.end()) {
             return iter->second->catalog_schema_id;
+        } else if (auto shared_id = FindSharedSchemaId(database, schema)) {
+            return *shared_id;
         } else {
             return next_schema_id++;
         }
@@ -481,7 +1049,14 @@ class Catalog {
     flatbuffers::Offset<buffers::CatalogEntries> DescribeEntriesOf(flatbuffers::FlatBufferBuilder& builder,
                                                                  size_t external_id) const;
     /// Flatten the catalog
-    flatbuffers::Offset<buffers::FlatCatalog> Flatten(flatbuffers::FlatBufferBuilder& builder) const;
+    flatbuffers::Offset<buffers::FlatCatalog> Flatten(flatbuffers::FlatBufferBuilder& builder);
+    /// Flatten the changes of the catalog since a flattened version
+    flatbuffers::Offset<buffers::FlatCatalogDelta> FlattenDelta(flatbuffers::FlatBufferBuilder& builder,
+                                                                Version since_version);
+    /// Flatten a window of the visible rows of the catalog tree
+    flatbuffers::Offset<buffers::FlatCatalogWindow> FlattenWindow(flatbuffers::FlatBufferBuilder& builder,
+                                                                  const FlatCatalogExpansion& expanded,
+                                                                  size_t row_offset, size_t row_count);
 
     /// Add a script
     buffers::StatusCode LoadScript(Script& script, CatalogEntry::Rank rank);
@@ -491,14 +1066,43 @@ class Catalog {
     buffers::StatusCode AddDescriptorPool(CatalogEntryID external_id, CatalogEntry::Rank rank);
     /// Drop a descriptor pool
     buffers::StatusCode DropDescriptorPool(CatalogEntryID external_id);
+    /// Create a descriptor pool that is not part of the catalog yet.
+    /// Writers fill the pool without blocking readers and publish it once it is complete.
+    std::shared_ptr<DescriptorPool> CreateDescriptorPool(CatalogEntryID external_id, CatalogEntry::Rank rank);
+    /// Publish a descriptor pool as new version of the catalog, replacing a previous version of the pool.
+    /// Readers that pinned the previous version keep using it until they release their snapshot.
+    buffers::StatusCode PublishDescriptorPool(std::shared_ptr<DescriptorPool> pool);
+    /// Attach a frozen descriptor pool, replacing a previous version of the pool.
+    /// The pool is shared with other catalogs, the catalog only keeps its own entry and schema indexes.
+    /// Fails with CATALOG_ID_OUT_OF_SYNC if the catalog uses other ids for databases or schemas of the pool,
+    /// or if the pool allocated its ids in other shared ids than the shared pools that are already attached.
+    buffers::StatusCode AttachDescriptorPool(std::shared_ptr<DescriptorPool> pool);
+    /// Pin the current version of the catalog.
+    /// Readers pin while holding the latch in shared mode. Writers never modify a pool that may be pinned, they
+    /// publish a new version of the pool instead.
+    /// A script that is analyzed again never resolves against itself and doesn't pin its own previous version.
+    std::shared_ptr<const Snapshot> Pin(std::optional<CatalogEntryID> ignore = std::nullopt) const;
     /// Add a schema descriptor as serialized FlatBuffer
     buffers::StatusCode AddSchemaDescriptor(CatalogEntryID external_id, std::span<const std::byte> descriptor_data,
                                           std::unique_ptr<const std::byte[]> descriptor_buffer,
                                           size_t descriptor_buffer_size);
-    /// Add a schema descriptor>s< as serialized FlatBuffer
+    /// Add a schema descriptor>s< as serialized FlatBuffer, reading the tables with multiple workers
     buffers::StatusCode AddSchemaDescriptors(CatalogEntryID external_id, std::span<const std::byte> descriptor_data,
-                                           std::unique_ptr<const std::byte[]> descriptor_buffer,
-                                           size_t descriptor_buffer_size);
+                                           DescriptorPool::DescriptorBuffer descriptor_buffer,
+                                           size_t descriptor_buffer_size, size_t worker_count = 1);
+    /// Save the descriptor pools of the catalog as image.
+    /// Scripts are not part of the image, they are re-analyzed against the loaded catalog.
+    /// Holds the latch in shared mode, sessions may keep reading while the image is written.
+    buffers::StatusCode SaveImage(const std::string& path);
+    /// Load the descriptor pools of an image into an empty catalog.
+    /// The image is memory-mapped, descriptors and the suffix arrays of the name search indexes are used in place.
+    /// Table maps, name registries and the postings of the merged name index are rebuilt from the descriptors.
+    buffers::StatusCode LoadImage(const std::string& path, size_t worker_count = 1);
+    /// Add a schema descriptor>s< file without copying it.
+    /// The file is memory-mapped and verified, the names of the pool and the interned names of the catalog point
+    /// into the mapping. Postings, registries and table maps are still allocated on the heap.
+    buffers::StatusCode AddSchemaDescriptorsFile(CatalogEntryID external_id, const std::string& path,
+                                               size_t worker_count = 1);
 
     /// Resolve a table by id
     const CatalogEntry::TableDeclaration* ResolveTable(ContextObjectID table_id) const;
@@ -508,7 +1112,39 @@ class Catalog {
     /// Resolve all schema tables
     void ResolveSchemaTables(std::string_view database_name, std::string_view schema_name,
                              std::vector<std::reference_wrapper<const CatalogEntry::TableDeclaration>>& out) const;
-    /// Get statisics
+    /// Register the catalog dependencies of an analyzed script, replacing previous ones
+    void RegisterDependencies(std::shared_ptr<AnalyzedScript> analyzed);
+    /// Unregister the catalog dependencies of a script
+    void UnregisterDependencies(CatalogEntryID external_id);
+    /// Find all references of a table in the analyzed scripts
+    std::span<const ObjectReference> FindReferences(ContextObjectID table_id) const {
+        return FindReferences(ObjectReferenceKey{.table_id = table_id});
+    }
+    /// Find all references of a table column in the analyzed scripts
+    std::span<const ObjectReference> FindReferences(ContextObjectID table_id, uint32_t column_id) const {
+        return FindReferences(ObjectReferenceKey{.table_id = table_id, .column_id = column_id});
+    }
+    /// Find all references of a table or column in the analyzed scripts
+    std::span<const ObjectReference> FindReferences(const ObjectReferenceKey& key) const {
+        auto iter = object_references.find(key);
+        return iter == object_references.end() ? std::span<const ObjectReference>{} : iter->second;
+    }
+    /// Get the statements that have to be re-analyzed
+    auto& GetOutdatedStatements() const { return outdated_statements; }
+    /// Take the statements that have to be re-analyzed
+    OutdatedStatements TakeOutdatedStatements() {
+        auto lock = LockForModification();
+        return std::exchange(outdated_statements, {});
+    }
+    /// Get the merged name index of all catalog entries
+    auto& GetNameIndex() const { return name_index; }
+    /// Get the table delta of the last load or update of a script
+    const TableDelta* GetTableDelta(CatalogEntryID external_id) const {
+        auto iter = table_deltas.find(external_id);
+        return iter == table_deltas.end() ? nullptr : &iter->second;
+    }
+
+    /// Get statisics, holding the latch in shared mode
     std::unique_ptr<buffers::CatalogStatisticsT> GetStatistics();
 };
 
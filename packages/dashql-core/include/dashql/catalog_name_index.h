@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+#include "dashql/external.h"
+#include "dashql/text/name_interner.h"
+#include "dashql/text/names.h"
+#include "dashql/utils/btree/map.h"
+#include "dashql/utils/btree/set.h"
+#include "dashql/utils/string_conversion.h"
+
+namespace dashql {
+
+class CatalogEntry;
+
+/// A catalog-wide name index for completion.
+/// Merges the names of all catalog entries, every distinct name text is indexed once with postings for the entries
+/// that contain it. Entries are added and removed incrementally when the catalog changes.
+///
+/// Substring lookups don't need a merged suffix index, they are answered by the name search indexes of the entries.
+/// These indexes are shared with later versions of an entry and are memory-mapped for large pools.
+struct CatalogNameIndex {
+    /// A name in a catalog entry
+    struct Posting {
+        /// The catalog entry id
+        CatalogEntryID catalog_entry_id;
+        /// The rank of the catalog entry
+        uint32_t rank;
+        /// The registered name in the catalog entry, provides the name tags and the resolved objects
+        const RegisteredName* name;
+    };
+    /// The postings of a distinct name
+    struct NamePostings {
+        /// The interned name text
+        std::string_view text;
+        /// The postings, ordered by <rank, catalog entry id>
+        std::vector<Posting> postings;
+    };
+    /// A name that matched a query with typos
+    struct FuzzyMatch {
+        /// The postings of the name
+        const NamePostings& postings;
+        /// The edit distance between the query and the closest prefix of the name
+        uint32_t distance;
+    };
+    /// An indexed catalog entry
+    struct IndexedEntry {
+        /// The catalog entry, provides the name search index
+        CatalogEntry* entry;
+        /// The rank of the catalog entry
+        uint32_t rank;
+        /// The interned names, in the order of the name registry
+        std::vector<InternedNameID> names;
+    };
+    /// A callback for prefix scans, returns false to stop the scan
+    using PrefixCallback = bool (*)(void* ctx, const NamePostings& postings, const Posting& posting);
+
+   protected:
+    /// The name interner of the catalog
+    NameInterner& name_interner;
+    /// The postings by interned name id
+    ankerl::unordered_dense::map<InternedNameID, NamePostings> postings_by_name;
+    /// The full texts of all indexed names, walked as trie when matching with typos
+    btree::multimap<fuzzy_ci_string_view, InternedNameID> names_by_text;
+    /// The indexed entries
+    ankerl::unordered_dense::map<CatalogEntryID, IndexedEntry> entries;
+    /// The indexed entries ordered by <rank, catalog entry id>
+    btree::set<std::tuple<uint32_t, CatalogEntryID>> entries_ranked;
+
+    /// Visit the postings of all names with a suffix that starts with a prefix
+    void IteratePrefix(fuzzy_ci_string_view prefix, PrefixCallback callback, void* ctx) const;
+
+   public:
+    /// Constructor
+    CatalogNameIndex(NameInterner& interner) : name_interner(interner) {}
+
+    /// Get the number of distinct names
+    size_t GetNameCount() const { return postings_by_name.size(); }
+    /// Get the number of suffixes in the name search indexes of the entries
+    size_t GetSuffixCount() const;
+
+    /// Index the names of a catalog entry that were registered since the last call.
+    /// Name registries only grow, so descriptor pools can be indexed incrementally.
+    /// The name search index of the entry is built eagerly, scans only read it.
+    void AddEntryNames(CatalogEntry& entry, uint32_t rank, const NameRegistry& names);
+    /// Remove all names of a catalog entry
+    void RemoveEntry(CatalogEntryID entry_id);
+    /// Clear the index
+    void Clear();
+
+    /// Visit the postings of all names with a suffix that starts with a prefix.
+    /// The entries are visited in the order of <rank, catalog entry id>, every name is visited once per entry with
+    /// the posting of that entry. The first visit of a name therefore passes its most relevant posting.
+    /// The callback returns false to stop the scan.
+    template <typename Fn> void IteratePrefix(fuzzy_ci_string_view prefix, Fn fn) const {
+        IteratePrefix(
+            prefix,
+            [](void* ctx, const NamePostings& postings, const Posting& posting) {
+                return (*static_cast<Fn*>(ctx))(postings, posting);
+            },
+            &fn);
+    }
+    /// Find all names with a prefix that is within a bounded edit distance of a query.
+    /// Names have to start with the first character of the query.
+    /// The sorted name texts are walked like a trie, rows of the Levenshtein matrix are shared among common prefixes
+    /// and subtrees are skipped as soon as no extension can match.
+    void FindFuzzyPrefixMatches(fuzzy_ci_string_view query, uint32_t max_distance,
+                                std::vector<FuzzyMatch>& out) const;
+};
+
+}  // namespace dashql
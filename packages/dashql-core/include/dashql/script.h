@@ -3,6 +3,7 @@
 #include <flatbuffers/buffer.h>
 #include <flatbuffers/flatbuffer_builder.h>
 
+#include <chrono>
 #include <functional>
 #include <optional>
 #include <string_view>
@@ -24,6 +25,7 @@ class ParseContext;
 class Analyzer;
 class NameSuffixIndex;
 class Completion;
+struct CompletionCache;
 
 using Key = buffers::AttributeKey;
 using Location = buffers::Location;
@@ -302,6 +304,18 @@ class AnalyzedScript : public CatalogEntry {
             referenced_tables_by_name;
     };
 
+    /// A distinct unresolved column name in a statement
+    struct UnresolvedColumnName {
+        /// The AST statement id
+        uint32_t ast_statement_id;
+        /// The column name
+        std::reference_wrapper<RegisteredName> column_name;
+        /// The number of unresolved expressions referring to this name
+        uint32_t expression_count = 0;
+        /// The catalog tables that declare a column with this name
+        std::vector<std::reference_wrapper<const CatalogEntry::TableDeclaration>> candidate_tables;
+    };
+
     /// The default database name
     const RegisteredName default_database_name;
     /// The default schema name
@@ -311,6 +325,10 @@ class AnalyzedScript : public CatalogEntry {
     std::shared_ptr<ParsedScript> parsed_script;
     /// The catalog version
     Catalog::Version catalog_version;
+    /// The pinned catalog snapshot.
+    /// Resolved tables and columns point into the descriptor pools and analyzed scripts of the snapshot.
+    /// Released when the catalog retires this script, see Catalog::RetireScript.
+    std::shared_ptr<const Catalog::Snapshot> catalog_snapshot;
     /// The analyzer errors
     std::vector<buffers::AnalyzerErrorT> errors;
     /// The table references
@@ -321,6 +339,12 @@ class AnalyzedScript : public CatalogEntry {
     ChunkBuffer<NameScope, 16> name_scopes;
     /// The name scopes by scope root
     std::unordered_map<size_t, std::reference_wrapper<NameScope>> name_scopes_by_root_node;
+    /// The distinct unresolved column names, ordered by statement
+    std::vector<UnresolvedColumnName> unresolved_column_names;
+    /// The unresolved column names by statement as (begin, count) into `unresolved_column_names`
+    std::vector<std::pair<uint32_t, uint32_t>> unresolved_column_names_by_statement;
+    /// The tables of other catalog entries that statements resolved against or failed to resolve
+    std::vector<std::pair<uint32_t, QualifiedTableName::Key>> table_dependencies;
 
     /// Traverse the name scopes for a given ast node id
     void FollowPathUpwards(uint32_t ast_node_id, std::vector<uint32_t>& ast_node_path,
@@ -335,6 +359,8 @@ class AnalyzedScript : public CatalogEntry {
         flatbuffers::FlatBufferBuilder& builder) const override;
     /// Get the name search index
     const CatalogEntry::NameSearchIndex& GetNameSearchIndex() override;
+    /// Get the distinct unresolved column names of a statement
+    std::span<const UnresolvedColumnName> GetUnresolvedColumnNames(uint32_t statement_id) const;
     /// Build the program
     flatbuffers::Offset<buffers::AnalyzedScript> Pack(flatbuffers::FlatBufferBuilder& builder);
 };
@@ -401,6 +427,8 @@ class Script {
 
     /// The last cursor
     std::unique_ptr<ScriptCursor> cursor;
+    /// The catalog names of the last completion
+    std::unique_ptr<CompletionCache> completion_cache;
 
     /// The memory statistics
     buffers::ScriptProcessingTimings timing_statistics;
@@ -444,8 +472,10 @@ class Script {
 
     /// Move the cursor
     std::pair<const ScriptCursor*, buffers::StatusCode> MoveCursor(size_t text_offset);
-    /// Complete at the cursor
-    std::pair<std::unique_ptr<Completion>, buffers::StatusCode> CompleteAtCursor(size_t limit = 10) const;
+    /// Complete at the cursor.
+    /// With a deadline, the completion may be partial and should be requested again when the UI is idle.
+    std::pair<std::unique_ptr<Completion>, buffers::StatusCode> CompleteAtCursor(
+        size_t limit = 10, std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
     /// Get statisics
     std::unique_ptr<buffers::ScriptStatisticsT> GetStatistics();
 };
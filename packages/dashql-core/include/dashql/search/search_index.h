@@ -1,12 +1,15 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
-#include "dashql/parser/parser.h"
+#include "ankerl/unordered_dense.h"
 #include "dashql/buffers/index_generated.h"
 #include "dashql/script.h"
-#include "dashql/utils/btree/map.h"
-#include "dashql/utils/chunk_buffer.h"
 #include "dashql/utils/string_pool.h"
 
 namespace dashql {
@@ -20,62 +23,118 @@ struct FileSearchLabel {
     sx::Location location;
 };
 
-struct IndexedFile {
-    /// The id of the file
-    size_t local_id;
-    /// The name of the file
-    std::string name;
-};
-
 struct IndexedFileStatistics {
     /// The label count
     size_t label_count = 0;
+    /// The text bytes
+    size_t text_bytes = 0;
+    /// The number of distinct trigrams
+    size_t trigram_count = 0;
     /// Plus operator
     IndexedFileStatistics operator+(IndexedFileStatistics other) {
-        return {.label_count = label_count + other.label_count};
+        return {.label_count = label_count + other.label_count,
+                .text_bytes = text_bytes + other.text_bytes,
+                .trigram_count = trigram_count + other.trigram_count};
     }
     /// Plus operator
     IndexedFileStatistics operator-(IndexedFileStatistics other) {
-        return {.label_count = label_count - other.label_count};
+        return {.label_count = label_count - other.label_count,
+                .text_bytes = text_bytes - other.text_bytes,
+                .trigram_count = trigram_count - other.trigram_count};
     }
 };
 
+struct IndexedFile {
+    /// The id of the file
+    size_t local_id;
+    /// The name of the file
+    std::string name;
+    /// The lowercase text
+    std::string folded_text;
+    /// The labels, ordered by their location
+    std::vector<FileSearchLabel> labels;
+    /// The statistics
+    IndexedFileStatistics stats;
+};
+
+/// A match of a search
+struct FileSearchMatch {
+    /// The id of the indexed file
+    size_t local_file_id;
+    /// The name of the file
+    std::string_view file_name;
+    /// The location in the source file
+    sx::Location location;
+    /// The label that contains the match (if any)
+    const FileSearchLabel* label;
+};
+
+/// A search index over the scripts of a workspace.
+///
+/// Files are indexed with posting lists of the case-folded trigrams in their text.
+/// A search intersects the posting lists of the query trigrams and verifies the remaining candidates with a substring
+/// search over the folded text. Removed files are only marked with a tombstone and skipped during the search, their
+/// postings are dropped when compacting the index.
 struct SearchIndex {
-    /// The index type
-    using SearchIndexType = btree::multimap<std::string_view, std::reference_wrapper<const FileSearchLabel>>;
+    /// A trigram of case-folded characters
+    using Trigram = uint32_t;
+    /// A posting list, ordered by the file id
+    using PostingList = std::vector<uint32_t>;
 
    protected:
-    /// The indexed files
-    std::unordered_map<std::string, IndexedFile> indexed_files;
+    /// The indexed files by id
+    ankerl::unordered_dense::map<size_t, IndexedFile> indexed_files;
+    /// The ids of the live files by name
+    std::unordered_map<std::string, size_t> indexed_files_by_name;
     /// The tombstones for indexed files that were deleted
     std::unordered_set<size_t> indexed_files_tombstones;
     /// The statistics of all files that are indexed
     IndexedFileStatistics index_stats_total;
     /// The statistics of dead files that are indexed
     IndexedFileStatistics index_stats_dead;
+    /// The next file id
+    size_t next_file_id = 0;
 
     /// The string pool for labels
     StringPool<1024> label_string_pool;
     /// The label strings
     std::unordered_set<std::string_view> label_strings;
-    /// The file labels
-    ChunkBuffer<FileSearchLabel, 32> file_labels;
-    /// The label suffixes
-    SearchIndexType search_index;
+    /// The posting lists of all trigrams
+    ankerl::unordered_dense::map<Trigram, PostingList> trigram_postings;
 
-    /// Compact the search index by rebuilding the search labels
-    void Compact();
+    /// Intern a label string
+    std::string_view InternLabel(std::string_view text);
+    /// Verify the candidate matches in a file
+    void VerifyFile(const IndexedFile& file, std::string_view folded_query, std::vector<FileSearchMatch>& out,
+                    size_t limit) const;
 
    public:
     /// Constructor
     SearchIndex();
 
-    /// Add a file to the search index
+    /// Get the statistics of all indexed files, including the dead ones
+    auto& GetTotalStatistics() const { return index_stats_total; }
+    /// Get the statistics of dead files
+    auto& GetDeadStatistics() const { return index_stats_dead; }
+    /// Get the statistics of a file
+    const IndexedFileStatistics* GetFileStatistics(std::string_view filename) const;
+    /// Get the number of live files
+    size_t GetFileCount() const { return indexed_files_by_name.size(); }
+    /// Get the number of tombstones
+    size_t GetTombstoneCount() const { return indexed_files_tombstones.size(); }
+    /// Get the number of indexed trigrams
+    size_t GetTrigramCount() const { return trigram_postings.size(); }
+
+    /// Add a file to the search index, replaces a file with the same name
     void AddFile(std::string_view filename, ScannedScript& script);
-    /// Remove a file from the search indexjA
+    /// Remove a file from the search index
     void RemoveFile(std::string_view filename);
-    /// Search file
-    void SearchFile(std::string_view text);
+    /// Search all files for a text, case-insensitively.
+    /// The matches reference the index and are only valid until the index is modified.
+    std::vector<FileSearchMatch> SearchFile(std::string_view text, size_t limit = 100) const;
+    /// Compact the search index by dropping the postings and labels of removed files.
+    /// Removing files is cheap, callers compact when idle or once the dead files make up a large share.
+    void Compact();
 };
 
 }  // namespace dashql
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+namespace dashql {
+
+/// A catalog-wide name id
+using InternedNameID = uint32_t;
+
+/// A catalog-wide interner that assigns integer ids to names.
+/// This lets the catalog key its indexes by packed integers instead of string tuples.
+///
+/// Names are reference-counted. Every Intern() acquires a reference that has to be given back with Release().
+/// A name keeps its id and its text stays valid as long as it is referenced, released ids are recycled.
+/// Lookups that must not keep a name alive, e.g. when erasing from an index, use Find().
+///
+/// Texts are copied unless the caller passes the owner of the memory they live in, e.g. a memory-mapped file.
+/// A borrowed name keeps its owner alive until it is released.
+struct NameInterner {
+   protected:
+    /// An interned name
+    struct Slot {
+        /// The text buffer, allocated per name so that released names give their memory back
+        std::unique_ptr<char[]> buffer;
+        /// The owner of a borrowed text
+        std::shared_ptr<const void> owner;
+        /// The text
+        std::string_view text;
+        /// The number of references, zero if the slot is free
+        uint32_t references = 0;
+    };
+    /// The interned names, indexed by name id
+    std::vector<Slot> slots;
+    /// The free name ids
+    std::vector<InternedNameID> free_ids;
+    /// The name ids by text
+    ankerl::unordered_dense::map<std::string_view, InternedNameID> ids_by_text;
+    /// The number of copied text bytes
+    size_t text_bytes = 0;
+
+   public:
+    /// Constructor
+    NameInterner();
+
+    /// Get the number of interned names
+    size_t GetSize() const { return ids_by_text.size(); }
+    /// Get the number of bytes used by the interner
+    size_t GetByteSize() const;
+    /// Get the text of an interned name
+    std::string_view Get(InternedNameID id) const { return slots[id].text; }
+    /// Get the number of references to an interned name
+    uint32_t GetReferenceCount(InternedNameID id) const { return slots[id].references; }
+    /// Find the id of a name without interning it
+    std::optional<InternedNameID> Find(std::string_view text) const;
+    /// Intern a name and acquire a reference.
+    /// If we didn't see the name before, the text is borrowed from its owner or copied if there is none.
+    InternedNameID Intern(std::string_view text, std::shared_ptr<const void> owner = nullptr);
+    /// Release a reference to a name, the name is dropped with its last reference
+    void Release(InternedNameID id);
+
+    /// Pack two name ids
+    static constexpr uint64_t Pack(InternedNameID a, InternedNameID b) {
+        return (static_cast<uint64_t>(a) << 32) | static_cast<uint64_t>(b);
+    }
+};
+
+}  // namespace dashql
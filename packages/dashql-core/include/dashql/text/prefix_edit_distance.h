@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dashql/utils/string_conversion.h"
+
+namespace dashql {
+
+/// A bounded Levenshtein automaton that matches a query against the prefixes of a candidate text.
+///
+/// The candidate is fed character by character, every character adds one row of the edit distance matrix.
+/// Rows are kept on a stack so that a walk over sorted names can share the rows of common prefixes and only
+/// recompute the diverging suffix. Characters are compared case-insensitively with the fuzzy lowercase table.
+struct PrefixEditDistance {
+   protected:
+    /// The lowercase query
+    std::string query;
+    /// The maximum distance
+    uint32_t max_distance;
+    /// The lowercase characters of the current candidate prefix
+    std::string chars;
+    /// The matrix rows, (chars.size() + 1) rows with (query.size() + 1) columns each
+    std::vector<uint32_t> rows;
+    /// The minimum of every row
+    std::vector<uint32_t> row_minimums;
+    /// The smallest distance of the query to any prefix up to every depth
+    std::vector<uint32_t> best_distances;
+
+   public:
+    /// Constructor
+    PrefixEditDistance(std::string_view q, uint32_t max_distance) : max_distance(max_distance) {
+        query.reserve(q.size());
+        for (auto c : q) {
+            query.push_back(tolower_fuzzy(c));
+        }
+        rows.reserve((query.size() + 1) * 32);
+        for (uint32_t j = 0; j <= query.size(); ++j) {
+            rows.push_back(j);
+        }
+        row_minimums.push_back(0);
+        best_distances.push_back(query.size());
+    }
+
+    /// Get the maximum distance
+    uint32_t GetMaxDistance() const { return max_distance; }
+    /// Get the length of the current candidate prefix
+    size_t GetDepth() const { return chars.size(); }
+    /// Get the lowercase character of the current candidate prefix at a position
+    unsigned char GetChar(size_t i) const { return chars[i]; }
+    /// Get the current candidate prefix
+    std::string_view GetPrefix() const { return chars; }
+    /// Get the distance between the full query and the current candidate prefix
+    uint32_t GetDistance() const { return rows[chars.size() * (query.size() + 1) + query.size()]; }
+    /// Get the smallest distance between the full query and any prefix of the current candidate prefix
+    uint32_t GetBestDistance() const { return best_distances.back(); }
+    /// Get the smallest distance that an extension of the current candidate prefix can reach
+    uint32_t GetRowMinimum() const { return row_minimums.back(); }
+    /// Can an extension of the current candidate prefix still match?
+    bool CanMatch() const { return row_minimums.back() <= max_distance; }
+
+    /// Pop characters until the candidate prefix has a given length
+    void Truncate(size_t depth) {
+        assert(depth <= chars.size());
+        chars.resize(depth);
+        rows.resize((depth + 1) * (query.size() + 1));
+        row_minimums.resize(depth + 1);
+        best_distances.resize(depth + 1);
+    }
+    /// Push a character of the candidate, returns the minimum of the new row
+    uint32_t Push(char c) {
+        auto lc = tolower_fuzzy(c);
+        auto n = query.size() + 1;
+        auto prev_ofs = chars.size() * n;
+        chars.push_back(lc);
+        rows.resize(rows.size() + n);
+        auto* prev = &rows[prev_ofs];
+        auto* next = prev + n;
+        next[0] = prev[0] + 1;
+        uint32_t row_min = next[0];
+        for (size_t j = 1; j < n; ++j) {
+            uint32_t substitute = prev[j - 1] + (static_cast<unsigned char>(query[j - 1]) != lc);
+            uint32_t insert = prev[j] + 1;
+            uint32_t remove = next[j - 1] + 1;
+            next[j] = std::min({substitute, insert, remove});
+            row_min = std::min(row_min, next[j]);
+        }
+        row_minimums.push_back(row_min);
+        best_distances.push_back(std::min(best_distances.back(), GetDistance()));
+        return row_min;
+    }
+
+    /// Match the query against all prefixes of a text.
+    /// Returns the smallest distance if it does not exceed the maximum distance.
+    std::optional<uint32_t> Match(std::string_view text) {
+        Truncate(0);
+        uint32_t best = GetDistance();
+        for (auto c : text) {
+            // Stop when no longer prefix can improve the best distance
+            if (Push(c) >= std::min(max_distance + 1, best)) {
+                break;
+            }
+            best = std::min(best, GetDistance());
+        }
+        if (best > max_distance) {
+            return std::nullopt;
+        }
+        return best;
+    }
+};
+
+}  // namespace dashql
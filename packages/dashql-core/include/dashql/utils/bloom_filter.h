@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "dashql/utils/string_conversion.h"
+
+namespace dashql {
+
+/// A register-blocked bloom filter over 64-bit hashes.
+///
+/// Every key sets a few bits within a single 64-bit block, a probe therefore costs one memory access and a mask test.
+/// With at least 16 bits per key, the false positive rate stays below 1%. The filter does not grow, owners reset it
+/// with a larger capacity and insert all keys again once it is full.
+class BloomFilter {
+   public:
+    /// The bits per key
+    static constexpr size_t BITS_PER_KEY = 16;
+    /// The bits that a key sets in its block
+    static constexpr size_t BITS_PER_BLOCK_KEY = 4;
+
+   protected:
+    /// The blocks, a power of two
+    std::vector<uint64_t> blocks;
+    /// The number of inserted keys
+    size_t key_count = 0;
+    /// The number of keys that the filter was sized for
+    size_t key_capacity = 0;
+
+    /// Mix the bits of a hash
+    static constexpr uint64_t Mix(uint64_t hash) {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+    /// Get the bits of a key within its block
+    static constexpr uint64_t GetMask(uint64_t hash) {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < BITS_PER_BLOCK_KEY; ++i) {
+            mask |= uint64_t{1} << ((hash >> (i * 6)) & 63);
+        }
+        return mask;
+    }
+    /// Get the block of a key
+    size_t GetBlock(uint64_t hash) const { return (hash >> 32) & (blocks.size() - 1); }
+
+   public:
+    /// Constructor
+    BloomFilter() = default;
+
+    /// Get the number of inserted keys
+    size_t GetKeyCount() const { return key_count; }
+    /// Get the number of keys that the filter was sized for
+    size_t GetKeyCapacity() const { return key_capacity; }
+    /// Get the number of bytes of the filter
+    size_t GetByteSize() const { return blocks.size() * sizeof(uint64_t); }
+
+    /// Clear the filter and size it for a number of keys
+    void Reset(size_t capacity) {
+        size_t block_count = std::bit_ceil(std::max<size_t>((capacity * BITS_PER_KEY + 63) / 64, 1));
+        blocks.assign(block_count, 0);
+        key_count = 0;
+        key_capacity = capacity;
+    }
+    /// Insert a hashed key
+    void Insert(uint64_t hash) {
+        if (blocks.empty()) {
+            Reset(1);
+        }
+        hash = Mix(hash);
+        blocks[GetBlock(hash)] |= GetMask(hash);
+        ++key_count;
+    }
+    /// Might the filter contain a hashed key?
+    /// Returns false only if the key was never inserted.
+    bool MayContain(uint64_t hash) const {
+        if (blocks.empty()) {
+            return false;
+        }
+        hash = Mix(hash);
+        auto mask = GetMask(hash);
+        return (blocks[GetBlock(hash)] & mask) == mask;
+    }
+
+    /// Hash a case-folded text with a seed.
+    /// Different seeds let one filter hold keys of different kinds.
+    static uint64_t HashFolded(std::string_view text, uint64_t seed = 0) {
+        // FNV-1a over the folded characters
+        uint64_t hash = 0xcbf29ce484222325ULL ^ Mix(seed);
+        for (char c : text) {
+            hash ^= tolower_fuzzy(static_cast<unsigned char>(c));
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+};
+
+}  // namespace dashql
@@ -200,6 +200,23 @@ template <typename T, size_t InitialSize = 1024> struct ChunkBuffer {
             local_offset = 0;
         }
     }
+    /// Apply a function for each node in a range
+    template <typename F> void ForEachIn(size_t begin, size_t count, F fn) const {
+        auto [chunk_id, chunk_offset] = find(begin);
+        auto local_offset = begin - chunk_offset;
+        auto global_offset = begin;
+        while (count > 0) {
+            auto& chunk = buffers[chunk_id];
+            assert(chunk.size() >= local_offset);
+            auto here = std::min(chunk.size() - local_offset, count);
+            for (size_t i = 0; i < here; ++i) {
+                fn(global_offset++, chunk[local_offset + i]);
+            }
+            count -= here;
+            ++chunk_id;
+            local_offset = 0;
+        }
+    }
     /// Flatten the buffer
     std::vector<T> Flatten() const {
         std::vector<T> flat;
@@ -55,7 +55,8 @@ struct StringPairHasher {
 struct StringPairEqual {
     using is_transparent = std::true_type;
 
-    template <typename A, typename B> bool operator()(std::pair<A, A> l, std::pair<B, B> r) const noexcept {
+    template <typename A, typename B>
+    bool operator()(const std::pair<A, A>& l, const std::pair<B, B>& r) const noexcept {
         std::pair<std::string_view, std::string_view> l_view = l;
         std::pair<std::string_view, std::string_view> r_view = r;
         return l_view == r_view;
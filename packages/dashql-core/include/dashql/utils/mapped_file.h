@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace dashql {
+
+/// A read-only memory mapping of a file.
+///
+/// The mapped pages are clean and backed by the file, the OS can drop them under memory pressure and page them in
+/// again when they are accessed. Mappings are only supported by native builds, WASM builds fail to open files.
+class MappedFile {
+   protected:
+    /// The mapped data
+    const std::byte* data = nullptr;
+    /// The size of the mapping
+    size_t size = 0;
+
+    /// Constructor
+    MappedFile(const std::byte* data, size_t size) : data(data), size(size) {}
+
+   public:
+    /// Destructor
+    ~MappedFile();
+    /// Copies would unmap twice
+    MappedFile(const MappedFile&) = delete;
+    /// Copies would unmap twice
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Get the mapped data
+    std::span<const std::byte> GetData() const { return {data, size}; }
+    /// Get the size of the mapping
+    size_t GetSize() const { return size; }
+    /// Tell the OS that the pages are accessed randomly and should not be read ahead
+    void AdviseRandomAccess() const;
+
+    /// Map a file, returns nullptr if the file cannot be mapped
+    static std::unique_ptr<MappedFile> Open(const std::string& path);
+};
+
+}  // namespace dashql
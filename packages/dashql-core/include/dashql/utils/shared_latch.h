@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <shared_mutex>
+#include <thread>
+
+namespace dashql {
+
+/// A reader-writer latch that knows which thread holds it exclusively.
+///
+/// Satisfies the SharedMutex requirements and can be used with std::unique_lock and std::shared_lock.
+/// Code that must only run under the exclusive latch asserts IsHeldExclusively(), nested modifications use it to
+/// skip locking a latch that the calling thread already holds.
+class SharedLatch {
+   protected:
+    /// The mutex
+    std::shared_mutex mutex;
+    /// The thread that holds the latch exclusively, if any
+    std::atomic<std::thread::id> exclusive_owner;
+
+   public:
+    /// Lock exclusively
+    void lock() {
+        mutex.lock();
+        exclusive_owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    }
+    /// Try to lock exclusively
+    bool try_lock() {
+        if (!mutex.try_lock()) {
+            return false;
+        }
+        exclusive_owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        return true;
+    }
+    /// Unlock exclusively
+    void unlock() {
+        exclusive_owner.store(std::thread::id{}, std::memory_order_relaxed);
+        mutex.unlock();
+    }
+    /// Lock shared
+    void lock_shared() { mutex.lock_shared(); }
+    /// Try to lock shared
+    bool try_lock_shared() { return mutex.try_lock_shared(); }
+    /// Unlock shared
+    void unlock_shared() { mutex.unlock_shared(); }
+
+    /// Does the calling thread hold the latch exclusively?
+    bool IsHeldExclusively() const {
+        return exclusive_owner.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    }
+};
+
+}  // namespace dashql
@@ -44,7 +44,7 @@ template <size_t InitialSize = 1024> struct StringPool {
     StringPool() : pages(), next_chunk_size(InitialSize) { grow(); }
 
     /// Get the size
-    size_t GetSize() { return total_string_bytes; }
+    size_t GetSize() const { return total_string_bytes; }
     /// Append a node
     std::span<char> Allocate(size_t n) {
         Page& last = pages.back();
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dashql/utils/string_conversion.h"
+
+namespace dashql {
+
+/// An immutable suffix array with LCP array over a set of texts.
+///
+/// The index lives in a single flat buffer that can be written to disk and memory-mapped again.
+/// Queries read the buffer in place, nothing is deserialized. The layout is:
+///
+///     Header
+///     uint32_t text_offsets[text_count + 1]   Offsets of the texts in the text bytes
+///     uint32_t suffixes[suffix_count]         Text byte offsets of all suffixes, sorted case-insensitively
+///     uint8_t lcp[suffix_count]               Common prefix with the previous suffix, saturated at 255
+///     char text_bytes[text_bytes]             The original texts, each terminated by a zero byte
+///
+/// A suffix index costs 5 bytes per character, a pointer-based suffix trie needs several times that.
+class SuffixArray {
+   public:
+    using StringView = fuzzy_ci_string_view;
+
+    /// The magic number "DQSA"
+    static constexpr uint32_t MAGIC = 0x41535144;
+    /// The format version
+    static constexpr uint32_t VERSION = 1;
+    /// The maximum LCP value
+    static constexpr uint32_t MAX_LCP = 255;
+
+    /// The buffer header
+    struct Header {
+        /// The magic number
+        uint32_t magic;
+        /// The format version
+        uint32_t version;
+        /// The number of texts
+        uint32_t text_count;
+        /// The number of suffixes
+        uint32_t suffix_count;
+        /// The number of text bytes, including the terminators
+        uint32_t text_bytes;
+        /// Padding
+        uint32_t reserved;
+    };
+    static_assert(sizeof(Header) == 24);
+
+   protected:
+    /// The header
+    const Header* header = nullptr;
+    /// The text offsets
+    const uint32_t* text_offsets = nullptr;
+    /// The suffixes
+    const uint32_t* suffixes = nullptr;
+    /// The LCP values
+    const uint8_t* lcp = nullptr;
+    /// The text bytes
+    const char* text_bytes = nullptr;
+
+    /// Constructor
+    explicit SuffixArray(const std::byte* buffer);
+
+    /// Get a suffix
+    inline const char* GetSuffix(size_t i) const { return text_bytes + suffixes[i]; }
+    /// Compare a zero-terminated suffix with a prefix, returns 0 if the suffix starts with the prefix
+    static int ComparePrefix(const char* suffix, StringView prefix);
+
+   public:
+    /// Constructor
+    SuffixArray() = default;
+
+    /// Get the number of texts
+    size_t GetTextCount() const { return header ? header->text_count : 0; }
+    /// Get the number of suffixes
+    size_t GetSuffixCount() const { return header ? header->suffix_count : 0; }
+    /// Get the buffer
+    const std::byte* GetBuffer() const { return reinterpret_cast<const std::byte*>(header); }
+    /// Get the size of the buffer
+    size_t GetByteSize() const;
+    /// Get a text
+    std::string_view GetText(size_t text_id) const {
+        return {text_bytes + text_offsets[text_id], text_offsets[text_id + 1] - text_offsets[text_id] - 1};
+    }
+    /// Get the text that contains a suffix
+    size_t GetTextId(size_t suffix_id) const;
+
+    /// Find the range of suffixes that start with a prefix
+    std::pair<size_t, size_t> FindPrefix(StringView prefix) const;
+    /// Find a text with the exact same characters.
+    /// Empty texts have no suffixes and are never found.
+    std::optional<size_t> FindText(std::string_view text) const;
+    /// Visit all suffixes that start with a prefix.
+    /// The function receives the text id and the offset of the suffix within the text.
+    /// A text is visited once for every matching suffix.
+    template <typename Fn> void IteratePrefix(StringView prefix, Fn fn) const {
+        auto [begin, end] = FindPrefix(prefix);
+        for (size_t i = begin; i < end; ++i) {
+            auto text_id = GetTextId(i);
+            fn(text_id, suffixes[i] - text_offsets[text_id]);
+        }
+    }
+
+    /// Build the buffer of a suffix array over texts.
+    /// Texts must not contain zero bytes.
+    static std::vector<std::byte> Build(std::span<const std::string_view> texts);
+    /// Open a suffix array in a buffer, returns nullopt if the buffer is not a valid suffix array.
+    /// The buffer must be 4-byte aligned and outlive the suffix array.
+    static std::optional<SuffixArray> Open(std::span<const std::byte> buffer);
+};
+
+}  // namespace dashql
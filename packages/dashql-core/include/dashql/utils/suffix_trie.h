@@ -104,8 +104,11 @@ struct SuffixTrie {
 
         /// Constructor
         InnerNode48(StringView partial);
-        /// Find a child
-        inline Node *Find(unsigned char c) { return c == 0 ? nullptr : children[child_ids[tolower_fuzzy(c)]]; }
+        /// Find a child, child ids are offset by one since 0 marks a missing child
+        inline Node *Find(unsigned char c) {
+            auto child_id = child_ids[tolower_fuzzy(c)];
+            return child_id == 0 ? nullptr : children[child_id - 1];
+        }
     };
     /// Full node with 256 children
     struct InnerNode256 : public Node {
@@ -120,7 +123,7 @@ struct SuffixTrie {
 
    protected:
     /// The root of the tree
-    Node *root;
+    Node *root = nullptr;
     /// The trie entries
     std::vector<Entry> entries;
     /// The leaf nodes
@@ -140,8 +143,10 @@ struct SuffixTrie {
    public:
     /// Access entries
     auto &GetEntries() const { return entries; }
+    /// Get the number of allocated bytes
+    size_t GetByteSize() const;
     /// Iterates through the entries in the map that match a given prefix.
-    void IteratePrefix(StringView prefix, IterationCallback callback, ContextType context);
+    void IteratePrefix(StringView prefix, IterationCallback callback, ContextType context) const;
 
     /// Bulkload a suffix trie from entries
     static std::unique_ptr<SuffixTrie> BulkLoad(std::vector<Entry> entries);
@@ -61,6 +61,8 @@ template <typename ValueType> struct TopKHeap {
     }
     /// Get the heap entries
     auto& GetEntries() const { return entries; }
+    /// Get the capacity
+    size_t GetCapacity() const { return entries.capacity(); }
 };
 
 }  // namespace dashql
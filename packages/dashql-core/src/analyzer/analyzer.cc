@@ -8,21 +8,28 @@
 
 namespace dashql {
 
-Analyzer::Analyzer(std::shared_ptr<ParsedScript> parsed, Catalog& catalog)
+Analyzer::Analyzer(std::shared_ptr<ParsedScript> parsed, Catalog& catalog, const AnalyzedScript* previous)
     : parsed(parsed),
       analyzed(std::make_shared<AnalyzedScript>(parsed, catalog)),
       catalog(catalog),
       pass_manager(*parsed),
-      name_resolution(std::make_unique<NameResolutionPass>(*analyzed, catalog, attribute_index)) {}
+      name_resolution(std::make_unique<NameResolutionPass>(*analyzed, catalog, attribute_index, previous)) {}
 
 std::pair<std::shared_ptr<AnalyzedScript>, buffers::StatusCode> Analyzer::Analyze(std::shared_ptr<ParsedScript> parsed,
-                                                                                Catalog& catalog) {
+                                                                                Catalog& catalog,
+                                                                                const AnalyzedScript* previous) {
     if (parsed == nullptr) {
         return {nullptr, buffers::StatusCode::ANALYZER_INPUT_NOT_PARSED};
     }
+    // Only reuse table ids of a previous analysis of the same catalog entry
+    if (previous && previous->GetCatalogEntryId() != parsed->external_id) {
+        previous = nullptr;
+    }
     // Run analysis passes
-    Analyzer az{parsed, catalog};
+    Analyzer az{parsed, catalog, previous};
     az.pass_manager.Execute(*az.name_resolution);
+    // Index the declared names for the resolvers of other catalog entries
+    az.analyzed->UpdateNameFilter();
 
     // Build program
     return {az.analyzed, buffers::StatusCode::OK};
@@ -10,6 +10,7 @@
 #include "dashql/buffers/index_generated.h"
 #include "dashql/script.h"
 #include "dashql/text/names.h"
+#include "dashql/text/prefix_edit_distance.h"
 #include "dashql/utils/string_conversion.h"
 #include "dashql/utils/string_trimming.h"
 
@@ -36,8 +37,14 @@ static constexpr Completion::ScoreValueType UNRESOLVED_PEER_SCORE_MODIFIER = 2;
 static constexpr Completion::ScoreValueType DOT_SCHEMA_SCORE_MODIFIER = 2;
 static constexpr Completion::ScoreValueType DOT_TABLE_SCORE_MODIFIER = 2;
 static constexpr Completion::ScoreValueType DOT_COLUMN_SCORE_MODIFIER = 2;
+static constexpr Completion::ScoreValueType FUZZY_SCORE_MODIFIER = 10;
+static constexpr Completion::ScoreValueType FUZZY_EDIT_PENALTY = 4;
+
+// The number of candidate visits between two deadline checks
+static constexpr size_t DEADLINE_CHECK_INTERVAL = 64;
 
 static_assert(PREFIX_SCORE_MODIFIER > SUBSTRING_SCORE_MODIFIER, "Begin a prefix weighs more than being a substring");
+static_assert(SUBSTRING_SCORE_MODIFIER > FUZZY_SCORE_MODIFIER, "Exact matches weigh more than matches with typos");
 static_assert((NAME_TAG_UNLIKELY + SUBSTRING_SCORE_MODIFIER) > NAME_TAG_LIKELY,
               "An unlikely name that is a substring outweighs a likely name");
 static_assert((NAME_TAG_UNLIKELY + KEYWORD_VERY_POPULAR) < NAME_TAG_LIKELY,
@@ -336,8 +343,8 @@ void Completion::FindCandidatesForNamePath() {
                 // Is referring to a schema in the default database?
                 auto& a_text = name_path[0].name.value().get().text;
                 std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>> tables;
-                script.analyzed_script->ResolveSchemaTablesWithCatalog(catalog.GetDefaultDatabaseName(), a_text,
-                                                                       tables);
+                script.analyzed_script->ResolveSchemaTablesWithCatalog(catalog, catalog.GetDefaultDatabaseName(),
+                                                                       a_text, tables);
                 if (!tables.empty()) {
                     // Add the tables as candidates
                     for (auto& [table, through_catalog] : tables) {
@@ -355,7 +362,7 @@ void Completion::FindCandidatesForNamePath() {
 
                 // Is referring to a database?
                 std::vector<std::pair<std::reference_wrapper<const CatalogEntry::SchemaReference>, bool>> schemas;
-                script.analyzed_script->ResolveDatabaseSchemasWithCatalog(a_text, schemas);
+                script.analyzed_script->ResolveDatabaseSchemasWithCatalog(catalog, a_text, schemas);
                 if (!schemas.empty()) {
                     // Add the schemas name as candidates
                     for (auto& [schema, through_catalog] : schemas) {
@@ -380,7 +387,7 @@ void Completion::FindCandidatesForNamePath() {
 
                 // Is a known?
                 std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>> tables;
-                script.analyzed_script->ResolveSchemaTablesWithCatalog(a_text, b_text, tables);
+                script.analyzed_script->ResolveSchemaTablesWithCatalog(catalog, a_text, b_text, tables);
                 if (!tables.empty()) {
                     // Add the tables as candidates
                     for (auto& [table, through_catalog] : tables) {
@@ -563,14 +570,101 @@ void Completion::AddExpectedKeywordsAsCandidates(std::span<parser::Parser::Expec
     }
 }
 
-void Completion::findCandidatesInIndex(const CatalogEntry::NameSearchIndex& index, bool through_catalog) {
+void Completion::AddNameCandidate(const RegisteredName& name_info, fuzzy_ci_string_view ci_prefix_text,
+                                  bool through_catalog, uint32_t edit_distance) {
     using Relative = ScannedScript::LocationInfo::RelativePosition;
+    auto& location = cursor.scanner_location;
+
+    // Check if it's the cursor symbol
+    if (!through_catalog && name_info.occurrences == 1 && location->text_offset >= name_info.location.offset() &&
+        location->text_offset <= (name_info.location.offset() + name_info.location.length())) {
+        return;
+    }
+    // Determine the candidate tags
+    Completion::CandidateTags candidate_tags{buffers::CandidateTag::NAME_INDEX};
+    // Added through catalog?
+    candidate_tags.AddIf(buffers::CandidateTag::THROUGH_CATALOG, through_catalog);
+    // Is a prefix?
+    switch (location->relative_pos) {
+        case Relative::BEGIN_OF_SYMBOL:
+        case Relative::MID_OF_SYMBOL:
+        case Relative::END_OF_SYMBOL:
+            if (edit_distance > 0) {
+                candidate_tags |= buffers::CandidateTag::FUZZY_MATCH;
+            } else if (fuzzy_ci_string_view{name_info.text.data(), name_info.text.size()}.starts_with(ci_prefix_text)) {
+                candidate_tags |= buffers::CandidateTag::PREFIX_MATCH;
+            } else {
+                candidate_tags |= buffers::CandidateTag::SUBSTRING_MATCH;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Do we know the candidate already?
+    Candidate* candidate;
+    if (auto iter = candidates_by_name.find(name_info.text); iter != candidates_by_name.end()) {
+        candidate = &iter->second.get();
+        candidate->coarse_name_tags |= name_info.coarse_analyzer_tags;
+        candidate->candidate_tags |= candidate_tags;
+        candidate->edit_distance = std::min(candidate->edit_distance, edit_distance);
+    } else {
+        candidate = &candidates.Append(Candidate{
+            .name = name_info.text,
+            .coarse_name_tags = name_info.coarse_analyzer_tags,
+            .candidate_tags = candidate_tags,
+            .replace_text_at = location->symbol.location,
+            .catalog_objects = {},
+            .edit_distance = edit_distance,
+        });
+        candidates_by_name.insert({name_info.text, *candidate});
+    }
+
+    // Add the resolved objects
+    for (auto& o : name_info.resolved_objects) {
+        // Already registered?
+        if (auto iter = candidate_objects_by_object.find(&o); iter != candidate_objects_by_object.end()) {
+            // Note that this assumes that a catalog object can be added to at most a single candidate.
+            assert(&iter->second.get().candidate == candidate);
+            iter->second.get().candidate_tags |= candidate_tags;
+            continue;
+        } else {
+            // Allocate the catalog object
+            auto& co = candidate_objects.Append(CandidateCatalogObject{
+                .candidate = *candidate,
+                .candidate_tags = candidate_tags,
+                .catalog_object = o,
+            });
+            candidate->catalog_objects.PushBack(co);
+
+            assert(!candidate_objects_by_object.contains(&o));
+            candidate_objects_by_object.insert({&o, co});
+        }
+    }
+}
+
+/// Get the maximum number of typos for a cursor prefix.
+/// Short prefixes would match almost every name with a single edit.
+static uint32_t getMaxEditDistance(size_t prefix_length) {
+    if (prefix_length < 3) {
+        return 0;
+    } else if (prefix_length < 6) {
+        return 1;
+    } else {
+        return 2;
+    }
+}
+
+void Completion::FindCandidatesInIndexes(std::span<const parser::Parser::ExpectedSymbol> expected_symbols) {
+    auto& analyzed = cursor.script.analyzed_script;
+    if (!analyzed) {
+        return;
+    }
 
     // Get the current cursor prefix
     auto& location = cursor.scanner_location;
     auto symbol_ofs = location->symbol.location.offset();
     auto symbol_prefix = std::max<uint32_t>(location->text_offset, symbol_ofs) - symbol_ofs;
-    std::string_view prefix_text{cursor.text.data(), symbol_prefix};
     fuzzy_ci_string_view ci_prefix_text{cursor.text.data(), symbol_prefix};
 
     // Fall back to the full word if the cursor prefix is empty
@@ -579,85 +673,127 @@ void Completion::findCandidatesInIndex(const CatalogEntry::NameSearchIndex& inde
         search_text = {cursor.text.data(), cursor.text.size()};
     }
 
-    // Find all suffixes for the cursor prefix
-    for (auto iter = index.lower_bound(search_text); iter != index.end() && iter->first.starts_with(search_text);
-         ++iter) {
-        auto& name_info = iter->second.get();
-        // Check if it's the cursor symbol
-        if (!through_catalog && name_info.occurrences == 1 && location->text_offset >= name_info.location.offset() &&
-            location->text_offset <= (name_info.location.offset() + name_info.location.length())) {
-            continue;
+    // Find candidates in name dictionary of main script
+    analyzed->GetNameSearchIndex().IteratePrefix(
+        search_text, [&](const RegisteredName& name) { AddNameCandidate(name, ci_prefix_text, false); });
+
+    // The names of the script are complete, everything from the catalog may be cut off by the deadline
+    if (DeadlineExceeded(true)) {
+        return;
+    }
+
+    // Find the names in the merged name index of the catalog and in the name indexes of attached frozen pools.
+    // If the user kept typing the symbol of the last completion, we only filter the names that we found before.
+    // We skip the postings of the main script.
+    auto& catalog = cursor.script.catalog;
+    auto main_entry_id = analyzed->GetCatalogEntryId();
+    std::vector<const CatalogNameIndex::NamePostings*> catalog_names;
+    bool catalog_names_complete = true;
+    if (cache && cache->CanRefine(catalog.GetVersion(), cursor.statement_id, symbol_ofs, expected_symbols,
+                                  search_text)) {
+        for (auto* postings : cache->catalog_names) {
+            if (fuzzy_ci_string_view{postings->text.data(), postings->text.size()}.find(search_text) !=
+                fuzzy_ci_string_view::npos) {
+                catalog_names.push_back(postings);
+            }
         }
-        // Determine the candidate tags
-        Completion::CandidateTags candidate_tags{buffers::CandidateTag::NAME_INDEX};
-        // Added through catalog?
-        candidate_tags.AddIf(buffers::CandidateTag::THROUGH_CATALOG, through_catalog);
-        // Is a prefix?
-        switch (location->relative_pos) {
-            case Relative::BEGIN_OF_SYMBOL:
-            case Relative::MID_OF_SYMBOL:
-            case Relative::END_OF_SYMBOL:
-                if (fuzzy_ci_string_view{name_info.text.data(), name_info.text.size()}.starts_with(ci_prefix_text)) {
-                    candidate_tags |= buffers::CandidateTag::PREFIX_MATCH;
-                } else {
-                    candidate_tags |= buffers::CandidateTag::SUBSTRING_MATCH;
+        ++cache->hits;
+        // The names are ordered by their most relevant posting
+        for (auto* postings : catalog_names) {
+            for (auto& posting : postings->postings) {
+                if (DeadlineExceeded()) {
+                    break;
                 }
-                break;
-            default:
-                break;
+                if (posting.catalog_entry_id != main_entry_id) {
+                    AddNameCandidate(*posting.name, ci_prefix_text, true);
+                }
+            }
         }
-
-        // Do we know the candidate already?
-        Candidate* candidate;
-        if (auto iter = candidates_by_name.find(name_info.text); iter != candidates_by_name.end()) {
-            candidate = &iter->second.get();
-            candidate->coarse_name_tags |= name_info.coarse_analyzer_tags;
-            candidate->candidate_tags |= candidate_tags;
-        } else {
-            candidate = &candidates.Append(Candidate{
-                .name = name_info.text,
-                .coarse_name_tags = name_info.coarse_analyzer_tags,
-                .candidate_tags = candidate_tags,
-                .replace_text_at = location->symbol.location,
-                .catalog_objects = {},
+    } else {
+        // The indexes visit the catalog entries in rank order and pass every name once per entry.
+        // Whatever we found when the deadline passes therefore comes from the most relevant entries.
+        ankerl::unordered_dense::set<const CatalogNameIndex::NamePostings*> visited;
+        catalog.IterateNameIndexes([&](const CatalogNameIndex& index) {
+            if (!catalog_names_complete) {
+                return;
+            }
+            index.IteratePrefix(search_text, [&](const CatalogNameIndex::NamePostings& postings,
+                                                 const CatalogNameIndex::Posting& posting) {
+                if (DeadlineExceeded()) {
+                    catalog_names_complete = false;
+                    return false;
+                }
+                if (visited.insert(&postings).second) {
+                    catalog_names.push_back(&postings);
+                }
+                if (posting.catalog_entry_id != main_entry_id) {
+                    AddNameCandidate(*posting.name, ci_prefix_text, true);
+                }
+                return true;
             });
-            candidates_by_name.insert({name_info.text, *candidate});
+        });
+        if (cache) {
+            ++cache->misses;
         }
-
-        // Add the resolved objects
-        for (auto& o : name_info.resolved_objects) {
-            // Already registered?
-            if (auto iter = candidate_objects_by_object.find(&o); iter != candidate_objects_by_object.end()) {
-                // Note that this assumes that a catalog object can be added to at most a single candidate.
-                assert(&iter->second.get().candidate == candidate);
-                iter->second.get().candidate_tags |= candidate_tags;
-                continue;
-            } else {
-                // Allocate the catalog object
-                auto& co = candidate_objects.Append(CandidateCatalogObject{
-                    .candidate = *candidate,
-                    .candidate_tags = candidate_tags,
-                    .catalog_object = o,
-                });
-                candidate->catalog_objects.PushBack(co);
-
-                assert(!candidate_objects_by_object.contains(&o));
-                candidate_objects_by_object.insert({&o, co});
-            }
+    }
+    // Remember the names for the next keystroke, unless the deadline cut the scan short
+    if (cache && catalog_names_complete) {
+        cache->catalog_version = catalog.GetVersion();
+        cache->statement_id = cursor.statement_id;
+        cache->symbol_offset = symbol_ofs;
+        cache->expected_symbols.assign(expected_symbols.begin(), expected_symbols.end());
+        cache->search_text.clear();
+        for (auto c : search_text) {
+            cache->search_text.push_back(tolower_fuzzy(c));
         }
+        cache->catalog_names = std::move(catalog_names);
     }
-}
 
-void Completion::FindCandidatesInIndexes() {
-    if (auto& analyzed = cursor.script.analyzed_script) {
-        // Find candidates in name dictionary of main script
-        findCandidatesInIndex(analyzed->GetNameSearchIndex(), false);
-        // Find candidates in name dictionary of external script
-        cursor.script.catalog.IterateRanked([this, &analyzed](auto entry_id, auto& entry, size_t rank) {
-            if (&entry != analyzed.get()) {
-                findCandidatesInIndex(entry.GetNameSearchIndex(), true);
+    // Find names that match the prefix with typos.
+    // We only do this within a symbol and allow more edits for longer prefixes.
+    using Relative = ScannedScript::LocationInfo::RelativePosition;
+    if (location->relative_pos != Relative::MID_OF_SYMBOL && location->relative_pos != Relative::END_OF_SYMBOL) {
+        return;
+    }
+    auto max_distance = getMaxEditDistance(ci_prefix_text.size());
+    if (max_distance == 0 || DeadlineExceeded(true)) {
+        return;
+    }
+    // Skip names that matched without typos
+    auto matched_exactly = [&](std::string_view text) {
+        auto iter = candidates_by_name.find(text);
+        return iter != candidates_by_name.end() &&
+               !iter->second.get().candidate_tags.contains(buffers::CandidateTag::FUZZY_MATCH);
+    };
+    // Check the names of the main script directly, scripts are small.
+    // Like the catalog name index, we expect the first character to be typed correctly.
+    PrefixEditDistance automaton{{ci_prefix_text.data(), ci_prefix_text.size()}, max_distance};
+    analyzed->GetNameSearchIndex().IterateNames([&](const RegisteredName& name) {
+        if (name.text.empty() || tolower_fuzzy(name.text[0]) != tolower_fuzzy(ci_prefix_text[0]) ||
+            matched_exactly(name.text)) {
+            return;
+        }
+        if (auto distance = automaton.Match(name.text); distance.has_value() && *distance > 0) {
+            AddNameCandidate(name, ci_prefix_text, false, *distance);
+        }
+    });
+    // Walk the sorted names of the catalog
+    std::vector<CatalogNameIndex::FuzzyMatch> fuzzy_matches;
+    catalog.IterateNameIndexes([&](const CatalogNameIndex& index) {
+        index.FindFuzzyPrefixMatches(ci_prefix_text, max_distance, fuzzy_matches);
+    });
+    for (auto& match : fuzzy_matches) {
+        if (DeadlineExceeded()) {
+            break;
+        }
+        if (match.distance == 0 || matched_exactly(match.postings.text)) {
+            continue;
+        }
+        for (auto& posting : match.postings.postings) {
+            if (posting.catalog_entry_id != main_entry_id) {
+                AddNameCandidate(*posting.name, ci_prefix_text, true, match.distance);
             }
-        });
+        }
     }
 }
 
@@ -667,88 +803,117 @@ void Completion::PromoteTablesAndPeersForUnresolvedColumns() {
     }
     auto& analyzed_script = *cursor.script.analyzed_script;
     auto& catalog = cursor.script.catalog;
+
+    // The precomputed candidate tables point into catalog entries.
+    // Only use them if the catalog did not change since the analysis, otherwise resolve the names again.
+    bool catalog_changed = analyzed_script.catalog_version != catalog.GetVersion();
     std::vector<CatalogEntry::TableColumn> tmp_columns;
+    std::vector<std::reference_wrapper<const CatalogEntry::TableDeclaration>> tmp_tables;
 
-    // Iterate all unresolved columns in the current script
-    // XXX Don't search all unresolved expressions but only the unresolved ones in the current statement
-    analyzed_script.expressions.ForEach([&](size_t i, AnalyzedScript::Expression& expr) {
-        // Is unresolved?
-        if (auto* unresolved = std::get_if<AnalyzedScript::Expression::UnresolvedColumnRef>(&expr.inner)) {
-            auto& column_name = unresolved->column_name.column_name.get();
+    // Iterate all distinct unresolved column names in the current statement
+    for (auto& unresolved : analyzed_script.GetUnresolvedColumnNames(*cursor.statement_id)) {
+        std::span<const std::reference_wrapper<const CatalogEntry::TableDeclaration>> candidate_tables =
+            unresolved.candidate_tables;
+        if (catalog_changed) {
             tmp_columns.clear();
-            // Resolve all table columns that would match the unresolved name?
-            cursor.script.analyzed_script->ResolveTableColumnsWithCatalog(column_name, tmp_columns);
-            // Register the table name
+            tmp_tables.clear();
+            analyzed_script.ResolveTableColumnsWithCatalog(catalog, unresolved.column_name.get().text, tmp_columns);
             for (auto& table_col : tmp_columns) {
-                auto& table = table_col.table->get();
-                auto& table_name = table.table_name.table_name.get();
-                // Boost the table name as candidate (if any)
-                if (auto iter = candidate_objects_by_object.find(&table); iter != candidate_objects_by_object.end()) {
-                    auto& co = iter->second.get();
-                    co.candidate_tags |= buffers::CandidateTag::RESOLVING_TABLE;
-                    co.candidate.candidate_tags |= buffers::CandidateTag::RESOLVING_TABLE;
+                if (table_col.table.has_value()) {
+                    tmp_tables.push_back(table_col.table->get());
                 }
-                // Promote column names in these tables
-                for (auto& peer_col : table.table_columns) {
-                    // Boost the peer name as candidate (if any)
-                    if (auto iter = candidate_objects_by_object.find(&peer_col);
-                        iter != candidate_objects_by_object.end()) {
-                        auto& co = iter->second.get();
-                        co.candidate_tags |= buffers::CandidateTag::UNRESOLVED_PEER;
-                        co.candidate.candidate_tags |= buffers::CandidateTag::UNRESOLVED_PEER;
-                    }
+            }
+            candidate_tables = tmp_tables;
+        }
+        // Register the tables that would resolve the name
+        for (auto& table_ref : candidate_tables) {
+            auto& table = table_ref.get();
+            // Boost the table name as candidate (if any)
+            if (auto iter = candidate_objects_by_object.find(&table); iter != candidate_objects_by_object.end()) {
+                auto& co = iter->second.get();
+                co.candidate_tags |= buffers::CandidateTag::RESOLVING_TABLE;
+                co.candidate.candidate_tags |= buffers::CandidateTag::RESOLVING_TABLE;
+            }
+            // Promote column names in these tables
+            for (auto& peer_col : table.table_columns) {
+                // Boost the peer name as candidate (if any)
+                if (auto iter = candidate_objects_by_object.find(&peer_col);
+                    iter != candidate_objects_by_object.end()) {
+                    auto& co = iter->second.get();
+                    co.candidate_tags |= buffers::CandidateTag::UNRESOLVED_PEER;
+                    co.candidate.candidate_tags |= buffers::CandidateTag::UNRESOLVED_PEER;
                 }
             }
         }
-    });
+    }
 }
 
-static const NameScoringTable& selectNameScoringTable(buffers::CompletionStrategy strategy) {
+/// A lookup table that maps a name tag bitset to the maximum score among its tags
+using NameScoringLUT = std::array<Completion::ScoreValueType, 256>;
+/// A lookup table that maps one byte of a candidate tag bitset to the sum of its tag scores
+using CandidateScoringLUT = std::array<Completion::ScoreValueType, 256>;
+
+static constexpr NameScoringLUT buildNameScoringLUT(const NameScoringTable& table) {
+    NameScoringLUT lut{};
+    for (size_t tags = 0; tags < lut.size(); ++tags) {
+        for (auto& entry : table) {
+            if ((tags & static_cast<size_t>(entry.first)) != 0) {
+                lut[tags] = std::max(lut[tags], entry.second);
+            }
+        }
+    }
+    return lut;
+}
+
+static constexpr NameScoringLUT NAME_SCORE_DEFAULTS_LUT = buildNameScoringLUT(NAME_SCORE_DEFAULTS);
+static constexpr NameScoringLUT NAME_SCORE_TABLE_REF_LUT = buildNameScoringLUT(NAME_SCORE_TABLE_REF);
+static constexpr NameScoringLUT NAME_SCORE_COLUMN_REF_LUT = buildNameScoringLUT(NAME_SCORE_COLUMN_REF);
+
+static const NameScoringLUT& selectNameScoringLUT(buffers::CompletionStrategy strategy) {
     switch (strategy) {
         case buffers::CompletionStrategy::DEFAULT:
-            return NAME_SCORE_DEFAULTS;
+            return NAME_SCORE_DEFAULTS_LUT;
         case buffers::CompletionStrategy::TABLE_REF:
-            return NAME_SCORE_TABLE_REF;
+            return NAME_SCORE_TABLE_REF_LUT;
         case buffers::CompletionStrategy::COLUMN_REF:
-            return NAME_SCORE_COLUMN_REF;
+            return NAME_SCORE_COLUMN_REF_LUT;
     }
 }
 
-Completion::ScoreValueType computeCandidateScore(Completion::CandidateTags tags) {
+static constexpr Completion::ScoreValueType computeCandidateTagScore(uint32_t tags) {
+    auto has = [&](buffers::CandidateTag tag) { return (tags & static_cast<uint32_t>(tag)) != 0; };
     Completion::ScoreValueType score = 0;
-    score += ((tags & buffers::CandidateTag::SUBSTRING_MATCH) != 0) * SUBSTRING_SCORE_MODIFIER;
-    score += ((tags & buffers::CandidateTag::PREFIX_MATCH) != 0) * PREFIX_SCORE_MODIFIER;
-    score += ((tags & buffers::CandidateTag::RESOLVING_TABLE) != 0) * RESOLVING_TABLE_SCORE_MODIFIER;
-    score += ((tags & buffers::CandidateTag::UNRESOLVED_PEER) != 0) * UNRESOLVED_PEER_SCORE_MODIFIER;
-    score += ((tags & buffers::CandidateTag::DOT_RESOLUTION_TABLE) != 0) * DOT_TABLE_SCORE_MODIFIER;
-    score += ((tags & buffers::CandidateTag::DOT_RESOLUTION_SCHEMA) != 0) * DOT_SCHEMA_SCORE_MODIFIER;
-    score += ((tags & buffers::CandidateTag::DOT_RESOLUTION_COLUMN) != 0) * DOT_COLUMN_SCORE_MODIFIER;
+    score += has(buffers::CandidateTag::SUBSTRING_MATCH) * SUBSTRING_SCORE_MODIFIER;
+    score += has(buffers::CandidateTag::PREFIX_MATCH) * PREFIX_SCORE_MODIFIER;
+    score += has(buffers::CandidateTag::RESOLVING_TABLE) * RESOLVING_TABLE_SCORE_MODIFIER;
+    score += has(buffers::CandidateTag::UNRESOLVED_PEER) * UNRESOLVED_PEER_SCORE_MODIFIER;
+    score += has(buffers::CandidateTag::DOT_RESOLUTION_TABLE) * DOT_TABLE_SCORE_MODIFIER;
+    score += has(buffers::CandidateTag::DOT_RESOLUTION_SCHEMA) * DOT_SCHEMA_SCORE_MODIFIER;
+    score += has(buffers::CandidateTag::DOT_RESOLUTION_COLUMN) * DOT_COLUMN_SCORE_MODIFIER;
+    score += has(buffers::CandidateTag::FUZZY_MATCH) * FUZZY_SCORE_MODIFIER;
     return score;
 }
 
-void Completion::FlushCandidatesAndFinish() {
-    // Helper to check if two locations overlap.
-    // Two ranges overlap if the sum of their widths exceeds the (max - min).
-    auto intersects = [](const sx::Location& l, const sx::Location& r) {
-        auto l_begin = l.offset();
-        auto l_end = l_begin + l.length();
-        auto r_begin = r.offset();
-        auto r_end = r_begin + r.length();
-        auto min = std::min(l_begin, r_begin);
-        auto max = std::max(l_end, r_end);
-        auto l_width = l_end - l_begin;
-        auto r_width = r_end - r_begin;
-        return (max - min) < (l_width + r_width);
-    };
-
-    // Find name if under cursor (if any)
-    sx::Location current_symbol_location;
-    if (auto& location = cursor.scanner_location; location.has_value()) {
-        current_symbol_location = location->symbol.location;
+static constexpr CandidateScoringLUT buildCandidateScoringLUT(size_t shift) {
+    CandidateScoringLUT lut{};
+    for (size_t byte = 0; byte < lut.size(); ++byte) {
+        lut[byte] = computeCandidateTagScore(static_cast<uint32_t>(byte) << shift);
     }
+    return lut;
+}
 
+/// The tag scores are additive, the two bytes of a tag bitset are scored independently
+static constexpr CandidateScoringLUT CANDIDATE_SCORE_LOW_LUT = buildCandidateScoringLUT(0);
+static constexpr CandidateScoringLUT CANDIDATE_SCORE_HIGH_LUT = buildCandidateScoringLUT(8);
+static_assert(sizeof(Completion::CandidateTags::value) == 2, "Candidate tags are scored with two byte lookups");
+
+static Completion::ScoreValueType computeCandidateScore(Completion::CandidateTags tags) {
+    return CANDIDATE_SCORE_LOW_LUT[tags.value & 0xFF] + CANDIDATE_SCORE_HIGH_LUT[tags.value >> 8];
+}
+
+void Completion::FlushCandidatesAndFinish() {
     // Resolve the scoring table
-    auto& base_scoring_table = selectNameScoringTable(strategy);
+    auto& name_scoring_lut = selectNameScoringLUT(strategy);
 
     /// Helper to sort catalog objects
     struct CandidateObjectRef {
@@ -760,39 +925,92 @@ void Completion::FlushCandidatesAndFinish() {
     // Use a heap to collect the top catalog objects for a candidate
     TopKHeap<CandidateObjectRef> catalog_object_heap{5};
 
-    // Insert all pending candidates into the heap
+    // Collect the candidates as struct of arrays.
+    // Candidates usually reference a single catalog object, we only need the heap for the others.
+    size_t candidate_count = candidates.GetSize();
+    std::vector<Candidate*> candidate_refs;
+    std::vector<uint8_t> name_tags;
+    std::vector<ScoreValueType> object_scores;
+    std::vector<uint32_t> edit_distances;
+    candidate_refs.reserve(candidate_count);
+    name_tags.reserve(candidate_count);
+    object_scores.reserve(candidate_count);
+    edit_distances.reserve(candidate_count);
     candidates.ForEach([&](size_t i, Candidate& candidate) {
-        // Derive the base score as maximum among the name tags
-        Completion::ScoreValueType name_score = 0;
-        for (auto [tag, tag_score] : base_scoring_table) {
-            name_score = std::max(name_score, candidate.coarse_name_tags.contains(tag) ? tag_score : 0);
-        }
-        // Then find the top n best candidate objects.
-        // Splitting off the base score ensures that we're not depending on resolving catalog objects too much.
-        catalog_object_heap.Clear();
-        for (auto& o : candidate.catalog_objects) {
+        ScoreValueType object_score = 0;
+        if (candidate.catalog_objects.GetSize() == 1) {
+            auto& o = *candidate.catalog_objects.begin();
             o.score = computeCandidateScore(o.candidate_tags);
-            catalog_object_heap.Insert(CandidateObjectRef(o));
+            object_score = o.score;
+        } else if (candidate.catalog_objects.GetSize() > 1) {
+            // Find the top n best candidate objects.
+            // Splitting off the base score ensures that we're not depending on resolving catalog objects too much.
+            catalog_object_heap.Clear();
+            for (auto& o : candidate.catalog_objects) {
+                o.score = computeCandidateScore(o.candidate_tags);
+                catalog_object_heap.Insert(CandidateObjectRef(o));
+            }
+            auto& candidate_objects = catalog_object_heap.Finish();
+            // Store as new list
+            candidate.catalog_objects.Clear();
+            for (auto& co : candidate_objects) {
+                candidate.catalog_objects.PushBackUnsafe(co.candidate_object.get());
+            }
+            object_score = candidate_objects.back().score;
         }
-        auto& candidate_objects = catalog_object_heap.Finish();
+        candidate_refs.push_back(&candidate);
+        name_tags.push_back(candidate.coarse_name_tags.value);
+        object_scores.push_back(object_score);
+        edit_distances.push_back(candidate.edit_distance);
+    });
 
-        // Store as new list
-        candidate.catalog_objects.Clear();
-        for (auto& co : candidate_objects) {
-            candidate.catalog_objects.PushBackUnsafe(co.candidate_object.get());
-        }
+    // Score all candidates in a single pass.
+    // The base score is the maximum among the name tags, every typo is penalized.
+    std::vector<ScoreValueType> scores;
+    scores.resize(candidate_count);
+    for (size_t i = 0; i < candidate_count; ++i) {
+        ScoreValueType score = name_scoring_lut[name_tags[i]] + object_scores[i];
+        scores[i] = score - std::min(score, edit_distances[i] * FUZZY_EDIT_PENALTY);
+    }
 
-        // Determine overall candidate score
-        Completion::ScoreValueType object_score = !candidate_objects.empty() ? candidate_objects.back().score : 0;
-        Completion::ScoreValueType candidate_score = name_score + object_score;
-        candidate.score = candidate_score;
+    // Find the score threshold of the top k candidates with a histogram over the small score domain
+    size_t k = result_heap.GetCapacity();
+    std::array<uint32_t, 256> histogram{};
+    for (auto score : scores) {
+        ++histogram[std::min<ScoreValueType>(score, histogram.size() - 1)];
+    }
+    ScoreValueType threshold = 0;
+    for (size_t above = 0, bucket = histogram.size(); bucket > 0; --bucket) {
+        above += histogram[bucket - 1];
+        if (above >= k) {
+            threshold = bucket - 1;
+            break;
+        }
+    }
 
-        // Apply all score modifiers
-        // Add the scored candidate
-        result_heap.Insert(std::move(candidate));
-    });
+    // Drop all candidates below the threshold
+    std::vector<uint32_t> selected;
+    selected.resize(candidate_count);
+    size_t selected_count = 0;
+    for (size_t i = 0; i < candidate_count; ++i) {
+        selected[selected_count] = i;
+        selected_count += scores[i] >= threshold;
+    }
+    selected.resize(selected_count);
+    for (auto i : selected) {
+        candidate_refs[i]->score = scores[i];
+    }
+    // Candidates that tie at the threshold are ordered by name
+    auto is_better = [&](uint32_t l, uint32_t r) { return *candidate_refs[r] < *candidate_refs[l]; };
+    if (selected.size() > k) {
+        std::nth_element(selected.begin(), selected.begin() + k, selected.end(), is_better);
+        selected.resize(k);
+    }
 
-    // Finish the heap
+    // Merge the selected candidates with the expected keywords
+    for (auto i : selected) {
+        result_heap.Insert(std::move(*candidate_refs[i]));
+    }
     result_heap.Finish();
 }
 
@@ -809,11 +1027,30 @@ static buffers::CompletionStrategy selectStrategy(const ScriptCursor& cursor) {
     }
 }
 
-Completion::Completion(const ScriptCursor& cursor, size_t k)
-    : cursor(cursor), strategy(selectStrategy(cursor)), result_heap(k) {}
+Completion::Completion(const ScriptCursor& cursor, size_t k, CompletionCache* cache, std::optional<Deadline> deadline)
+    : cursor(cursor),
+      catalog_snapshot(cursor.script.catalog.Pin()),
+      strategy(selectStrategy(cursor)),
+      cache(cache),
+      deadline(deadline),
+      result_heap(k) {}
+
+bool Completion::DeadlineExceeded(bool force) {
+    if (!deadline.has_value() || partial) {
+        return partial;
+    }
+    if (!force && ++visits_since_deadline_check < DEADLINE_CHECK_INTERVAL) {
+        return false;
+    }
+    visits_since_deadline_check = 0;
+    partial = std::chrono::steady_clock::now() >= *deadline;
+    return partial;
+}
 
-std::pair<std::unique_ptr<Completion>, buffers::StatusCode> Completion::Compute(const ScriptCursor& cursor, size_t k) {
-    auto completion = std::make_unique<Completion>(cursor, k);
+std::pair<std::unique_ptr<Completion>, buffers::StatusCode> Completion::Compute(const ScriptCursor& cursor, size_t k,
+                                                                                CompletionCache* cache,
+                                                                                std::optional<Deadline> deadline) {
+    auto completion = std::make_unique<Completion>(cursor, k, cache, deadline);
 
     // Skip completion for the current symbol?
     if (doNotCompleteSymbol(cursor.scanner_location->symbol)) {
@@ -909,7 +1146,7 @@ std::pair<std::unique_ptr<Completion>, buffers::StatusCode> Completion::Compute(
     // Also check the name indexes when expecting an identifier
     if (expects_identifier) {
         // Just find all candidates in the name index
-        completion->FindCandidatesInIndexes();
+        completion->FindCandidatesInIndexes(expected_symbols);
         // Promote names of all tables that could resolve an unresolved column
         completion->PromoteTablesAndPeersForUnresolvedColumns();
     }
@@ -996,6 +1233,7 @@ flatbuffers::Offset<buffers::Completion> Completion::Pack(flatbuffers::FlatBuffe
     completionBuilder.add_text_offset(cursor.text_offset);
     completionBuilder.add_strategy(strategy);
     completionBuilder.add_candidates(candidatesOfs);
+    completionBuilder.add_partial(partial);
     return completionBuilder.Finish();
 }
 
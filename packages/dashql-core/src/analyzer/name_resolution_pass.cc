@@ -1,5 +1,6 @@
 #include "dashql/analyzer/name_resolution_pass.h"
 
+#include <algorithm>
 #include <format>
 #include <functional>
 #include <iterator>
@@ -41,13 +42,15 @@ void NameResolutionPass::NodeState::Clear() {
 }
 
 /// Constructor
-NameResolutionPass::NameResolutionPass(AnalyzedScript& analyzed, Catalog& catalog, AttributeIndex& attribute_index)
+NameResolutionPass::NameResolutionPass(AnalyzedScript& analyzed, Catalog& catalog, AttributeIndex& attribute_index,
+                                       const AnalyzedScript* previous)
     : scanned(*analyzed.parsed_script->scanned_script),
       parsed(*analyzed.parsed_script),
       analyzed(analyzed),
       catalog_entry_id(parsed.external_id),
       catalog(catalog),
       attribute_index(attribute_index),
+      previous(previous),
       ast(parsed.nodes),
       default_database_name(parsed.scanned_script->name_registry.Register(catalog.GetDefaultDatabaseName())),
       default_schema_name(parsed.scanned_script->name_registry.Register(catalog.GetDefaultSchemaName())) {
@@ -362,6 +365,53 @@ void NameResolutionPass::ResolveColumnRefsInScope(AnalyzedScript::NameScope& sco
     }
 }
 
+void NameResolutionPass::AssignStableTableIds() {
+    uint32_t table_count = analyzed.table_declarations.GetSize();
+    if (!previous || previous->table_declarations.GetSize() == 0 || table_count == 0) {
+        return;
+    }
+    // Tables keep the id of the previous declaration with the same qualified name.
+    // We keep the ids dense, previous ids that are out of range are handed out again together with the free ones.
+    std::vector<AnalyzedScript::TableDeclaration*> tables_by_id;
+    tables_by_id.resize(table_count, nullptr);
+    std::vector<AnalyzedScript::TableDeclaration*> pending;
+    bool reordered = false;
+    analyzed.table_declarations.ForEach([&](size_t ti, AnalyzedScript::TableDeclaration& table) {
+        auto prev_iter = previous->tables_by_name.find(table.table_name);
+        if (prev_iter != previous->tables_by_name.end()) {
+            auto prev_id = prev_iter->second.get().catalog_table_id.GetObject();
+            if (prev_id < table_count && tables_by_id[prev_id] == nullptr) {
+                tables_by_id[prev_id] = &table;
+                reordered |= prev_id != ti;
+                return;
+            }
+        }
+        pending.push_back(&table);
+    });
+    // Tables without a previous id take the remaining ids in declaration order
+    auto pending_iter = pending.begin();
+    for (uint32_t table_id = 0; table_id < table_count && pending_iter != pending.end(); ++table_id) {
+        if (tables_by_id[table_id] == nullptr) {
+            tables_by_id[table_id] = *(pending_iter++);
+        }
+    }
+    // Update the table ids
+    analyzed.table_positions_by_id.clear();
+    if (reordered) {
+        ankerl::unordered_dense::map<const AnalyzedScript::TableDeclaration*, uint32_t> positions;
+        positions.reserve(table_count);
+        analyzed.table_declarations.ForEach(
+            [&](size_t ti, AnalyzedScript::TableDeclaration& table) { positions.insert({&table, ti}); });
+        analyzed.table_positions_by_id.resize(table_count);
+        for (uint32_t table_id = 0; table_id < table_count; ++table_id) {
+            analyzed.table_positions_by_id[table_id] = positions.at(tables_by_id[table_id]);
+        }
+    }
+    for (uint32_t table_id = 0; table_id < table_count; ++table_id) {
+        tables_by_id[table_id]->catalog_table_id = ContextObjectID{catalog_entry_id, table_id};
+    }
+}
+
 void NameResolutionPass::ResolveNames() {
     // Create column ref maps
     ColumnRefsByAlias tmp_refs_by_alias;
@@ -581,6 +631,8 @@ void NameResolutionPass::Visit(std::span<buffers::Node> morsel) {
 
 /// Finish the analysis pass
 void NameResolutionPass::Finish() {
+    // Assign the table ids before resolving any references to them
+    AssignStableTableIds();
     for (auto& table_chunk : analyzed.table_declarations.GetChunks()) {
         for (auto& table : table_chunk) {
             analyzed.tables_by_name.insert({table.table_name, table});
@@ -622,6 +674,19 @@ void NameResolutionPass::Finish() {
         assign_statment_ids(analyzed.table_references.GetChunks());
         assign_statment_ids(analyzed.expressions.GetChunks());
         assign_statment_ids(analyzed.name_scopes.GetChunks());
+
+        // Assign statement ids to the table declarations
+        analyzed.table_declarations.ForEach([&](size_t ti, AnalyzedScript::TableDeclaration& table) {
+            auto iter = std::upper_bound(parsed.statements.begin(), parsed.statements.end(), *table.ast_node_id,
+                                         [](uint32_t node_id, auto& stmt) { return node_id < stmt.nodes_begin; });
+            if (iter == parsed.statements.begin()) {
+                return;
+            }
+            --iter;
+            if (*table.ast_node_id < (iter->nodes_begin + iter->node_count)) {
+                table.ast_statement_id = static_cast<uint32_t>(iter - parsed.statements.begin());
+            }
+        });
     }
 
     // Index the table declarations
@@ -631,6 +696,75 @@ void NameResolutionPass::Finish() {
             analyzed.table_columns_by_name.insert({column.column_name.get().text, column});
         }
     });
+
+    // Collect the tables of other catalog entries that statements depend on.
+    // We also record failed lookups since the table may be declared later.
+    analyzed.table_references.ForEach([&](size_t i, AnalyzedScript::TableReference& ref) {
+        if (!ref.ast_statement_id.has_value()) {
+            return;
+        }
+        if (auto* resolved = std::get_if<AnalyzedScript::TableReference::ResolvedRelationExpression>(&ref.inner)) {
+            if (resolved->catalog_table_id.GetContext() != catalog_entry_id) {
+                analyzed.table_dependencies.emplace_back(*ref.ast_statement_id, resolved->table_name);
+            }
+        } else if (auto* unresolved =
+                       std::get_if<AnalyzedScript::TableReference::UnresolvedRelationExpression>(&ref.inner)) {
+            analyzed.table_dependencies.emplace_back(*ref.ast_statement_id, unresolved->table_name);
+        }
+    });
+
+    // Collect the unresolved column refs per statement
+    std::vector<std::pair<uint32_t, std::reference_wrapper<RegisteredName>>> unresolved_columns;
+    analyzed.expressions.ForEach([&](size_t i, AnalyzedScript::Expression& expr) {
+        if (!expr.ast_statement_id.has_value()) {
+            return;
+        }
+        if (auto* unresolved = std::get_if<AnalyzedScript::Expression::UnresolvedColumnRef>(&expr.inner)) {
+            unresolved_columns.emplace_back(*expr.ast_statement_id, unresolved->column_name.column_name);
+        }
+    });
+    std::sort(unresolved_columns.begin(), unresolved_columns.end(), [](auto& l, auto& r) {
+        return std::make_pair(l.first, l.second.get().name_id) < std::make_pair(r.first, r.second.get().name_id);
+    });
+
+    // Deduplicate the unresolved column names and precompute the tables that would resolve them
+    analyzed.unresolved_column_names_by_statement.resize(parsed.statements.size(), {0, 0});
+    std::vector<CatalogEntry::TableColumn> tmp_columns;
+    for (size_t i = 0; i < unresolved_columns.size();) {
+        auto [statement_id, column_name] = unresolved_columns[i];
+        size_t n = 1;
+        for (; (i + n) < unresolved_columns.size(); ++n) {
+            auto& next = unresolved_columns[i + n];
+            if (next.first != statement_id || next.second.get().name_id != column_name.get().name_id) {
+                break;
+            }
+        }
+        i += n;
+
+        // Resolve all table columns that would match the unresolved name
+        tmp_columns.clear();
+        analyzed.ResolveTableColumnsWithCatalog(catalog, column_name.get().text, tmp_columns);
+        AnalyzedScript::UnresolvedColumnName unresolved{
+            .ast_statement_id = statement_id,
+            .column_name = column_name,
+            .expression_count = static_cast<uint32_t>(n),
+            .candidate_tables = {},
+        };
+        unresolved.candidate_tables.reserve(tmp_columns.size());
+        for (auto& table_col : tmp_columns) {
+            if (table_col.table.has_value()) {
+                unresolved.candidate_tables.push_back(table_col.table->get());
+            }
+        }
+
+        // Register the name with the statement
+        auto& [statement_begin, statement_count] = analyzed.unresolved_column_names_by_statement[statement_id];
+        if (statement_count == 0) {
+            statement_begin = analyzed.unresolved_column_names.size();
+        }
+        ++statement_count;
+        analyzed.unresolved_column_names.push_back(std::move(unresolved));
+    }
 }
 
 }  // namespace dashql
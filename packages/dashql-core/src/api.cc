@@ -4,6 +4,7 @@
 #include <flatbuffers/detached_buffer.h>
 #include <flatbuffers/flatbuffer_builder.h>
 
+#include <chrono>
 #include <span>
 
 #include "dashql/analyzer/completion.h"
@@ -258,8 +259,12 @@ extern "C" FFIResult* dashql_script_move_cursor(dashql::Script* script, size_t t
     return packBuffer(std::move(detached));
 }
 
-extern "C" FFIResult* dashql_script_complete_at_cursor(dashql::Script* script, size_t limit) {
-    auto [completion, status] = script->CompleteAtCursor(limit);
+extern "C" FFIResult* dashql_script_complete_at_cursor(dashql::Script* script, size_t limit, size_t budget_ms) {
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (budget_ms > 0) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{budget_ms};
+    }
+    auto [completion, status] = script->CompleteAtCursor(limit, deadline);
     if (status != buffers::StatusCode::OK) {
         return packError(status);
     }
@@ -330,6 +335,15 @@ extern "C" FFIResult* dashql_catalog_flatten(dashql::Catalog* catalog) {
     auto detached = std::make_unique<flatbuffers::DetachedBuffer>(std::move(fb.Release()));
     return packBuffer(std::move(detached));
 }
+/// Flatten the changes of the catalog since a version
+extern "C" FFIResult* dashql_catalog_flatten_delta(dashql::Catalog* catalog, size_t since_version) {
+    flatbuffers::FlatBufferBuilder fb;
+    auto delta = catalog->FlattenDelta(fb, since_version);
+    fb.Finish(delta);
+
+    auto detached = std::make_unique<flatbuffers::DetachedBuffer>(std::move(fb.Release()));
+    return packBuffer(std::move(detached));
+}
 /// Add a script in the catalog
 extern "C" FFIResult* dashql_catalog_load_script(dashql::Catalog* catalog, dashql::Script* script, size_t rank) {
     auto status = catalog->LoadScript(*script, rank);
@@ -4,7 +4,13 @@
 #include <flatbuffers/flatbuffer_builder.h>
 #include <flatbuffers/verifier.h>
 
-#include <map>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#ifndef WASM
+#include <thread>
+#endif
 #include <variant>
 
 #include "dashql/catalog_object.h"
@@ -55,7 +61,7 @@ flatbuffers::Offset<buffers::Table> CatalogEntry::TableDeclaration::Pack(flatbuf
 }
 
 CatalogEntry::CatalogEntry(Catalog& catalog, CatalogEntryID external_id)
-    : catalog(catalog),
+    : catalog(&catalog),
       catalog_entry_id(external_id),
       database_references(),
       schema_references(),
@@ -66,7 +72,19 @@ CatalogEntry::CatalogEntry(Catalog& catalog, CatalogEntryID external_id)
       table_columns_by_name(),
       name_search_index() {}
 
-CatalogEntry::QualifiedTableName CatalogEntry::QualifyTableName(NameRegistry& name_registry,
+CatalogEntry::CatalogEntry(CatalogEntryID external_id)
+    : catalog(nullptr),
+      catalog_entry_id(external_id),
+      database_references(),
+      schema_references(),
+      table_declarations(),
+      databases_by_name(),
+      schemas_by_name(),
+      tables_by_name(),
+      table_columns_by_name(),
+      name_search_index() {}
+
+CatalogEntry::QualifiedTableName CatalogEntry::QualifyTableName(const Catalog& catalog, NameRegistry& name_registry,
                                                                 CatalogEntry::QualifiedTableName name) const {
     if (name.database_name.get().text.empty()) {
         name.database_name =
@@ -79,8 +97,110 @@ CatalogEntry::QualifiedTableName CatalogEntry::QualifyTableName(NameRegistry& na
     return name;
 }
 
+CatalogEntry::NameSearchIndex::SharedTrie::SharedTrie(const NameRegistry& name_registry) {
+    // Copy the name texts into a buffer that we own
+    size_t text_bytes = 0;
+    for (auto& names_chunk : name_registry.GetChunks()) {
+        for (auto& name : names_chunk) {
+            text_bytes += name.text.size();
+        }
+    }
+    text_buffer = std::unique_ptr<char[]>(new char[std::max<size_t>(text_bytes, 1)]);
+    texts.reserve(name_registry.GetSize());
+    char* writer = text_buffer.get();
+    for (auto& names_chunk : name_registry.GetChunks()) {
+        for (auto& name : names_chunk) {
+            if (!name.text.empty()) {
+                std::memcpy(writer, name.text.data(), name.text.size());
+                auto& text = texts.emplace_back(writer, name.text.size());
+                text_set.insert(text);
+                writer += name.text.size();
+            }
+        }
+    }
+    trie = SuffixTrie::BulkLoad(texts, [](size_t i, std::string_view text) { return SuffixTrie::Entry{text, i}; });
+}
+
+CatalogEntry::NameSearchIndex::SharedSuffixArray::SharedSuffixArray(const NameRegistry& name_registry) {
+    std::vector<std::string_view> texts;
+    texts.reserve(name_registry.GetSize());
+    for (auto& names_chunk : name_registry.GetChunks()) {
+        for (auto& name : names_chunk) {
+            if (!name.text.empty()) {
+                texts.push_back(name.text);
+            }
+        }
+    }
+    buffer = SuffixArray::Build(texts);
+    auto opened = SuffixArray::Open(buffer);
+    assert(opened.has_value());
+    suffix_array = *opened;
+}
+
+CatalogEntry::NameSearchIndex::NameSearchIndex(const NameRegistry& registry, const NameSearchIndex* previous,
+                                               Layout layout)
+    : name_registry(&registry), name_registry_size(registry.GetSize()) {
+    names.reserve(registry.GetSize());
+    for (auto& names_chunk : registry.GetChunks()) {
+        for (auto& name : names_chunk) {
+            if (!name.text.empty()) {
+                names.push_back(name);
+            }
+        }
+    }
+    // Find the names that are missing in the shared suffixes of the previous index
+    if (previous && (previous->shared_trie || previous->shared_suffix_array)) {
+        for (auto& name : names) {
+            auto text = name.get().text;
+            bool shared = previous->shared_trie
+                              ? previous->shared_trie->text_set.contains(text)
+                              : previous->shared_suffix_array->suffix_array.FindText(text).has_value();
+            if (!shared) {
+                delta_names.push_back(name);
+                delta_suffix_count += text.size();
+            }
+        }
+        // Reuse the shared suffixes as long as the deltas stay small.
+        // Scanning the deltas is linear in their size, the suffixes are rebuilt once they make up a noticeable share.
+        if (delta_names.size() <= std::max<size_t>(MAX_NAME_SEARCH_INDEX_DELTA, names.size() / 8)) {
+            shared_trie = previous->shared_trie;
+            shared_suffix_array = previous->shared_suffix_array;
+            return;
+        }
+        delta_names.clear();
+        delta_suffix_count = 0;
+    }
+    switch (layout) {
+        case Layout::SuffixTrie:
+            shared_trie = std::make_shared<SharedTrie>(registry);
+            break;
+        case Layout::SuffixArray:
+            shared_suffix_array = std::make_shared<SharedSuffixArray>(registry);
+            break;
+    }
+}
+
+CatalogEntry::NameSearchIndex::NameSearchIndex(const NameRegistry& registry,
+                                               std::shared_ptr<const SharedSuffixArray> suffix_array)
+    : name_registry(&registry), name_registry_size(registry.GetSize()), shared_suffix_array(std::move(suffix_array)) {
+    names.reserve(registry.GetSize());
+    for (auto& names_chunk : registry.GetChunks()) {
+        for (auto& name : names_chunk) {
+            if (name.text.empty()) {
+                continue;
+            }
+            names.push_back(name);
+            // Names that are missing in the suffix array are scanned as deltas
+            if (!shared_suffix_array->suffix_array.FindText(name.text).has_value()) {
+                delta_names.push_back(name);
+                delta_suffix_count += name.text.size();
+            }
+        }
+    }
+}
+
 void CatalogEntry::ResolveDatabaseSchemasWithCatalog(
-    std::string_view database_name,
+    const Catalog& catalog, std::string_view database_name,
     std::vector<std::pair<std::reference_wrapper<const SchemaReference>, bool>>& out) const {
     char ub_text = 0x7F;
 
@@ -106,7 +226,7 @@ void CatalogEntry::ResolveDatabaseSchemasWithCatalog(
 }
 
 void CatalogEntry::ResolveSchemaTablesWithCatalog(
-    std::string_view database_name, std::string_view schema_name,
+    const Catalog& catalog, std::string_view database_name, std::string_view schema_name,
     std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>>& out) const {
     char ub_text = 0x7F;
 
@@ -123,18 +243,16 @@ void CatalogEntry::ResolveSchemaTablesWithCatalog(
 
     // Then discover all catalog entries that populate that schema
     {
-        auto lb = catalog.entries_by_schema.lower_bound({database_name, schema_name, 0, 0});
-        auto ub = catalog.entries_by_schema.upper_bound({database_name, schema_name,
-                                                         std::numeric_limits<CatalogEntry::Rank>::max(),
-                                                         std::numeric_limits<CatalogEntryID>::max()});
+        auto [lb, ub] = catalog.FindSchemaEntries(database_name, schema_name);
         for (auto iter = lb; iter != ub; ++iter) {
             // Skip own entry, we checked earlier
             if (iter->second.catalog_entry_id == catalog_entry_id) {
                 continue;
             }
             // Do the same lookup in the other entries
-            auto table_lb = tables_by_name.lower_bound({database_name, schema_name, "\0"});
-            auto table_ub = tables_by_name.upper_bound({database_name, schema_name, std::string_view{&ub_text, 1}});
+            auto& other_tables = catalog.entries.at(iter->second.catalog_entry_id)->tables_by_name;
+            auto table_lb = other_tables.lower_bound({database_name, schema_name, "\0"});
+            auto table_ub = other_tables.upper_bound({database_name, schema_name, std::string_view{&ub_text, 1}});
             for (auto table_iter = table_lb; table_iter != table_ub; ++table_iter) {
                 out.push_back({table_iter->second, true});
             }
@@ -143,15 +261,16 @@ void CatalogEntry::ResolveSchemaTablesWithCatalog(
 }
 
 const CatalogEntry::TableDeclaration* CatalogEntry::ResolveTable(ContextObjectID table_id) const {
-    if (table_id.GetContext() == catalog_entry_id) {
-        return &table_declarations[table_id.GetObject()];
+    if (table_id.GetContext() == catalog_entry_id && table_id.GetObject() < table_declarations.GetSize()) {
+        return &GetTableById(table_id.GetObject());
     }
     return nullptr;
 }
 
-const CatalogEntry::TableDeclaration* CatalogEntry::ResolveTableWithCatalog(ContextObjectID table_id) const {
+const CatalogEntry::TableDeclaration* CatalogEntry::ResolveTableWithCatalog(const Catalog& catalog,
+                                                                           ContextObjectID table_id) const {
     if (catalog_entry_id == table_id.GetContext()) {
-        return &table_declarations[table_id.GetObject()];
+        return ResolveTable(table_id);
     } else {
         return catalog.ResolveTable(table_id);
     }
@@ -165,7 +284,8 @@ const CatalogEntry::TableDeclaration* CatalogEntry::ResolveTable(QualifiedTableN
     return &iter->second.get();
 }
 
-const CatalogEntry::TableDeclaration* CatalogEntry::ResolveTableWithCatalog(QualifiedTableName name) const {
+const CatalogEntry::TableDeclaration* CatalogEntry::ResolveTableWithCatalog(const Catalog& catalog,
+                                                                           QualifiedTableName name) const {
     if (auto resolved = ResolveTable(name)) {
         return resolved;
     } else {
@@ -180,9 +300,111 @@ void CatalogEntry::ResolveTableColumns(std::string_view table_column, std::vecto
     }
 }
 
+void CatalogEntry::UpdateNameFilter() {
+    size_t table_count = table_declarations.GetSize();
+    if (name_filter_table_count == table_count) {
+        return;
+    }
+    // Count the names of the new tables
+    size_t key_count = name_filter.GetKeyCount();
+    table_declarations.ForEachIn(name_filter_table_count, table_count - name_filter_table_count,
+                                 [&](size_t, const TableDeclaration& table) {
+                                     key_count += 1 + table.table_columns.size();
+                                 });
+    // Rebuild the filter with all tables if the new names don't fit
+    size_t begin = name_filter_table_count;
+    if (key_count > name_filter.GetKeyCapacity()) {
+        name_filter.Reset(key_count * 2);
+        begin = 0;
+    }
+    table_declarations.ForEachIn(begin, table_count - begin, [&](size_t, const TableDeclaration& table) {
+        name_filter.Insert(BloomFilter::HashFolded(table.table_name.table_name.get().text, NAME_FILTER_TABLE_SEED));
+        for (auto& column : table.table_columns) {
+            name_filter.Insert(BloomFilter::HashFolded(column.column_name.get().text, NAME_FILTER_COLUMN_SEED));
+        }
+    });
+    name_filter_table_count = table_count;
+}
+
+std::optional<CatalogDatabaseID> SharedCatalogIds::FindDatabaseId(std::string_view database) const {
+    std::lock_guard<std::mutex> guard{latch};
+    auto iter = database_ids.find(std::string{database});
+    if (iter == database_ids.end()) {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+std::optional<CatalogSchemaID> SharedCatalogIds::FindSchemaId(std::string_view database,
+                                                              std::string_view schema) const {
+    std::lock_guard<std::mutex> guard{latch};
+    auto iter = schema_ids.find({std::string{database}, std::string{schema}});
+    if (iter == schema_ids.end()) {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+CatalogDatabaseID SharedCatalogIds::AllocateDatabaseId(std::string_view database) {
+    std::lock_guard<std::mutex> guard{latch};
+    auto next_id = SHARED_DATABASE_ID_BASE + static_cast<CatalogDatabaseID>(database_ids.size());
+    return database_ids.insert({std::string{database}, next_id}).first->second;
+}
+
+CatalogSchemaID SharedCatalogIds::AllocateSchemaId(std::string_view database, std::string_view schema) {
+    std::lock_guard<std::mutex> guard{latch};
+    auto next_id = SHARED_SCHEMA_ID_BASE + static_cast<CatalogSchemaID>(schema_ids.size());
+    return schema_ids.insert({{std::string{database}, std::string{schema}}, next_id}).first->second;
+}
+
 DescriptorPool::DescriptorPool(Catalog& catalog, CatalogEntryID external_id, uint32_t rank)
-    : CatalogEntry(catalog, external_id), rank(rank) {
-    name_search_index.emplace(CatalogEntry::NameSearchIndex{});
+    : CatalogEntry(catalog, external_id), rank(rank) {}
+
+DescriptorPool::DescriptorPool(std::shared_ptr<SharedCatalogIds> shared_ids, CatalogEntryID external_id, uint32_t rank)
+    : CatalogEntry(external_id), rank(rank), shared_ids(std::move(shared_ids)) {
+    assert(this->shared_ids != nullptr);
+}
+
+std::shared_ptr<DescriptorPool> DescriptorPool::CreateShared(std::shared_ptr<SharedCatalogIds> shared_ids,
+                                                             CatalogEntryID external_id, Rank rank) {
+    // Shared pools allocate their ids in the shared ids and don't belong to any catalog.
+    // Lookups through the pool use the catalog that the pool is attached to.
+    return std::make_shared<DescriptorPool>(std::move(shared_ids), external_id, rank);
+}
+
+void DescriptorPool::Freeze() {
+    if (IsFrozen()) {
+        return;
+    }
+    // The frozen name index answers substring lookups with the name search index of the pool
+    frozen_name_index.AddEntryNames(*this, rank, name_registry);
+    frozen.store(true, std::memory_order_release);
+}
+
+std::shared_ptr<DescriptorPool> DescriptorPool::Clone() {
+    auto next = shared_ids ? std::make_shared<DescriptorPool>(shared_ids, catalog_entry_id, rank)
+                           : std::make_shared<DescriptorPool>(*catalog, catalog_entry_id, rank);
+    // Keep the catalog ids of all schemas
+    schema_references.ForEach([&](size_t, const CatalogEntry::SchemaReference& schema) {
+        next->DeclareSchema(schema.database_name, schema.catalog_database_id, schema.schema_name,
+                            schema.catalog_schema_id);
+    });
+    // Add the descriptors again in the same order, the tables keep their ids
+    for (auto& descriptor : descriptor_buffers) {
+        CatalogDatabaseID db_id;
+        CatalogSchemaID schema_id;
+        [[maybe_unused]] auto status =
+            next->AddSchemaDescriptor(descriptor.descriptor, descriptor.descriptor_data, descriptor.descriptor_buffer,
+                                      descriptor.descriptor_buffer_size, db_id, schema_id);
+        assert(status == buffers::StatusCode::OK);
+    }
+    // Reuse the shared suffixes of the name search index
+    std::lock_guard<std::mutex> guard{name_search_index_latch};
+    if (name_search_index.has_value()) {
+        next->name_search_index.emplace(next->name_registry, &*name_search_index, name_search_index->GetLayout());
+        next->name_search_index_size.store(next->name_registry.GetSize(), std::memory_order_release);
+    }
+    return next;
 }
 
 static flatbuffers::Offset<buffers::SchemaDescriptor> describeEntrySchema(flatbuffers::FlatBufferBuilder& builder,
@@ -253,12 +475,127 @@ flatbuffers::Offset<buffers::CatalogEntry> DescriptorPool::DescribeEntry(flatbuf
     return catalog.Finish();
 }
 
-const CatalogEntry::NameSearchIndex& DescriptorPool::GetNameSearchIndex() { return name_search_index.value(); }
+const CatalogEntry::NameSearchIndex& DescriptorPool::GetNameSearchIndex() {
+    auto registry_size = name_registry.GetSize();
+    if (name_search_index_size.load(std::memory_order_acquire) == registry_size) {
+        return name_search_index.value();
+    }
+    // The index is updated lazily after adding descriptors, reusing the trie of the previous version.
+    // Concurrent readers build it once.
+    std::lock_guard<std::mutex> guard{name_search_index_latch};
+    if (!name_search_index.has_value() || name_search_index->GetNameRegistrySize() != registry_size) {
+        // Very large pools are indexed with a suffix array, a suffix trie over millions of names costs gigabytes
+        auto layout = name_registry.GetSize() >= SUCCINCT_NAME_SEARCH_INDEX_THRESHOLD
+                          ? CatalogEntry::NameSearchIndex::Layout::SuffixArray
+                          : CatalogEntry::NameSearchIndex::Layout::SuffixTrie;
+        CatalogEntry::NameSearchIndex next{name_registry, name_search_index ? &*name_search_index : nullptr, layout};
+        name_search_index.emplace(std::move(next));
+    }
+    name_search_index_size.store(registry_size, std::memory_order_release);
+    return name_search_index.value();
+}
+
+std::shared_ptr<const void> DescriptorPool::GetNameOwner(std::string_view text) const {
+    auto* begin = reinterpret_cast<const std::byte*>(text.data());
+    for (auto& descriptor : descriptor_buffers) {
+        if (auto* mapping = std::get_if<std::shared_ptr<const MappedFile>>(&descriptor.descriptor_buffer)) {
+            auto data = (*mapping)->GetData();
+            if (begin >= data.data() && begin + text.size() <= data.data() + data.size()) {
+                return *mapping;
+            }
+        }
+    }
+    return nullptr;
+}
+
+namespace {
+
+/// The minimum number of tables per worker when loading descriptors in parallel
+constexpr size_t MIN_DESCRIPTOR_TABLES_PER_WORKER = 1024;
+
+/// Run a function for every worker, the first worker runs on the calling thread
+template <typename Fn> void runWorkers(size_t worker_count, Fn fn) {
+#ifdef WASM
+    for (size_t worker_id = 0; worker_id < worker_count; ++worker_id) {
+        fn(worker_id);
+    }
+#else
+    std::vector<std::thread> threads;
+    threads.reserve(worker_count - 1);
+    for (size_t worker_id = 1; worker_id < worker_count; ++worker_id) {
+        threads.emplace_back(fn, worker_id);
+    }
+    fn(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+#endif
+}
+
+/// A table of a schema descriptor that is being loaded
+struct DescriptorTable {
+    /// The schema index
+    uint32_t schema_index;
+    /// The table descriptor
+    const buffers::SchemaTable* table;
+    /// The local name of the table
+    uint32_t table_name;
+    /// The local column names with their ordinal positions, ordered by the ordinal position
+    std::vector<std::pair<uint32_t, uint32_t>> columns;
+    /// The end of the local names that were first seen with this table
+    uint32_t local_names_end;
+    /// The table declaration
+    CatalogEntry::TableDeclaration* declaration = nullptr;
+};
+
+/// The names that a worker saw in its tables
+struct DescriptorWorkerNames {
+    /// A name
+    struct LocalName {
+        /// The text
+        std::string_view text;
+        /// The tags of all occurrences
+        NameTags tags;
+        /// The number of occurrences
+        uint32_t occurrences;
+        /// The registered name
+        RegisteredName* registered;
+    };
+    /// The distinct names in the order they were first seen
+    std::vector<LocalName> names;
+    /// The name ids by text
+    ankerl::unordered_dense::map<std::string_view, uint32_t> names_by_text;
+    /// The first error and the table that caused it
+    std::optional<std::pair<size_t, buffers::StatusCode>> error;
+    /// The sorted run of the qualified table names in the descriptors with the table index
+    std::vector<std::pair<CatalogEntry::QualifiedTableName::Key, size_t>> descriptor_tables_by_name;
+    /// The sorted run of new table names with the table index
+    std::vector<std::pair<CatalogEntry::QualifiedTableName::Key, size_t>> tables_by_name;
+
+    /// Register a name locally
+    uint32_t Register(std::string_view text, NameTags tags) {
+        auto [iter, inserted] = names_by_text.try_emplace(text, static_cast<uint32_t>(names.size()));
+        if (inserted) {
+            names.push_back(LocalName{.text = text, .tags = tags, .occurrences = 1, .registered = nullptr});
+        } else {
+            auto& name = names[iter->second];
+            name.tags |= tags;
+            ++name.occurrences;
+        }
+        return iter->second;
+    }
+};
+
+}  // namespace
 
 buffers::StatusCode DescriptorPool::AddSchemaDescriptor(DescriptorRefVariant descriptor_variant,
-                                                      std::unique_ptr<const std::byte[]> descriptor_buffer,
+                                                      std::span<const std::byte> descriptor_data,
+                                                      DescriptorBuffer descriptor_buffer,
                                                       size_t descriptor_buffer_size, CatalogDatabaseID& db_id,
-                                                      CatalogSchemaID& schema_id) {
+                                                      CatalogSchemaID& schema_id, size_t worker_count) {
+    if (IsFrozen()) {
+        return buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_FROZEN;
+    }
     // Unpack the schemas
     std::vector<std::reference_wrapper<const buffers::SchemaDescriptor>> descriptors;
     switch (descriptor_variant.index()) {
@@ -283,42 +620,126 @@ buffers::StatusCode DescriptorPool::AddSchemaDescriptor(DescriptorRefVariant des
             break;
         }
     }
+
+    // Collect the tables of all schemas
+    std::vector<DescriptorTable> tables;
+    std::vector<std::pair<std::string_view, std::string_view>> schema_names;
+    schema_names.reserve(descriptors.size());
+    for (uint32_t schema_index = 0; schema_index < descriptors.size(); ++schema_index) {
+        auto& descriptor = descriptors[schema_index].get();
+        auto db_name_text = descriptor.database_name() == nullptr ? "" : descriptor.database_name()->string_view();
+        auto schema_name_text = descriptor.schema_name() == nullptr ? "" : descriptor.schema_name()->string_view();
+        schema_names.emplace_back(db_name_text, schema_name_text);
+        for (auto* table : *descriptor.tables()) {
+            tables.push_back(DescriptorTable{.schema_index = schema_index, .table = table});
+        }
+    }
+
+    // Partition the tables into contiguous ranges.
+    // Names are registered in the order of the tables, the result does not depend on the number of workers.
+#ifdef WASM
+    worker_count = 1;
+#endif
+    worker_count = std::max<size_t>(std::min(worker_count, tables.size() / MIN_DESCRIPTOR_TABLES_PER_WORKER), 1);
+    size_t tables_per_worker = std::max<size_t>((tables.size() + worker_count - 1) / worker_count, 1);
+    auto worker_tables = [&](size_t worker_id) {
+        size_t begin = std::min(worker_id * tables_per_worker, tables.size());
+        size_t end = std::min(begin + tables_per_worker, tables.size());
+        return std::make_pair(begin, end);
+    };
+    std::vector<DescriptorWorkerNames> workers(worker_count);
+
+    // Read the tables and collect their names.
+    // The workers only read the table index of the pool, collisions are therefore checked against the tables of
+    // previous descriptors, just like they are when loading descriptors one by one.
+    runWorkers(worker_count, [&](size_t worker_id) {
+        auto& worker = workers[worker_id];
+        auto [begin, end] = worker_tables(worker_id);
+        for (size_t i = begin; i < end; ++i) {
+            auto& table = tables[i];
+            auto [db_name_text, schema_name_text] = schema_names[table.schema_index];
+            auto table_name_ptr = table.table->table_name();
+            if (!table_name_ptr || table_name_ptr->size() == 0) {
+                worker.error = {i, buffers::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_EMPTY};
+                break;
+            }
+            QualifiedTableName::Key qualified_table_name{db_name_text, schema_name_text, table_name_ptr->string_view()};
+            if (tables_by_name.contains(qualified_table_name)) {
+                worker.error = {i, buffers::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_COLLISION};
+                break;
+            }
+            worker.descriptor_tables_by_name.emplace_back(qualified_table_name, i);
+            table.table_name =
+                worker.Register(table_name_ptr->string_view(), NameTags{buffers::NameTag::TABLE_NAME});
+            if (auto columns_ptr = table.table->columns()) {
+                table.columns.reserve(columns_ptr->size());
+                for (auto* column : *columns_ptr) {
+                    if (auto column_name_text = column->column_name()) {
+                        auto column_name = worker.Register(column_name_text->string_view(),
+                                                           NameTags{buffers::NameTag::COLUMN_NAME});
+                        table.columns.emplace_back(column_name, column->ordinal_position());
+                    }
+                }
+            }
+            std::stable_sort(table.columns.begin(), table.columns.end(),
+                             [](auto& l, auto& r) { return l.second < r.second; });
+            table.local_names_end = worker.names.size();
+        }
+        std::sort(worker.descriptor_tables_by_name.begin(), worker.descriptor_tables_by_name.end());
+    });
+    // Find the first table that failed.
+    // The worker ranges are ordered, the first worker with an error therefore failed first.
+    std::optional<std::pair<size_t, buffers::StatusCode>> error;
+    for (auto& worker : workers) {
+        if (worker.error.has_value()) {
+            error = worker.error;
+            break;
+        }
+    }
+    // A table name may also collide with a table of the same descriptors, possibly one of another worker.
+    // We merge the sorted runs and report the table that repeats a name first.
+    std::vector<std::pair<QualifiedTableName::Key, size_t>> descriptor_tables_by_name;
+    descriptor_tables_by_name.reserve(tables.size());
+    for (auto& worker : workers) {
+        auto mid = descriptor_tables_by_name.size();
+        descriptor_tables_by_name.insert(descriptor_tables_by_name.end(), worker.descriptor_tables_by_name.begin(),
+                                         worker.descriptor_tables_by_name.end());
+        std::inplace_merge(descriptor_tables_by_name.begin(), descriptor_tables_by_name.begin() + mid,
+                           descriptor_tables_by_name.end());
+    }
+    for (size_t i = 1; i < descriptor_tables_by_name.size(); ++i) {
+        auto& [key, table_index] = descriptor_tables_by_name[i];
+        if (key == descriptor_tables_by_name[i - 1].first && (!error.has_value() || table_index < error->first)) {
+            error = {table_index, buffers::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_COLLISION};
+        }
+    }
+    if (error.has_value()) {
+        return error->second;
+    }
     descriptor_buffers.push_back({
         .descriptor = descriptor_variant,
+        .descriptor_data = descriptor_data,
         .descriptor_buffer = std::move(descriptor_buffer),
         .descriptor_buffer_size = descriptor_buffer_size,
     });
 
-    // Encode descriptors
-    for (auto& d : descriptors) {
-        auto& descriptor = d.get();
+    // Register the names and create the table declarations in descriptor order
+    std::vector<uint32_t> worker_names_registered(worker_count, 0);
+    size_t next_table = 0;
+    uint32_t next_table_id = table_declarations.GetSize();
+    for (uint32_t schema_index = 0; schema_index < descriptors.size(); ++schema_index) {
+        auto [db_name_text, schema_name_text] = schema_names[schema_index];
 
         // Register the database name
-        auto db_name_text = descriptor.database_name() == nullptr ? "" : descriptor.database_name()->string_view();
         auto& db_name = name_registry.Register(db_name_text, NameTags{buffers::NameTag::DATABASE_NAME});
-        {
-            fuzzy_ci_string_view ci_name{db_name.text.data(), db_name.text.size()};
-            for (size_t i = 1; i < ci_name.size(); ++i) {
-                auto suffix = ci_name.substr(ci_name.size() - 1 - i);
-                name_search_index->insert({suffix, db_name});
-            }
-        }
-
         // Register the schema name
-        auto schema_name_text = descriptor.schema_name() == nullptr ? "" : descriptor.schema_name()->string_view();
         auto& schema_name = name_registry.Register(schema_name_text, NameTags{buffers::NameTag::SCHEMA_NAME});
-        {
-            fuzzy_ci_string_view ci_name{schema_name.text.data(), schema_name.text.size()};
-            for (size_t i = 1; i < ci_name.size(); ++i) {
-                auto suffix = ci_name.substr(ci_name.size() - 1 - i);
-                name_search_index->insert({suffix, schema_name});
-            }
-        }
 
         // Allocate the descriptors database id
         auto db_ref_iter = databases_by_name.find(db_name);
         if (db_ref_iter == databases_by_name.end()) {
-            db_id = catalog.AllocateDatabaseId(db_name);
+            db_id = shared_ids ? shared_ids->AllocateDatabaseId(db_name.text)
+                               : catalog->AllocateDatabaseId(db_name.text);
             if (!databases_by_name.contains({db_name})) {
                 auto& db = database_references.Append(CatalogEntry::DatabaseReference{db_id, db_name, ""});
                 databases_by_name.insert({db.database_name, db});
@@ -331,7 +752,8 @@ buffers::StatusCode DescriptorPool::AddSchemaDescriptor(DescriptorRefVariant des
         // Allocate the descriptors schema id
         auto schema_ref_iter = schemas_by_name.find({db_name, schema_name});
         if (schema_ref_iter == schemas_by_name.end()) {
-            schema_id = catalog.AllocateSchemaId(db_name.text, schema_name.text);
+            schema_id = shared_ids ? shared_ids->AllocateSchemaId(db_name.text, schema_name.text)
+                                   : catalog->AllocateSchemaId(db_name.text, schema_name.text);
             if (!schemas_by_name.contains({db_name, schema_name})) {
                 auto& schema =
                     schema_references.Append(CatalogEntry::SchemaReference{db_id, schema_id, db_name, schema_name});
@@ -342,93 +764,117 @@ buffers::StatusCode DescriptorPool::AddSchemaDescriptor(DescriptorRefVariant des
             schema_id = schema_ref_iter->second.get().catalog_schema_id;
         }
 
-        // Read tables
-        uint32_t next_table_id = table_declarations.GetSize();
-        for (auto* table : *descriptor.tables()) {
-            ContextObjectID table_id{catalog_entry_id, next_table_id};
-
-            // Register the table name
-            auto table_name_ptr = table->table_name();
-            if (!table_name_ptr || table_name_ptr->size() == 0) {
-                return buffers::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_EMPTY;
-            }
-            auto& table_name =
-                name_registry.Register(table_name_ptr->string_view(), NameTags{buffers::NameTag::TABLE_NAME});
-            {
-                fuzzy_ci_string_view ci_name{table_name.text.data(), table_name.text.size()};
-                for (size_t i = 1; i < ci_name.size(); ++i) {
-                    auto suffix = ci_name.substr(ci_name.size() - 1 - i);
-                    name_search_index->insert({suffix, table_name});
-                }
-            }
-            // Build the qualified table name
-            QualifiedTableName::Key qualified_table_name{db_name.text, schema_name.text, table_name.text};
-            if (tables_by_name.contains(qualified_table_name)) {
-                return buffers::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_COLLISION;
-            }
-            // Collect the table columns (if any)
-            std::vector<TableColumn> columns;
-            if (auto columns_ptr = table->columns()) {
-                auto column_count = table->columns()->size();
-                columns.reserve(column_count);
-                for (auto* column : *columns_ptr) {
-                    if (auto column_name_text = column->column_name()) {
-                        // Register the column name
-                        auto& column_name = name_registry.Register(column_name_text->string_view(),
-                                                                   NameTags{buffers::NameTag::COLUMN_NAME});
-                        columns.emplace_back(std::nullopt, column_name);
-                        columns.back().column_index = column->ordinal_position();
-
-                        // Ad the column name to the index
-                        fuzzy_ci_string_view ci_name{column_name.text.data(), column_name.text.size()};
-                        for (size_t i = 1; i < ci_name.size(); ++i) {
-                            auto suffix = ci_name.substr(ci_name.size() - 1 - i);
-                            name_search_index->insert({suffix, column_name});
-                        }
-                    }
-                }
+        // Create the tables
+        for (; next_table < tables.size() && tables[next_table].schema_index == schema_index; ++next_table) {
+            auto& table = tables[next_table];
+            auto& worker = workers[next_table / tables_per_worker];
+            auto& registered = worker_names_registered[next_table / tables_per_worker];
+
+            // Register the names that were first seen with this table
+            for (; registered < table.local_names_end; ++registered) {
+                auto& local = worker.names[registered];
+                auto& name = name_registry.Register(local.text, local.tags);
+                name.occurrences += local.occurrences - 1;
+                local.registered = &name;
             }
-
-            // Sort the table columns
-            std::sort(columns.begin(), columns.end(),
-                      [&](TableColumn& l, TableColumn& r) { return l.column_index < r.column_index; });
-            // Create the table
+            auto& table_name = *worker.names[table.table_name].registered;
             auto& t = table_declarations.Append(
                 AnalyzedScript::TableDeclaration(QualifiedTableName{std::nullopt, db_name, schema_name, table_name}));
             t.catalog_database_id = db_id;
             t.catalog_schema_id = schema_id;
-            t.catalog_table_id = table_id;
-            t.table_columns = std::move(columns);
-            ++next_table_id;
+            t.catalog_table_id = ContextObjectID{catalog_entry_id, next_table_id++};
+            table.declaration = &t;
             // Register the table for the table name
             table_name.resolved_objects.PushBack(t.CastToBase());
+        }
+    }
+
+    // Create the table columns and sort the table names of every worker
+    runWorkers(worker_count, [&](size_t worker_id) {
+        auto& worker = workers[worker_id];
+        auto [begin, end] = worker_tables(worker_id);
+        worker.tables_by_name.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            auto& table = tables[i];
+            auto& t = *table.declaration;
+            t.table_columns.reserve(table.columns.size());
+            for (auto& column : table.columns) {
+                t.table_columns.emplace_back(std::nullopt, *worker.names[column.first].registered);
+            }
             // Store the catalog ids in the table columns
             t.table_columns_by_name.reserve(t.table_columns.size());
             for (size_t column_index = 0; column_index != t.table_columns.size(); ++column_index) {
                 auto& column = t.table_columns[column_index];
                 column.table = t;
                 column.column_index = column_index;
-                column.column_name.get().resolved_objects.PushBack(column.CastToBase());
                 t.table_columns_by_name.insert({column.column_name.get().text, column});
             }
+            worker.tables_by_name.emplace_back(t.table_name, i);
         }
-    }
+        std::sort(worker.tables_by_name.begin(), worker.tables_by_name.end());
+    });
 
-    // Build table index
-    for (auto& table_chunk : table_declarations.GetChunks()) {
-        for (auto& table : table_chunk) {
-            tables_by_name.insert({table.table_name, table});
-            for (size_t i = 0; i < table.table_columns.size(); ++i) {
-                table_columns_by_name.insert({table.table_columns[i].column_name.get().text, table.table_columns[i]});
-            }
+    // Register the columns for the column names
+    for (auto& table : tables) {
+        auto& t = *table.declaration;
+        for (auto& column : t.table_columns) {
+            column.column_name.get().resolved_objects.PushBack(column.CastToBase());
+            table_columns_by_name.insert({column.column_name.get().text, column});
         }
     }
+    // Merge the sorted runs into the table index, the table names are distinct
+    std::vector<std::pair<QualifiedTableName::Key, size_t>> new_tables_by_name;
+    new_tables_by_name.reserve(tables.size());
+    for (auto& worker : workers) {
+        auto mid = new_tables_by_name.size();
+        new_tables_by_name.insert(new_tables_by_name.end(), worker.tables_by_name.begin(), worker.tables_by_name.end());
+        std::inplace_merge(new_tables_by_name.begin(), new_tables_by_name.begin() + mid, new_tables_by_name.end());
+    }
+    auto hint = tables_by_name.begin();
+    for (auto& [key, table_index] : new_tables_by_name) {
+        hint = std::next(tables_by_name.insert(hint, {key, *tables[table_index].declaration}));
+    }
+    UpdateNameFilter();
     return buffers::StatusCode::OK;
 }
 
-void CatalogEntry::ResolveTableColumnsWithCatalog(std::string_view table_column, std::vector<TableColumn>& tmp) const {
+void DescriptorPool::DeclareSchema(std::string_view database_name_text, CatalogDatabaseID database_id,
+                                   std::string_view schema_name_text, CatalogSchemaID schema_id) {
+    // The descriptors register the names again, only they count as occurrences
+    auto& db_name = name_registry.Register(database_name_text, NameTags{buffers::NameTag::DATABASE_NAME});
+    auto& schema_name = name_registry.Register(schema_name_text, NameTags{buffers::NameTag::SCHEMA_NAME});
+    --db_name.occurrences;
+    --schema_name.occurrences;
+
+    if (!databases_by_name.contains(db_name)) {
+        auto& db = database_references.Append(CatalogEntry::DatabaseReference{database_id, db_name, ""});
+        databases_by_name.insert({db.database_name, db});
+        db_name.resolved_objects.PushBack(db.CastToBase());
+    }
+    if (!schemas_by_name.contains({db_name, schema_name})) {
+        auto database_id = databases_by_name.at(db_name).get().catalog_database_id;
+        auto& schema =
+            schema_references.Append(CatalogEntry::SchemaReference{database_id, schema_id, db_name, schema_name});
+        schemas_by_name.insert({{db_name, schema_name}, schema});
+        schema_name.resolved_objects.PushBack(schema.CastToBase());
+    }
+}
+
+bool DescriptorPool::RestoreNameSearchIndex(std::shared_ptr<const NameSearchIndex::SharedSuffixArray> suffix_array) {
+    NameSearchIndex index{name_registry, std::move(suffix_array)};
+    if (index.GetDeltaCount() != 0) {
+        return false;
+    }
+    name_search_index.emplace(std::move(index));
+    return true;
+}
+
+void CatalogEntry::ResolveTableColumnsWithCatalog(const Catalog& catalog, std::string_view table_column,
+                                                  std::vector<TableColumn>& tmp) const {
+    // Skip entries that don't declare the column name
+    auto column_hash = BloomFilter::HashFolded(table_column, NAME_FILTER_COLUMN_SEED);
     for (auto& [key, entry] : catalog.entries) {
-        if (entry != this) {
+        if (entry != this && entry->MayContainColumn(column_hash)) {
             entry->ResolveTableColumns(table_column, tmp);
         }
     }
@@ -440,11 +886,35 @@ Catalog::Catalog(std::string_view default_db, std::string_view default_schema)
       default_schema_name(default_schema.empty() ? DEFAULT_SCHEMA_NAME : default_schema) {}
 
 void Catalog::Clear() {
+    auto lock = LockForModification();
+    // Release the names of all entries
+    for (auto& [key, info] : entries_by_schema) {
+        name_interner.Release(std::get<0>(key));
+        name_interner.Release(std::get<1>(key));
+    }
+    for (auto& [entry_id, entry] : entries) {
+        ReleaseNames(*entry);
+    }
     entries_by_schema.clear();
     entries_ranked.clear();
     entries.clear();
+    for (auto& [script, entry] : script_entries) {
+        RetireScript(*script, std::move(entry.analyzed));
+    }
     script_entries.clear();
+    table_deltas.clear();
+    name_index.Clear();
     descriptor_pool_entries.clear();
+    ResetSnapshot();
+    resolution_cache.clear();
+    flat_catalog.all_tables_dirty = true;
+    // Every registered dependency is outdated now
+    for (auto& [key, dependent] : table_dependents) {
+        outdated_statements[dependent.catalog_entry_id].insert(dependent.ast_statement_id);
+    }
+    for (auto& [key, dependent] : column_dependents) {
+        outdated_statements[dependent.catalog_entry_id].insert(dependent.ast_statement_id);
+    }
     ++version;
 }
 
@@ -477,235 +947,351 @@ flatbuffers::Offset<buffers::CatalogEntries> Catalog::DescribeEntriesOf(flatbuff
     }
 }
 
-/// Flatten the catalog
-flatbuffers::Offset<buffers::FlatCatalog> Catalog::Flatten(flatbuffers::FlatBufferBuilder& builder) const {
-    // We build a name dictionary so that JS can save unnecessary utf8->utf16 conversions.
-    // The JS renderers are virtualized which means that they only need to convert catalog entry names that are visible.
-    std::unordered_map<std::string_view, size_t> name_dictionary_index;
-    std::vector<std::string_view> name_dictionary;
+std::string_view Catalog::InternFlatName(std::string_view name) { return flat_catalog.names[GetFlatNameId(name)]; }
 
-    // Helper to add a name to the dictionary
-    auto add_name = [&](std::string_view name) {
-        auto iter = name_dictionary_index.find(name);
-        if (iter != name_dictionary_index.end()) {
-            return iter->second;
-        } else {
-            auto name_id = name_dictionary_index.size();
-            name_dictionary_index.insert({name, name_id});
-            name_dictionary.push_back(name);
-            return name_id;
-        }
-    };
+uint32_t Catalog::GetFlatNameId(std::string_view name) {
+    auto& flat = flat_catalog;
+    if (auto iter = flat.name_ids.find(name); iter != flat.name_ids.end()) {
+        return iter->second;
+    }
+    // The flat catalog copies its names, the keys must not depend on names that the interner may release
+    auto buffer = std::make_unique<char[]>(name.size());
+    std::memcpy(buffer.get(), name.data(), name.size());
+    std::string_view text{buffer.get(), name.size()};
+    auto name_id = static_cast<uint32_t>(flat.names.size());
+    flat.name_buffers.push_back(std::move(buffer));
+    flat.names.push_back(text);
+    flat.name_ids.insert({text, name_id});
+    return name_id;
+}
 
-    struct ColumnNode {
-        // The column id
-        uint32_t column_id;
-        // A name id
-        size_t name_id;
-    };
+void Catalog::RefreshFlatCatalog() {
+    auto& flat = flat_catalog;
+    if (flat.version == version) {
+        return;
+    }
+    using ChangeType = buffers::FlatCatalogChangeType;
+    using ObjectType = buffers::FlatCatalogObjectType;
+    std::vector<buffers::FlatCatalogChange> removed_changes;
+    std::vector<buffers::FlatCatalogChange> changes;
+
+    // The keys of the flat catalog point into the flat name dictionary
+    auto stable = [&](std::string_view text) { return InternFlatName(text); };
+
+    // Collect the databases and schemas of all entries.
+    // There are only few of them, we therefore collect them from scratch.
+    decltype(flat.databases) databases;
+    decltype(flat.schemas) schemas;
+    for (auto& [rank, catalog_entry_id] : entries_ranked) {
+        auto* catalog_entry = entries.at(catalog_entry_id);
+        for (auto& [db_name, db_ref] : catalog_entry->databases_by_name) {
+            auto name = stable(db_name);
+            if (!databases.contains(name)) {
+                databases.insert({name, FlatObject{db_ref.get().catalog_database_id, 0, GetFlatNameId(name)}});
+            }
+        }
+        for (auto& [schema_key, schema_ref] : catalog_entry->schemas_by_name) {
+            std::pair<std::string_view, std::string_view> key{stable(schema_key.first), stable(schema_key.second)};
+            if (!schemas.contains(key)) {
+                auto& schema = schema_ref.get();
+                schemas.insert(
+                    {key, FlatObject{schema.catalog_schema_id, schema.catalog_database_id, GetFlatNameId(key.second)}});
+            }
+        }
+    }
 
-    struct TableNode {
-        // The catalog object id
-        ContextObjectID table_id;
-        // A name id
-        size_t name_id;
-        // Child nodes
-        ChunkBuffer<ColumnNode, 16>::ConstTupleIterator children_begin;
-        // Child count
-        size_t child_count;
+    // Diff databases and schemas by name, objects that keep their id under a new name are renamed
+    auto diff_objects = [&](auto& prev, auto& next, ObjectType type) {
+        ankerl::unordered_dense::map<uint32_t, FlatObject> removed;
+        for (auto& [key, object] : prev) {
+            auto iter = next.find(key);
+            if (iter == next.end() || iter->second.object_id != object.object_id) {
+                removed.insert({object.object_id, object});
+            }
+        }
+        for (auto& [key, object] : next) {
+            auto iter = prev.find(key);
+            if (iter != prev.end() && iter->second.object_id == object.object_id) {
+                continue;
+            }
+            if (auto removed_iter = removed.find(object.object_id); removed_iter != removed.end()) {
+                changes.emplace_back(ChangeType::RENAMED, type, object.object_id, object.parent_id, object.name_id,
+                                     removed_iter->second.name_id);
+                removed.erase(removed_iter);
+            } else {
+                changes.emplace_back(ChangeType::ADDED, type, object.object_id, object.parent_id, object.name_id, 0);
+            }
+        }
+        for (auto& [object_id, object] : removed) {
+            removed_changes.emplace_back(ChangeType::REMOVED, type, object_id, object.parent_id, object.name_id, 0);
+        }
     };
+    diff_objects(flat.databases, databases, ObjectType::DATABASE);
+    diff_objects(flat.schemas, schemas, ObjectType::SCHEMA);
+    flat.databases = std::move(databases);
+    flat.schemas = std::move(schemas);
+
+    // Order the databases and schemas of the tree
+    flat.database_order.clear();
+    flat.database_schemas.clear();
+    flat.database_names_by_id.clear();
+    flat.schema_names_by_id.clear();
+    for (auto& [db_name, db] : flat.databases) {
+        flat.database_order.push_back(db_name);
+        flat.database_names_by_id.insert({db.object_id, db_name});
+    }
+    for (auto& [schema_key, schema] : flat.schemas) {
+        flat.database_schemas[schema_key.first].push_back(schema_key);
+        flat.schema_names_by_id.insert({schema.object_id, schema_key});
+    }
 
-    struct SchemaNode {
-        // The catalog object id
-        uint32_t schema_id;
-        // A name id
-        size_t name_id;
-        // Child nodes
-        std::map<std::string_view, std::reference_wrapper<TableNode>> children;
+    // Diff the columns of a table by position
+    auto diff_columns = [&](uint64_t table_id, const std::vector<uint32_t>& prev, const std::vector<uint32_t>& next) {
+        auto common = std::min(prev.size(), next.size());
+        for (uint32_t i = 0; i < common; ++i) {
+            if (prev[i] != next[i]) {
+                changes.emplace_back(ChangeType::RENAMED, ObjectType::COLUMN, i, table_id, next[i], prev[i]);
+            }
+        }
+        for (uint32_t i = common; i < next.size(); ++i) {
+            changes.emplace_back(ChangeType::ADDED, ObjectType::COLUMN, i, table_id, next[i], 0);
+        }
+        for (uint32_t i = common; i < prev.size(); ++i) {
+            removed_changes.emplace_back(ChangeType::REMOVED, ObjectType::COLUMN, i, table_id, prev[i], 0);
+        }
     };
-
-    struct DatabaseNode {
-        // The catalog object id
-        uint32_t database_id;
-        // A name id
-        size_t name_id;
-        // Child nodes
-        std::map<std::string_view, std::reference_wrapper<SchemaNode>> children;
+    auto get_column_name_ids = [&](const CatalogEntry::TableDeclaration& table) {
+        std::vector<uint32_t> column_name_ids;
+        column_name_ids.reserve(table.table_columns.size());
+        for (auto& column : table.table_columns) {
+            column_name_ids.push_back(GetFlatNameId(column.column_name.get().text));
+        }
+        return column_name_ids;
     };
 
-    // Allocate nodes in chunk buffers
-    ChunkBuffer<DatabaseNode, 16> database_nodes;
-    ChunkBuffer<SchemaNode, 16> schema_nodes;
-    ChunkBuffer<TableNode, 16> table_nodes;
-    ChunkBuffer<ColumnNode, 16> column_nodes;
-    // Track all root database nodes
-    std::map<std::string_view, std::reference_wrapper<DatabaseNode>> root;
-    // Track maps for database and schema nodes
-    std::unordered_map<CatalogDatabaseID, DatabaseNode*> database_node_map;
-    std::unordered_map<CatalogSchemaID, SchemaNode*> schema_node_map;
-
-    for (auto& [catalog_entry_id, catalog_entry] : entries) {
-        /// Register all databases
-        for (auto& [db_key, db_ref_raw] : catalog_entry->databases_by_name) {
-            auto& db_ref = db_ref_raw.get();
-            if (auto iter = database_node_map.find(db_ref.catalog_database_id); iter == database_node_map.end()) {
-                auto db_name = db_ref.database_name;
-                auto db_name_id = add_name(db_ref.database_name);
-
-                if (!database_node_map.contains(db_ref.catalog_database_id)) {
-                    auto& db_node = database_nodes.Append(DatabaseNode{db_ref.catalog_database_id, db_name_id});
-                    database_node_map.insert({db_ref.catalog_database_id, &db_node});
-
-                    auto db_name_unique = root.insert({db_name, db_node}).second;
-                    assert(db_name_unique);
-                }
+    // Resolve all tables again if we don't know which ones changed
+    if (flat.all_tables_dirty) {
+        flat.dirty_tables.clear();
+        for (auto& [key, table] : flat.tables) {
+            flat.dirty_tables.insert(key);
+        }
+        for (auto& [catalog_entry_id, catalog_entry] : entries) {
+            for (auto& [key, table] : catalog_entry->tables_by_name) {
+                auto& [db_name, schema_name, table_name] = key;
+                flat.dirty_tables.insert({stable(db_name), stable(schema_name), stable(table_name)});
             }
         }
+        flat.all_tables_dirty = false;
+    }
 
-        /// Register all schemas
-        for (auto& [schema_key, schema_ref_raw] : catalog_entry->schemas_by_name) {
-            auto& schema_ref = schema_ref_raw.get();
-            if (auto iter = schema_node_map.find(schema_ref.catalog_schema_id); iter == schema_node_map.end()) {
-                auto schema_name = schema_ref.schema_name;
-                auto schema_name_id = add_name(schema_ref.schema_name);
-
-                if (!schema_node_map.contains(schema_ref.catalog_schema_id)) {
-                    auto& schema_node = schema_nodes.Append(SchemaNode{schema_ref.catalog_schema_id, schema_name_id});
-                    schema_node_map.insert({schema_ref.catalog_schema_id, &schema_node});
-
-                    auto& db_node = database_node_map.at(schema_ref.catalog_database_id);
-                    auto schema_name_unique = db_node->children.insert({schema_ref.schema_name, schema_node}).second;
-                    assert(schema_name_unique);
-                }
+    // Resolve the dirty tables.
+    // Tables may be declared by multiple entries, the entry with the lowest rank wins.
+    ankerl::unordered_dense::map<uint64_t, FlatTable> removed_tables;
+    btree::set<std::pair<std::string_view, std::string_view>> reordered_schemas;
+    std::vector<std::pair<CatalogEntry::QualifiedTableName::Key, const CatalogEntry::TableDeclaration*>> added_tables;
+    for (auto& key : flat.dirty_tables) {
+        const CatalogEntry::TableDeclaration* resolved = nullptr;
+        auto [lb, ub] = FindSchemaEntries(std::get<0>(key), std::get<1>(key));
+        for (auto iter = lb; iter != ub && resolved == nullptr; ++iter) {
+            auto& tables_by_name = entries.at(std::get<3>(iter->first))->tables_by_name;
+            if (auto table_iter = tables_by_name.find(key); table_iter != tables_by_name.end()) {
+                resolved = &table_iter->second.get();
+            }
+        }
+        if (auto prev_iter = flat.tables.find(key); prev_iter != flat.tables.end()) {
+            auto& prev = prev_iter->second;
+            if (resolved != nullptr && resolved->catalog_table_id == prev.table_id) {
+                auto column_name_ids = get_column_name_ids(*resolved);
+                diff_columns(prev.table_id.Pack(), prev.column_name_ids, column_name_ids);
+                prev.column_name_ids = std::move(column_name_ids);
+                continue;
+            }
+            flat.table_names_by_id.erase(prev.table_id.Pack());
+            removed_tables.insert({prev.table_id.Pack(), std::move(prev)});
+            flat.tables.erase(prev_iter);
+            reordered_schemas.insert({std::get<0>(key), std::get<1>(key)});
+        }
+        if (resolved != nullptr) {
+            added_tables.emplace_back(key, resolved);
+        }
+    }
+    flat.dirty_tables.clear();
+
+    // Add the new tables, tables that keep their id under a new name are renamed
+    for (auto& [key, table] : added_tables) {
+        FlatTable flat_table{
+            .table_id = table->catalog_table_id,
+            .schema_id = table->catalog_schema_id,
+            .name_id = GetFlatNameId(std::get<2>(key)),
+            .column_name_ids = get_column_name_ids(*table),
+        };
+        auto table_id = flat_table.table_id.Pack();
+        if (auto removed_iter = removed_tables.find(table_id); removed_iter != removed_tables.end()) {
+            auto& prev = removed_iter->second;
+            changes.emplace_back(ChangeType::RENAMED, ObjectType::TABLE, table_id, flat_table.schema_id,
+                                 flat_table.name_id, prev.name_id);
+            diff_columns(table_id, prev.column_name_ids, flat_table.column_name_ids);
+            removed_tables.erase(removed_iter);
+        } else {
+            changes.emplace_back(ChangeType::ADDED, ObjectType::TABLE, table_id, flat_table.schema_id,
+                                 flat_table.name_id, 0);
+            for (uint32_t i = 0; i < flat_table.column_name_ids.size(); ++i) {
+                changes.emplace_back(ChangeType::ADDED, ObjectType::COLUMN, i, table_id, flat_table.column_name_ids[i],
+                                     0);
             }
         }
+        flat.tables.insert({key, std::move(flat_table)});
+        flat.table_names_by_id[table_id] = key;
+        reordered_schemas.insert({std::get<0>(key), std::get<1>(key)});
+    }
+    for (auto& [table_id, table] : removed_tables) {
+        removed_changes.emplace_back(ChangeType::REMOVED, ObjectType::TABLE, table_id, table.schema_id, table.name_id,
+                                     0);
     }
 
-    // Track the effective table count.
-    // Tables are not deduplicated among catalog entries and may override each other.
-    size_t effective_table_count = 0;
+    // Order the tables of schemas that gained or lost tables
+    for (auto& schema_key : reordered_schemas) {
+        std::vector<CatalogEntry::QualifiedTableName::Key> tables;
+        CatalogEntry::QualifiedTableName::Key tables_lb{schema_key.first, schema_key.second, std::string_view{}};
+        for (auto iter = flat.tables.lower_bound(tables_lb); iter != flat.tables.end() &&
+                                                             std::get<0>(iter->first) == schema_key.first &&
+                                                             std::get<1>(iter->first) == schema_key.second;
+             ++iter) {
+            tables.push_back(iter->first);
+        }
+        if (tables.empty()) {
+            flat.schema_tables.erase(schema_key);
+        } else {
+            flat.schema_tables[schema_key] = std::move(tables);
+        }
+    }
 
-    // Translate all table declarations.
-    // Iterate over entries in ranked order since there might be duplicate table declarations.
-    for (auto& [rank, catalog_entry_id] : entries_ranked) {
-        auto& catalog_entry = entries.at(catalog_entry_id);
-        for (auto& chunk : catalog_entry->table_declarations.GetChunks()) {
-            for (auto& entry : chunk) {
-                // Resolve the schema node
-                auto& schema_node = schema_node_map.at(entry.catalog_schema_id);
-
-                // Check if the schema node already contains a table.
-                // This may happen if a table is overwritten between catalog entries.
-                // Check which wins based on the catalog entry rank
-                auto& table_name = entry.table_name.table_name;
-                if (schema_node->children.contains(table_name.get().text)) {
-                    continue;
-                }
+    // Record the changes of this version, removals first
+    for (auto& change : removed_changes) {
+        flat.changes.emplace_back(version, change);
+    }
+    for (auto& change : changes) {
+        flat.changes.emplace_back(version, change);
+    }
+    flat.name_counts.insert({version, static_cast<uint32_t>(flat.names.size())});
+    flat.version = version;
+
+    // Forget the changes of old versions.
+    // We drop whole versions, down to half of the limit so that we don't shift the changes with every version.
+    if (flat.changes.size() > MAX_FLAT_CATALOG_CHANGES) {
+        auto horizon = flat.changes[flat.changes.size() - MAX_FLAT_CATALOG_CHANGES / 2].first;
+        auto keep = std::partition_point(flat.changes.begin(), flat.changes.end(),
+                                         [&](auto& change) { return change.first <= horizon; });
+        flat.changes.erase(flat.changes.begin(), keep);
+        flat.name_counts.erase(flat.name_counts.begin(), flat.name_counts.lower_bound(horizon));
+        flat.horizon = horizon;
+    }
+}
 
-                // Add all columns nodes
-                auto columns_begin = column_nodes.GetIteratorAtLast();
-                if (entry.table_columns.size() > 0) {
-                    auto& first_column = entry.table_columns[0];
-                    auto first_column_name_id = add_name(first_column.column_name.get().text);
-                    auto& first_column_node = column_nodes.Append(ColumnNode{0, first_column_name_id});
-                    columns_begin = column_nodes.GetIteratorAtLast();
-
-                    for (uint32_t column_id = 1; column_id < entry.table_columns.size(); ++column_id) {
-                        auto& column = entry.table_columns[column_id];
-                        auto column_name_id = add_name(column.column_name.get().text);
-                        column_nodes.Append(ColumnNode{column_id, column_name_id});
-                    }
-                }
-                auto column_count = entry.table_columns.size();
-
-                // Get the table declaration
-                auto table_name_id = add_name(table_name.get().text);
-                auto& table_node =
-                    table_nodes.Append(TableNode{entry.catalog_table_id, table_name_id, columns_begin, column_count});
-                schema_node->children.insert({table_name.get().text, table_node});
-                ++effective_table_count;
-            }
+void Catalog::CompactFlatCatalog() {
+    auto& flat = flat_catalog;
+
+    // Count the names that are still referenced by a database, schema, table or column
+    std::vector<bool> referenced(flat.names.size(), false);
+    size_t referenced_count = 0;
+    auto reference = [&](uint32_t name_id) {
+        referenced_count += !referenced[name_id];
+        referenced[name_id] = true;
+    };
+    for (auto& [name, database] : flat.databases) {
+        reference(database.name_id);
+    }
+    for (auto& [key, schema] : flat.schemas) {
+        reference(schema.name_id);
+    }
+    for (auto& [key, table] : flat.tables) {
+        reference(table.name_id);
+        for (auto column_name_id : table.column_name_ids) {
+            reference(column_name_id);
         }
     }
 
-    // Write the dictionary vector
-    auto dictionary = builder.CreateVectorOfStrings(name_dictionary);
+    // Compaction assigns new name ids, clients have to start over with the full flat catalog.
+    // We therefore only compact once the unreferenced names outnumber the referenced ones.
+    if ((flat.names.size() - referenced_count) <= referenced_count) {
+        return;
+    }
+    flat_catalog = FlatCatalogState{};
+    RefreshFlatCatalog();
+    flat.changes.clear();
+    flat.horizon = version;
+}
+
+/// Flatten the catalog
+flatbuffers::Offset<buffers::FlatCatalog> Catalog::Flatten(flatbuffers::FlatBufferBuilder& builder) {
+    auto lock = LockForModification();
+    // The flat catalog is maintained incrementally, only the tables that changed since the last flatten are resolved.
+    // A full flatten drops the names of removed objects from the dictionary once they pile up.
+    RefreshFlatCatalog();
+    CompactFlatCatalog();
+    auto& flat = flat_catalog;
+
+    // We write a name dictionary so that JS can save unnecessary utf8->utf16 conversions.
+    // The JS renderers are virtualized which means that they only need to convert catalog entry names that are visible.
+    auto dictionary = builder.CreateVectorOfStrings(flat.names);
 
     // Allocate the entry node vectors
     std::vector<dashql::buffers::FlatCatalogEntry> database_entries;
     std::vector<dashql::buffers::FlatCatalogEntry> schema_entries;
     std::vector<dashql::buffers::FlatCatalogEntry> table_entries;
     std::vector<dashql::buffers::FlatCatalogEntry> column_entries;
-    database_entries.resize(database_nodes.GetSize());
-    schema_entries.resize(schema_nodes.GetSize());
-    table_entries.resize(effective_table_count);
-    column_entries.resize(column_nodes.GetSize());
+    database_entries.reserve(flat.databases.size());
+    schema_entries.reserve(flat.schemas.size());
+    table_entries.reserve(flat.tables.size());
 
     // Allocate the index vectors
     std::vector<buffers::IndexedFlatDatabaseEntry> indexed_database_entries;
     std::vector<buffers::IndexedFlatSchemaEntry> indexed_schema_entries;
     std::vector<buffers::IndexedFlatTableEntry> indexed_table_entries;
-    indexed_database_entries.resize(database_nodes.GetSize());
-    indexed_schema_entries.resize(schema_nodes.GetSize());
-    indexed_table_entries.resize(effective_table_count);
-
-    size_t next_database_idx = 0;
-    size_t next_schema_idx = 0;
-    size_t next_table_idx = 0;
-    size_t next_column_idx = 0;
-
-    // Write all catalog entries to the buffers
-    for (auto root_iter = root.begin(); root_iter != root.end(); ++root_iter, ++next_database_idx) {
-        auto& [database_name, database_node] = *root_iter;
-        // Write database node
-        auto& db_node_ref = database_node.get();
-        database_entries[next_database_idx] = buffers::FlatCatalogEntry(
-            next_database_idx, 0, db_node_ref.database_id, db_node_ref.name_id, 0, db_node_ref.children.size());
-        indexed_database_entries[next_database_idx] =
-            buffers::IndexedFlatDatabaseEntry(db_node_ref.database_id, next_database_idx);
-
-        // Write schema nodes
-        for (auto db_child_iter = db_node_ref.children.begin(); db_child_iter != db_node_ref.children.end();
-             ++db_child_iter, ++next_schema_idx) {
-            auto& [schema_name, schema_node] = *db_child_iter;
-            // Write schema node
-            auto& schema_node_ref = schema_node.get();
-            schema_entries[next_schema_idx] = dashql::buffers::FlatCatalogEntry(
-                next_schema_idx, next_database_idx, schema_node_ref.schema_id, schema_node_ref.name_id, next_table_idx,
-                schema_node_ref.children.size());
-            indexed_schema_entries[next_schema_idx] =
-                buffers::IndexedFlatSchemaEntry(schema_node_ref.schema_id, next_schema_idx);
-
-            // Write table nodes
-            for (auto schema_child_iter = schema_node_ref.children.begin();
-                 schema_child_iter != schema_node_ref.children.end(); ++schema_child_iter, ++next_table_idx) {
-                auto& [table_name, table_node] = *schema_child_iter;
-                // Write table node
-                auto& table_node_ref = table_node.get();
-                table_entries[next_table_idx] = dashql::buffers::FlatCatalogEntry(
-                    next_table_idx, next_schema_idx, table_node_ref.table_id.Pack(), table_node_ref.name_id,
-                    next_column_idx, table_node_ref.child_count);
-                indexed_table_entries[next_table_idx] =
-                    buffers::IndexedFlatTableEntry(table_node_ref.table_id.Pack(), next_table_idx);
-
-                // Write column nodes
-                auto child_iter = table_node_ref.children_begin;
-                for (auto column_id = 0; column_id < table_node_ref.child_count;
-                     ++column_id, ++child_iter, ++next_column_idx) {
-                    auto& column_node = *child_iter;
-                    // Write column node
-                    column_entries[next_column_idx] = dashql::buffers::FlatCatalogEntry(
-                        next_column_idx, next_table_idx, column_id, column_node.name_id, 0, 0);
+    indexed_database_entries.reserve(flat.databases.size());
+    indexed_schema_entries.reserve(flat.schemas.size());
+    indexed_table_entries.reserve(flat.tables.size());
+
+    // Write all catalog entries ordered by name.
+    // The children of an entry are written contiguously, parents are written once we know their children.
+    for (auto& [database_name, database] : flat.databases) {
+        uint32_t database_idx = database_entries.size();
+        uint32_t schemas_begin = schema_entries.size();
+        database_entries.emplace_back();
+        indexed_database_entries.emplace_back(database.object_id, database_idx);
+
+        for (auto schema_iter = flat.schemas.lower_bound({database_name, std::string_view{}});
+             schema_iter != flat.schemas.end() && schema_iter->first.first == database_name; ++schema_iter) {
+            auto& [schema_key, schema] = *schema_iter;
+            uint32_t schema_idx = schema_entries.size();
+            uint32_t tables_begin = table_entries.size();
+            schema_entries.emplace_back();
+            indexed_schema_entries.emplace_back(schema.object_id, schema_idx);
+
+            CatalogEntry::QualifiedTableName::Key tables_lb{database_name, schema_key.second, std::string_view{}};
+            for (auto table_iter = flat.tables.lower_bound(tables_lb);
+                 table_iter != flat.tables.end() && std::get<0>(table_iter->first) == database_name &&
+                 std::get<1>(table_iter->first) == schema_key.second;
+                 ++table_iter) {
+                auto& table = table_iter->second;
+                uint32_t table_idx = table_entries.size();
+                table_entries.emplace_back(table_idx, schema_idx, table.table_id.Pack(), table.name_id,
+                                           column_entries.size(), table.column_name_ids.size());
+                indexed_table_entries.emplace_back(table.table_id.Pack(), table_idx);
+                for (uint32_t column_id = 0; column_id < table.column_name_ids.size(); ++column_id) {
+                    column_entries.emplace_back(column_entries.size(), table_idx, column_id,
+                                                table.column_name_ids[column_id], 0, 0);
                 }
             }
+            schema_entries[schema_idx] = buffers::FlatCatalogEntry(schema_idx, database_idx, schema.object_id,
+                                                                   schema.name_id, tables_begin,
+                                                                   table_entries.size() - tables_begin);
         }
+        database_entries[database_idx] =
+            buffers::FlatCatalogEntry(database_idx, 0, database.object_id, database.name_id, schemas_begin,
+                                      schema_entries.size() - schemas_begin);
     }
 
-    assert(next_database_idx == database_nodes.GetSize());
-    assert(next_schema_idx == schema_nodes.GetSize());
-    assert(next_table_idx == effective_table_count);
-    assert(next_column_idx == column_nodes.GetSize());
-
     // Sort indexes
     std::sort(indexed_database_entries.begin(), indexed_database_entries.end(),
               [](auto& l, auto& r) { return l.database_id() < r.database_id(); });
@@ -725,21 +1311,277 @@ flatbuffers::Offset<buffers::FlatCatalog> Catalog::Flatten(flatbuffers::FlatBuff
     auto schemas_by_id_ofs = builder.CreateVectorOfStructs(indexed_schema_entries);
     auto tables_by_id_ofs = builder.CreateVectorOfStructs(indexed_table_entries);
 
-    // Build the flat catalog
-    buffers::FlatCatalogBuilder catalogBuilder{builder};
-    catalogBuilder.add_catalog_version(version);
-    catalogBuilder.add_name_dictionary(dictionary);
-    catalogBuilder.add_databases(databases_ofs);
-    catalogBuilder.add_schemas(schemas_ofs);
-    catalogBuilder.add_tables(tables_ofs);
-    catalogBuilder.add_columns(columns_ofs);
-    catalogBuilder.add_databases_by_id(databases_by_id_ofs);
-    catalogBuilder.add_schemas_by_id(schemas_by_id_ofs);
-    catalogBuilder.add_tables_by_id(tables_by_id_ofs);
-    return catalogBuilder.Finish();
+    // Build the flat catalog
+    buffers::FlatCatalogBuilder catalogBuilder{builder};
+    catalogBuilder.add_catalog_version(version);
+    catalogBuilder.add_name_dictionary(dictionary);
+    catalogBuilder.add_databases(databases_ofs);
+    catalogBuilder.add_schemas(schemas_ofs);
+    catalogBuilder.add_tables(tables_ofs);
+    catalogBuilder.add_columns(columns_ofs);
+    catalogBuilder.add_databases_by_id(databases_by_id_ofs);
+    catalogBuilder.add_schemas_by_id(schemas_by_id_ofs);
+    catalogBuilder.add_tables_by_id(tables_by_id_ofs);
+    return catalogBuilder.Finish();
+}
+
+/// Flatten the changes of the catalog since a version
+flatbuffers::Offset<buffers::FlatCatalogDelta> Catalog::FlattenDelta(flatbuffers::FlatBufferBuilder& builder,
+                                                                     Version since_version) {
+    auto lock = LockForModification();
+    RefreshFlatCatalog();
+    auto& flat = flat_catalog;
+
+    // We can only patch versions that we still remember
+    bool complete = since_version >= flat.horizon;
+    std::vector<std::string_view> name_dictionary;
+    std::vector<buffers::FlatCatalogChange> changes;
+    uint32_t names_begin = flat.names.size();
+    if (complete) {
+        // Find the dictionary size of the base version
+        auto count_iter = flat.name_counts.upper_bound(since_version);
+        names_begin = (count_iter == flat.name_counts.begin()) ? 0 : std::prev(count_iter)->second;
+        name_dictionary.assign(flat.names.begin() + names_begin, flat.names.end());
+        // Collect the changes of all later versions
+        auto changes_begin = std::partition_point(flat.changes.begin(), flat.changes.end(),
+                                                  [&](auto& change) { return change.first <= since_version; });
+        changes.reserve(flat.changes.end() - changes_begin);
+        for (auto iter = changes_begin; iter != flat.changes.end(); ++iter) {
+            changes.push_back(iter->second);
+        }
+    }
+    auto dictionary = builder.CreateVectorOfStrings(name_dictionary);
+    auto changes_ofs = builder.CreateVectorOfStructs(changes);
+
+    buffers::FlatCatalogDeltaBuilder deltaBuilder{builder};
+    deltaBuilder.add_catalog_version(version);
+    deltaBuilder.add_base_version(since_version);
+    deltaBuilder.add_complete(complete);
+    deltaBuilder.add_name_dictionary_offset(names_begin);
+    deltaBuilder.add_name_dictionary(dictionary);
+    deltaBuilder.add_changes(changes_ofs);
+    return deltaBuilder.Finish();
+}
+
+/// Flatten a window of the visible rows of the catalog tree
+flatbuffers::Offset<buffers::FlatCatalogWindow> Catalog::FlattenWindow(flatbuffers::FlatBufferBuilder& builder,
+                                                                       const FlatCatalogExpansion& expanded,
+                                                                       size_t row_offset, size_t row_count) {
+    auto lock = LockForModification();
+    RefreshFlatCatalog();
+    auto& flat = flat_catalog;
+    using ObjectType = buffers::FlatCatalogObjectType;
+    using SchemaKey = std::pair<std::string_view, std::string_view>;
+
+    // An expanded child of a tree node
+    struct ExpandedChild {
+        /// The position among the siblings
+        uint32_t position;
+        /// The visible rows below the child
+        uint32_t rows;
+        /// Comparison
+        bool operator<(const ExpandedChild& other) const { return position < other.position; }
+    };
+    auto sort_children = [](std::vector<ExpandedChild>& children) {
+        std::sort(children.begin(), children.end());
+        auto last = std::unique(children.begin(), children.end(),
+                                [](auto& l, auto& r) { return l.position == r.position; });
+        children.erase(last, children.end());
+    };
+    auto count_rows = [](const std::vector<ExpandedChild>& children) {
+        uint32_t rows = 0;
+        for (auto& child : children) {
+            rows += child.rows;
+        }
+        return rows;
+    };
+
+    // Resolve the expanded tables to their positions in their schemas
+    btree::map<SchemaKey, std::vector<ExpandedChild>> expanded_tables;
+    for (auto table_id : expanded.tables) {
+        auto name_iter = flat.table_names_by_id.find(table_id);
+        if (name_iter == flat.table_names_by_id.end()) {
+            continue;
+        }
+        auto& table_key = name_iter->second;
+        SchemaKey schema_key{std::get<0>(table_key), std::get<1>(table_key)};
+        auto& tables = flat.schema_tables.find(schema_key)->second;
+        auto position = std::lower_bound(tables.begin(), tables.end(), table_key) - tables.begin();
+        auto columns = flat.tables.find(table_key)->second.column_name_ids.size();
+        expanded_tables[schema_key].push_back(
+            ExpandedChild{static_cast<uint32_t>(position), static_cast<uint32_t>(columns)});
+    }
+    // Resolve the expanded schemas, they show their tables and the columns of their expanded tables
+    btree::map<std::string_view, std::vector<ExpandedChild>> expanded_schemas;
+    for (auto schema_id : expanded.schemas) {
+        auto name_iter = flat.schema_names_by_id.find(schema_id);
+        if (name_iter == flat.schema_names_by_id.end()) {
+            continue;
+        }
+        auto& schema_key = name_iter->second;
+        auto& schemas = flat.database_schemas.find(schema_key.first)->second;
+        auto position = std::lower_bound(schemas.begin(), schemas.end(), schema_key) - schemas.begin();
+        uint32_t rows = 0;
+        if (auto tables_iter = flat.schema_tables.find(schema_key); tables_iter != flat.schema_tables.end()) {
+            rows += tables_iter->second.size();
+        }
+        if (auto children_iter = expanded_tables.find(schema_key); children_iter != expanded_tables.end()) {
+            sort_children(children_iter->second);
+            rows += count_rows(children_iter->second);
+        }
+        expanded_schemas[schema_key.first].push_back(ExpandedChild{static_cast<uint32_t>(position), rows});
+    }
+    // Resolve the expanded databases, they show their schemas and the rows of their expanded schemas
+    std::vector<ExpandedChild> expanded_databases;
+    for (auto database_id : expanded.databases) {
+        auto name_iter = flat.database_names_by_id.find(database_id);
+        if (name_iter == flat.database_names_by_id.end()) {
+            continue;
+        }
+        auto& database_name = name_iter->second;
+        auto position = std::lower_bound(flat.database_order.begin(), flat.database_order.end(), database_name) -
+                        flat.database_order.begin();
+        uint32_t rows = 0;
+        if (auto schemas_iter = flat.database_schemas.find(database_name);
+            schemas_iter != flat.database_schemas.end()) {
+            rows += schemas_iter->second.size();
+        }
+        if (auto children_iter = expanded_schemas.find(database_name); children_iter != expanded_schemas.end()) {
+            sort_children(children_iter->second);
+            rows += count_rows(children_iter->second);
+        }
+        expanded_databases.push_back(ExpandedChild{static_cast<uint32_t>(position), rows});
+    }
+    sort_children(expanded_databases);
+    size_t total_rows = flat.database_order.size() + count_rows(expanded_databases);
+
+    // Find the child that contains a row of a node.
+    // Returns the position of the child and the row within the subtree of the child, 0 is the child itself.
+    // Only the expanded children are visited, collapsed children occupy a single row.
+    auto seek = [](const std::vector<ExpandedChild>& children, size_t row) -> std::pair<size_t, size_t> {
+        size_t skipped = 0;
+        for (auto& child : children) {
+            auto child_row = child.position + skipped;
+            if (row <= child_row) {
+                break;
+            }
+            if (row <= child_row + child.rows) {
+                return {child.position, row - child_row};
+            }
+            skipped += child.rows;
+        }
+        return {row - skipped, 0};
+    };
+
+    // Emit the rows of the window depth-first
+    std::vector<buffers::FlatCatalogRow> rows;
+    size_t row_limit = row_offset < total_rows ? std::min(row_count, total_rows - row_offset) : 0;
+    rows.reserve(row_limit);
+    const std::vector<ExpandedChild> no_children;
+    auto emit_columns = [&](const FlatTable& table, size_t first_column) {
+        auto table_id = table.table_id.Pack();
+        for (size_t i = first_column; i < table.column_name_ids.size() && rows.size() < row_limit; ++i) {
+            rows.emplace_back(ObjectType::COLUMN, false, i, table_id, table.column_name_ids[i], 0, 1);
+        }
+    };
+    auto emit_tables = [&](const SchemaKey& schema_key, size_t row) {
+        auto tables_iter = flat.schema_tables.find(schema_key);
+        if (tables_iter == flat.schema_tables.end()) {
+            return;
+        }
+        auto& tables = tables_iter->second;
+        auto children_iter = expanded_tables.find(schema_key);
+        auto& children = children_iter != expanded_tables.end() ? children_iter->second : no_children;
+        auto [position, inner] = seek(children, row);
+        auto next_child = std::lower_bound(children.begin(), children.end(),
+                                           ExpandedChild{static_cast<uint32_t>(position), 0});
+        for (auto i = position; i < tables.size() && rows.size() < row_limit; ++i, inner = 0) {
+            bool is_expanded = next_child != children.end() && next_child->position == i;
+            auto& table = flat.tables.find(tables[i])->second;
+            if (inner == 0) {
+                rows.emplace_back(ObjectType::TABLE, is_expanded, table.table_id.Pack(), table.schema_id,
+                                  table.name_id, table.column_name_ids.size(),
+                                  1 + (is_expanded ? next_child->rows : 0));
+            }
+            if (is_expanded) {
+                emit_columns(table, inner == 0 ? 0 : inner - 1);
+                ++next_child;
+            }
+        }
+    };
+    auto emit_schemas = [&](std::string_view database_name, size_t row) {
+        auto schemas_iter = flat.database_schemas.find(database_name);
+        if (schemas_iter == flat.database_schemas.end()) {
+            return;
+        }
+        auto& schemas = schemas_iter->second;
+        auto children_iter = expanded_schemas.find(database_name);
+        auto& children = children_iter != expanded_schemas.end() ? children_iter->second : no_children;
+        auto [position, inner] = seek(children, row);
+        auto next_child = std::lower_bound(children.begin(), children.end(),
+                                           ExpandedChild{static_cast<uint32_t>(position), 0});
+        for (auto i = position; i < schemas.size() && rows.size() < row_limit; ++i, inner = 0) {
+            bool is_expanded = next_child != children.end() && next_child->position == i;
+            auto& schema = flat.schemas.find(schemas[i])->second;
+            if (inner == 0) {
+                auto tables_iter = flat.schema_tables.find(schemas[i]);
+                auto table_count = tables_iter != flat.schema_tables.end() ? tables_iter->second.size() : 0;
+                rows.emplace_back(ObjectType::SCHEMA, is_expanded, schema.object_id, schema.parent_id, schema.name_id,
+                                  table_count, 1 + (is_expanded ? next_child->rows : 0));
+            }
+            if (is_expanded) {
+                emit_tables(schemas[i], inner == 0 ? 0 : inner - 1);
+                ++next_child;
+            }
+        }
+    };
+    {
+        auto [position, inner] = seek(expanded_databases, row_offset);
+        auto next_child = std::lower_bound(expanded_databases.begin(), expanded_databases.end(),
+                                           ExpandedChild{static_cast<uint32_t>(position), 0});
+        for (auto i = position; i < flat.database_order.size() && rows.size() < row_limit; ++i, inner = 0) {
+            bool is_expanded = next_child != expanded_databases.end() && next_child->position == i;
+            auto database_name = flat.database_order[i];
+            auto& database = flat.databases.find(database_name)->second;
+            if (inner == 0) {
+                auto schemas_iter = flat.database_schemas.find(database_name);
+                auto schema_count = schemas_iter != flat.database_schemas.end() ? schemas_iter->second.size() : 0;
+                rows.emplace_back(ObjectType::DATABASE, is_expanded, database.object_id, 0, database.name_id,
+                                  schema_count, 1 + (is_expanded ? next_child->rows : 0));
+            }
+            if (is_expanded) {
+                emit_schemas(database_name, inner == 0 ? 0 : inner - 1);
+                ++next_child;
+            }
+        }
+    }
+
+    // Collect the names of the rows
+    ankerl::unordered_dense::set<uint32_t> name_id_set;
+    std::vector<uint32_t> name_ids;
+    std::vector<std::string_view> names;
+    for (auto& row : rows) {
+        if (name_id_set.insert(row.name_id()).second) {
+            name_ids.push_back(row.name_id());
+            names.push_back(flat.names[row.name_id()]);
+        }
+    }
+    auto rows_ofs = builder.CreateVectorOfStructs(rows);
+    auto name_ids_ofs = builder.CreateVector(name_ids);
+    auto names_ofs = builder.CreateVectorOfStrings(names);
+
+    buffers::FlatCatalogWindowBuilder windowBuilder{builder};
+    windowBuilder.add_catalog_version(version);
+    windowBuilder.add_row_count(total_rows);
+    windowBuilder.add_row_offset(row_offset);
+    windowBuilder.add_rows(rows_ofs);
+    windowBuilder.add_name_ids(name_ids_ofs);
+    windowBuilder.add_names(names_ofs);
+    return windowBuilder.Finish();
 }
 
 buffers::StatusCode Catalog::LoadScript(Script& script, CatalogEntry::Rank rank) {
+    auto lock = LockForModification();
     if (!script.analyzed_script) {
         return buffers::StatusCode::CATALOG_SCRIPT_NOT_ANALYZED;
     }
@@ -802,6 +1644,7 @@ buffers::StatusCode Catalog::LoadScript(Script& script, CatalogEntry::Rank rank)
                 auto schema =
                     std::make_unique<SchemaDeclaration>(ref.get().catalog_database_id, ref.get().catalog_schema_id,
                                                         ref.get().database_name, ref.get().schema_name);
+                InvalidateSchema(schema->database_name, schema->schema_name);
                 schemas.insert(
                     {std::pair<std::string_view, std::string_view>{schema->database_name, schema->schema_name},
                      std::move(schema)});
@@ -813,14 +1656,12 @@ buffers::StatusCode Catalog::LoadScript(Script& script, CatalogEntry::Rank rank)
     CatalogEntry& entry = *script.analyzed_script;
     for (auto& [schema_key, schema_ref] : entry.schemas_by_name) {
         auto& [db_name, schema_name] = schema_key;
-        std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID> entry_key{
-            db_name, schema_name, rank, entry.GetCatalogEntryId()};
         CatalogSchemaEntryInfo entry_info{
             .catalog_entry_id = entry.GetCatalogEntryId(),
             .catalog_database_id = schema_ref.get().catalog_database_id,
             .catalog_schema_id = schema_ref.get().catalog_schema_id,
         };
-        entries_by_schema.insert({entry_key, entry_info});
+        AddSchemaEntry(db_name, schema_name, rank, entry_info);
     }
     // Register as script entry
     script_entries.insert({&script, {.script = script, .analyzed = script.analyzed_script, .rank = rank}});
@@ -828,6 +1669,18 @@ buffers::StatusCode Catalog::LoadScript(Script& script, CatalogEntry::Rank rank)
     entries.insert({entry.GetCatalogEntryId(), &entry});
     // Register rank
     entries_ranked.insert({rank, entry.GetCatalogEntryId()});
+    // Intern the table names and index all names
+    InternNames(entry);
+    name_index.AddEntryNames(entry, rank, script.analyzed_script->parsed_script->scanned_script->name_registry);
+    // Invalidate all statements that depend on the new tables
+    TableDelta delta;
+    delta.added_tables.reserve(entry.table_declarations.GetSize());
+    entry.table_declarations.ForEach([&](size_t i, auto& table) {
+        InvalidateTable(table);
+        delta.added_tables.push_back(table.catalog_table_id);
+    });
+    table_deltas.insert_or_assign(entry.GetCatalogEntryId(), std::move(delta));
+    UpdateResolutionCache(entry);
     ++version;
     return buffers::StatusCode::OK;
 }
@@ -901,11 +1754,11 @@ buffers::StatusCode Catalog::UpdateScript(ScriptEntry& entry) {
         } else {
             // Previous schema no longer exists in new schema.
             // Drop the entry reference from the catalog for this schema.
-            entries_by_schema.erase({db_name, schema_name, rank, external_id});
+            RemoveSchemaEntry(db_name, schema_name, rank, external_id);
+            InvalidateSchema(db_name, schema_name);
             // Check if there's any remaining catalog entry with that schema name
-            auto rem_iter = entries_by_schema.lower_bound({db_name, schema_name, 0, 0});
-            if (rem_iter == entries_by_schema.end() || std::get<0>(rem_iter->first) != db_name ||
-                std::get<1>(rem_iter->first) != schema_name) {
+            auto [rem_lb, rem_ub] = FindSchemaEntries(db_name, schema_name);
+            if (rem_lb == rem_ub) {
                 // If not, remove the schema declaration from the catalog completely
                 schemas.erase({db_name, schema_name});
             }
@@ -921,9 +1774,8 @@ buffers::StatusCode Catalog::UpdateScript(ScriptEntry& entry) {
                 .catalog_database_id = new_entry.schema_ref.catalog_database_id,
                 .catalog_schema_id = new_entry.schema_ref.catalog_schema_id,
             };
-            std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID> entry_key{
-                db_name, schema_name, rank, external_id};
-            entries_by_schema.insert({entry_key, entry});
+            AddSchemaEntry(db_name, schema_name, rank, entry);
+            InvalidateSchema(db_name, schema_name);
 
             // Add schema declaration
             if (!schemas.contains({db_name, schema_name})) {
@@ -946,23 +1798,41 @@ buffers::StatusCode Catalog::UpdateScript(ScriptEntry& entry) {
         // Check if the previous schema name is in the new schema entries.
         auto new_name_iter = new_dbs.find(db_name);
         if (new_name_iter == new_dbs.end()) {
-            // Check if there are other entries with that database name
-            auto other_iter = entries_by_schema.lower_bound({db_name, "", 0, 0});
-            if (other_iter == entries_by_schema.end() || std::get<0>(other_iter->first) != db_name) {
+            // Check if there are other entries with that database name.
+            // Every entry in entries_by_schema holds a reference to its database name.
+            auto db_name_id = name_interner.Find(db_name);
+            auto other_iter = db_name_id.has_value() ? entries_by_schema.lower_bound({*db_name_id, 0, 0, 0})
+                                                     : entries_by_schema.end();
+            if (other_iter == entries_by_schema.end() || std::get<0>(other_iter->first) != *db_name_id) {
                 databases.erase(db_name);
             }
         }
     }
 
-    entry.analyzed = script.analyzed_script;
+    // Invalidate all statements that depend on tables that were added, removed or changed
+    table_deltas.insert_or_assign(external_id, DiffTables(*entry.analyzed, *script.analyzed_script));
+
+    // Intern the new table names and re-index all names
+    InternNames(*script.analyzed_script);
+    name_index.RemoveEntry(external_id);
+    name_index.AddEntryNames(*script.analyzed_script, rank,
+                             script.analyzed_script->parsed_script->scanned_script->name_registry);
+
+    auto prev_analyzed = std::exchange(entry.analyzed, script.analyzed_script);
     auto entry_iter = entries.find(script.GetCatalogEntryId());
     assert(entry_iter != entries.end());
     entry_iter->second = entry.analyzed.get();
+    // Resolve the tables of both versions again, before the previous names are released
+    UpdateResolutionCache(*prev_analyzed);
+    UpdateResolutionCache(*entry.analyzed);
+    ReleaseNames(*prev_analyzed);
+    RetireScript(script, std::move(prev_analyzed));
     ++version;
     return buffers::StatusCode::OK;
 }
 
 void Catalog::DropScript(Script& script) {
+    auto lock = LockForModification();
     auto iter = script_entries.find(&script);
     if (iter != script_entries.end()) {
         auto external_id = script.GetCatalogEntryId();
@@ -970,21 +1840,28 @@ void Catalog::DropScript(Script& script) {
             auto& analyzed = iter->second.analyzed;
             for (auto& [schema_key, entry_info] : analyzed->schemas_by_name) {
                 auto& [db_name, schema_name] = schema_key;
-                entries_by_schema.erase({db_name, schema_name, iter->second.rank, external_id});
+                RemoveSchemaEntry(db_name, schema_name, iter->second.rank, external_id);
             }
+            analyzed->table_declarations.ForEach([&](size_t i, auto& table) { InvalidateTable(table); });
+            UpdateResolutionCache(*analyzed);
+            ReleaseNames(*analyzed);
+            RetireScript(script, std::move(analyzed));
         }
         entries_ranked.erase({iter->second.rank, external_id});
         entries.erase(external_id);
+        name_index.RemoveEntry(external_id);
         script_entries.erase(iter);
+        table_deltas.erase(external_id);
         ++version;
     }
 }
 
 buffers::StatusCode Catalog::AddDescriptorPool(CatalogEntryID external_id, CatalogEntry::Rank rank) {
+    auto lock = LockForModification();
     if (entries.contains(external_id)) {
         return buffers::StatusCode::EXTERNAL_ID_COLLISION;
     }
-    auto pool = std::make_unique<DescriptorPool>(*this, external_id, rank);
+    auto pool = std::make_shared<DescriptorPool>(*this, external_id, rank);
     entries.insert({external_id, pool.get()});
     entries_ranked.insert({rank, external_id});
     descriptor_pool_entries.insert({external_id, std::move(pool)});
@@ -992,36 +1869,176 @@ buffers::StatusCode Catalog::AddDescriptorPool(CatalogEntryID external_id, Catal
     return buffers::StatusCode::OK;
 }
 
+void Catalog::RegisterDescriptorPool(std::shared_ptr<DescriptorPool> pool) {
+    auto external_id = pool->GetCatalogEntryId();
+    auto rank = pool->GetRank();
+    entries.insert({external_id, pool.get()});
+    entries_ranked.insert({rank, external_id});
+    pool->GetSchemas().ForEach([&](auto i, const CatalogEntry::SchemaReference& schema_ref) {
+        CatalogSchemaEntryInfo entry{
+            .catalog_entry_id = external_id,
+            .catalog_database_id = schema_ref.catalog_database_id,
+            .catalog_schema_id = schema_ref.catalog_schema_id,
+        };
+        AddSchemaEntry(schema_ref.database_name, schema_ref.schema_name, rank, entry);
+    });
+    // Invalidate all statements that depend on the tables
+    pool->GetTables().ForEach([&](size_t i, const CatalogEntry::TableDeclaration& table) { InvalidateTable(table); });
+    InternNames(*pool);
+    UpdateResolutionCache(*pool);
+    // Frozen pools bring their own name index
+    if (!pool->IsFrozen()) {
+        name_index.AddEntryNames(*pool, rank, pool->GetNameRegistry());
+    }
+    descriptor_pool_entries.insert({external_id, std::move(pool)});
+}
+
+void Catalog::UnregisterDescriptorPool(const DescriptorPool& pool) {
+    auto external_id = pool.GetCatalogEntryId();
+    auto rank = pool.GetRank();
+    entries_ranked.erase({rank, external_id});
+    pool.GetSchemas().ForEach([&](auto i, const CatalogEntry::SchemaReference& schema_ref) {
+        RemoveSchemaEntry(schema_ref.database_name, schema_ref.schema_name, rank, external_id);
+    });
+    pool.GetTables().ForEach([&](auto i, const CatalogEntry::TableDeclaration& table) { InvalidateTable(table); });
+    UpdateResolutionCache(pool);
+    ReleaseNames(pool);
+    entries.erase(external_id);
+    name_index.RemoveEntry(external_id);
+}
+
 buffers::StatusCode Catalog::DropDescriptorPool(CatalogEntryID external_id) {
+    auto lock = LockForModification();
     auto iter = descriptor_pool_entries.find(external_id);
     if (iter != descriptor_pool_entries.end()) {
-        auto& pool = *iter->second;
-        auto rank = iter->second->GetRank();
-        entries_ranked.erase({rank, external_id});
-        pool.GetSchemas().ForEach([&](auto i, const CatalogEntry::SchemaReference& schema_ref) {
-            entries_by_schema.erase({schema_ref.database_name, schema_ref.schema_name, rank, external_id});
-        });
-        entries.erase(external_id);
+        UnregisterDescriptorPool(*iter->second);
         descriptor_pool_entries.erase(iter);
+        ResetSnapshot();
         ++version;
     }
     return buffers::StatusCode::OK;
 }
 
+std::shared_ptr<DescriptorPool> Catalog::CreateDescriptorPool(CatalogEntryID external_id, CatalogEntry::Rank rank) {
+    return std::make_shared<DescriptorPool>(*this, external_id, rank);
+}
+
+buffers::StatusCode Catalog::PublishDescriptorPool(std::shared_ptr<DescriptorPool> pool) {
+    auto lock = LockForModification();
+    auto external_id = pool->GetCatalogEntryId();
+    auto iter = descriptor_pool_entries.find(external_id);
+    if (iter != descriptor_pool_entries.end()) {
+        // Replace the previous version, pinned snapshots keep it alive
+        UnregisterDescriptorPool(*iter->second);
+        descriptor_pool_entries.erase(iter);
+        ResetSnapshot();
+    } else if (entries.contains(external_id)) {
+        return buffers::StatusCode::EXTERNAL_ID_COLLISION;
+    }
+    RegisterDescriptorPool(std::move(pool));
+    ++version;
+    return buffers::StatusCode::OK;
+}
+
+buffers::StatusCode Catalog::AttachDescriptorPool(std::shared_ptr<DescriptorPool> pool) {
+    auto lock = LockForModification();
+    if (!pool->IsFrozen()) {
+        return buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_NOT_FROZEN;
+    }
+    // Shared ids of different owners overlap, all attached shared pools must allocate from the same shared ids.
+    if (pool->IsShared()) {
+        for (auto& [entry_id, attached] : descriptor_pool_entries) {
+            if (attached->IsShared() && entry_id != pool->GetCatalogEntryId() &&
+                attached->GetSharedIds() != pool->GetSharedIds()) {
+                return buffers::StatusCode::CATALOG_ID_OUT_OF_SYNC;
+            }
+        }
+    }
+    // The pool allocated its ids in its shared ids.
+    // The catalog may have allocated a local id for one of its databases or schemas before, see LoadScript.
+    for (auto& [key, ref] : pool->GetDatabasesByName()) {
+        auto iter = databases.find(key);
+        if (iter != databases.end() && iter->second->catalog_database_id != ref.get().catalog_database_id) {
+            return buffers::StatusCode::CATALOG_ID_OUT_OF_SYNC;
+        }
+    }
+    for (auto& [key, ref] : pool->GetSchemasByName()) {
+        auto& schema = ref.get();
+        auto iter = schemas.find(key);
+        if (iter != schemas.end() && (iter->second->catalog_database_id != schema.catalog_database_id ||
+                                      iter->second->catalog_schema_id != schema.catalog_schema_id)) {
+            return buffers::StatusCode::CATALOG_ID_OUT_OF_SYNC;
+        }
+        // Descriptor pools of the catalog don't declare their schemas there, we check their schema entries
+        auto [lb, ub] = FindSchemaEntries(schema.database_name, schema.schema_name);
+        for (auto entry_iter = lb; entry_iter != ub; ++entry_iter) {
+            auto& info = entry_iter->second;
+            if (info.catalog_entry_id != pool->GetCatalogEntryId() &&
+                (info.catalog_database_id != schema.catalog_database_id ||
+                 info.catalog_schema_id != schema.catalog_schema_id)) {
+                return buffers::StatusCode::CATALOG_ID_OUT_OF_SYNC;
+            }
+        }
+    }
+    return PublishDescriptorPool(std::move(pool));
+}
+
+std::shared_ptr<const Catalog::Snapshot> Catalog::Pin(std::optional<CatalogEntryID> ignore) const {
+    auto build = [&]() {
+        auto next = std::make_shared<Snapshot>();
+        next->version = version;
+        next->descriptor_pools.reserve(descriptor_pool_entries.size());
+        for (auto& [external_id, pool] : descriptor_pool_entries) {
+            next->descriptor_pools.push_back(pool);
+        }
+        next->analyzed_scripts.reserve(script_entries.size());
+        for (auto& [script, entry] : script_entries) {
+            if (entry.analyzed && entry.analyzed->GetCatalogEntryId() != ignore) {
+                next->analyzed_scripts.push_back(entry.analyzed);
+            }
+        }
+        return next;
+    };
+    // Loaded scripts that are analyzed again get their own snapshot without the previous version
+    if (ignore.has_value() && entries.contains(*ignore)) {
+        return build();
+    }
+    std::lock_guard<std::mutex> guard{snapshot_latch};
+    if (!snapshot || snapshot->version != version) {
+        snapshot = build();
+    }
+    return snapshot;
+}
+
 buffers::StatusCode Catalog::AddSchemaDescriptor(CatalogEntryID external_id, std::span<const std::byte> descriptor_data,
                                                std::unique_ptr<const std::byte[]> descriptor_buffer,
                                                size_t descriptor_buffer_size) {
+    auto lock = LockForModification();
     auto iter = descriptor_pool_entries.find(external_id);
     if (iter == descriptor_pool_entries.end()) {
         return buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_UNKNOWN;
     }
-    // Add schema descriptor
-    auto& pool = *iter->second;
     auto& schema = *flatbuffers::GetRoot<buffers::SchemaDescriptor>(descriptor_data.data());
     CatalogDatabaseID db_id;
     CatalogSchemaID schema_id;
-    auto status =
-        pool.AddSchemaDescriptor(schema, std::move(descriptor_buffer), descriptor_buffer_size, db_id, schema_id);
+    if (iter->second->IsFrozen()) {
+        return buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_FROZEN;
+    }
+    // Readers that pinned the pool keep reading their version, we add the descriptor to a new version
+    if (IsPinned(iter->second)) {
+        auto next = iter->second->Clone();
+        auto status = next->AddSchemaDescriptor(schema, descriptor_data, std::move(descriptor_buffer),
+                                                descriptor_buffer_size, db_id, schema_id);
+        if (status != buffers::StatusCode::OK) {
+            return status;
+        }
+        return PublishDescriptorPool(std::move(next));
+    }
+    // Add schema descriptor
+    auto& pool = *iter->second;
+    size_t prev_table_count = pool.GetTables().GetSize();
+    auto status = pool.AddSchemaDescriptor(schema, descriptor_data, std::move(descriptor_buffer),
+                                           descriptor_buffer_size, db_id, schema_id);
     if (status != buffers::StatusCode::OK) {
         return status;
     }
@@ -1031,34 +2048,57 @@ buffers::StatusCode Catalog::AddSchemaDescriptor(CatalogEntryID external_id, std
         std::string_view schema_name = schema.schema_name() == nullptr ? "" : schema.schema_name()->string_view();
 
         // Add the entry
-        std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID> entry_key{
-            db_name, schema_name, pool.GetRank(), external_id};
         CatalogSchemaEntryInfo entry{
             .catalog_entry_id = external_id,
             .catalog_database_id = db_id,
             .catalog_schema_id = schema_id,
         };
-        entries_by_schema.insert({entry_key, entry});
+        AddSchemaEntry(db_name, schema_name, pool.GetRank(), entry);
     }
+    // Invalidate all statements that depend on the new tables
+    pool.GetTables().ForEach([&](size_t i, const CatalogEntry::TableDeclaration& table) {
+        if (i >= prev_table_count) {
+            InvalidateTable(table);
+        }
+    });
+    InternNames(pool, prev_table_count);
+    UpdateResolutionCache(pool, prev_table_count);
+    // Index the new names
+    name_index.AddEntryNames(pool, pool.GetRank(), pool.GetNameRegistry());
     ++version;
     return buffers::StatusCode::OK;
 }
 
 buffers::StatusCode Catalog::AddSchemaDescriptors(CatalogEntryID external_id, std::span<const std::byte> descriptor_data,
-                                                std::unique_ptr<const std::byte[]> descriptor_buffer,
-                                                size_t descriptor_buffer_size) {
+                                                DescriptorPool::DescriptorBuffer descriptor_buffer,
+                                                size_t descriptor_buffer_size, size_t worker_count) {
+    auto lock = LockForModification();
     auto iter = descriptor_pool_entries.find(external_id);
     if (iter == descriptor_pool_entries.end()) {
         return buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_UNKNOWN;
     }
 
-    // Add schema descriptor
-    auto& pool = *iter->second;
     auto& descriptor = *flatbuffers::GetRoot<buffers::SchemaDescriptors>(descriptor_data.data());
     CatalogDatabaseID db_id;
     CatalogSchemaID schema_id;
-    auto status =
-        pool.AddSchemaDescriptor(descriptor, std::move(descriptor_buffer), descriptor_buffer_size, db_id, schema_id);
+    if (iter->second->IsFrozen()) {
+        return buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_FROZEN;
+    }
+    // Readers that pinned the pool keep reading their version, we add the descriptors to a new version
+    if (IsPinned(iter->second)) {
+        auto next = iter->second->Clone();
+        auto status = next->AddSchemaDescriptor(descriptor, descriptor_data, std::move(descriptor_buffer),
+                                                descriptor_buffer_size, db_id, schema_id, worker_count);
+        if (status != buffers::StatusCode::OK) {
+            return status;
+        }
+        return PublishDescriptorPool(std::move(next));
+    }
+    // Add schema descriptor
+    auto& pool = *iter->second;
+    size_t prev_table_count = pool.GetTables().GetSize();
+    auto status = pool.AddSchemaDescriptor(descriptor, descriptor_data, std::move(descriptor_buffer),
+                                           descriptor_buffer_size, db_id, schema_id, worker_count);
     if (status != buffers::StatusCode::OK) {
         return status;
     }
@@ -1071,20 +2111,235 @@ buffers::StatusCode Catalog::AddSchemaDescriptors(CatalogEntryID external_id, st
             std::string_view schema_name = schema.schema_name() == nullptr ? "" : schema.schema_name()->string_view();
 
             // Add the entry
-            std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID> entry_key{
-                db_name, schema_name, pool.GetRank(), external_id};
             CatalogSchemaEntryInfo entry{
                 .catalog_entry_id = external_id,
                 .catalog_database_id = db_id,
                 .catalog_schema_id = schema_id,
             };
-            entries_by_schema.insert({entry_key, entry});
+            AddSchemaEntry(db_name, schema_name, pool.GetRank(), entry);
         }
     }
+    // Invalidate all statements that depend on the new tables
+    pool.GetTables().ForEach([&](size_t i, const CatalogEntry::TableDeclaration& table) {
+        if (i >= prev_table_count) {
+            InvalidateTable(table);
+        }
+    });
+    InternNames(pool, prev_table_count);
+    UpdateResolutionCache(pool, prev_table_count);
+    // Index the new names
+    name_index.AddEntryNames(pool, pool.GetRank(), pool.GetNameRegistry());
     ++version;
     return buffers::StatusCode::OK;
 }
 
+buffers::StatusCode Catalog::AddSchemaDescriptorsFile(CatalogEntryID external_id, const std::string& path,
+                                                    size_t worker_count) {
+    auto lock = LockForModification();
+    if (!descriptor_pool_entries.contains(external_id)) {
+        return buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_UNKNOWN;
+    }
+    std::shared_ptr<const MappedFile> mapping = MappedFile::Open(path);
+    if (!mapping) {
+        return buffers::StatusCode::CATALOG_DESCRIPTOR_FILE_UNREADABLE;
+    }
+    // The file is not trusted, verify the buffer before following any offsets
+    auto data = mapping->GetData();
+    flatbuffers::Verifier verifier{reinterpret_cast<const uint8_t*>(data.data()), data.size()};
+    if (!verifier.VerifyBuffer<buffers::SchemaDescriptors>(nullptr)) {
+        return buffers::StatusCode::CATALOG_DESCRIPTOR_INVALID;
+    }
+    // Loading reads the file sequentially, only lookups afterwards are random
+    auto& mapped_file = *mapping;
+    auto status = AddSchemaDescriptors(external_id, data, std::move(mapping), data.size(), worker_count);
+    if (status == buffers::StatusCode::OK) {
+        mapped_file.AdviseRandomAccess();
+    }
+    return status;
+}
+
+buffers::StatusCode Catalog::SaveImage(const std::string& path) {
+    auto catalog_lock = LockShared();
+    flatbuffers::FlatBufferBuilder builder;
+    // Nested buffers keep the alignment of their root
+    auto create_aligned_bytes = [&](std::span<const std::byte> bytes) {
+        builder.ForceVectorAlignment(bytes.size(), sizeof(uint8_t), sizeof(uint64_t));
+        return builder.CreateVector(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    };
+
+    // Write the pools ordered by their external id
+    std::vector<CatalogEntryID> pool_ids;
+    pool_ids.reserve(descriptor_pool_entries.size());
+    for (auto& [external_id, pool] : descriptor_pool_entries) {
+        pool_ids.push_back(external_id);
+    }
+    std::sort(pool_ids.begin(), pool_ids.end());
+
+    std::vector<flatbuffers::Offset<buffers::CatalogImageDescriptorPool>> pool_offsets;
+    for (auto external_id : pool_ids) {
+        auto& pool = *descriptor_pool_entries.at(external_id);
+
+        // Write the schemas with their catalog ids
+        std::vector<flatbuffers::Offset<buffers::CatalogImageSchema>> schema_offsets;
+        pool.GetSchemas().ForEach([&](size_t, const CatalogEntry::SchemaReference& schema) {
+            auto database_name = builder.CreateString(schema.database_name);
+            auto schema_name = builder.CreateString(schema.schema_name);
+            buffers::CatalogImageSchemaBuilder schema_builder{builder};
+            schema_builder.add_database_name(database_name);
+            schema_builder.add_schema_name(schema_name);
+            schema_builder.add_catalog_database_id(schema.catalog_database_id);
+            schema_builder.add_catalog_schema_id(schema.catalog_schema_id);
+            schema_offsets.push_back(schema_builder.Finish());
+        });
+        auto schemas_ofs = builder.CreateVector(schema_offsets);
+
+        // Write the descriptor buffers as they were added
+        std::vector<flatbuffers::Offset<buffers::CatalogImageDescriptor>> descriptor_offsets;
+        for (auto& descriptor : pool.GetDescriptors()) {
+            auto bytes = create_aligned_bytes(descriptor.descriptor_data);
+            buffers::CatalogImageDescriptorBuilder descriptor_builder{builder};
+            if (descriptor.descriptor.index() == 0) {
+                descriptor_builder.add_schema_descriptor(bytes);
+            } else {
+                descriptor_builder.add_schema_descriptors(bytes);
+            }
+            descriptor_offsets.push_back(descriptor_builder.Finish());
+        }
+        auto descriptors_ofs = builder.CreateVector(descriptor_offsets);
+
+        // Write a suffix array over all names, reusing the one of the name search index if it is complete
+        auto& index = pool.GetNameSearchIndex();
+        std::shared_ptr<const CatalogEntry::NameSearchIndex::SharedSuffixArray> suffix_array;
+        if (index.GetSharedSuffixArray() && index.GetDeltaCount() == 0) {
+            suffix_array = index.GetSharedSuffixArray();
+        } else {
+            suffix_array = std::make_shared<CatalogEntry::NameSearchIndex::SharedSuffixArray>(pool.GetNameRegistry());
+        }
+        auto name_search_index_ofs = create_aligned_bytes(suffix_array->GetBuffer());
+
+        buffers::CatalogImageDescriptorPoolBuilder pool_builder{builder};
+        pool_builder.add_catalog_entry_id(external_id);
+        pool_builder.add_rank(pool.GetRank());
+        pool_builder.add_schemas(schemas_ofs);
+        pool_builder.add_descriptors(descriptors_ofs);
+        pool_builder.add_name_search_index(name_search_index_ofs);
+        pool_offsets.push_back(pool_builder.Finish());
+    }
+    auto pools_ofs = builder.CreateVector(pool_offsets);
+    auto default_database_name_ofs = builder.CreateString(default_database_name);
+    auto default_schema_name_ofs = builder.CreateString(default_schema_name);
+
+    buffers::CatalogImageBuilder image_builder{builder};
+    image_builder.add_version(CATALOG_IMAGE_VERSION);
+    image_builder.add_default_database_name(default_database_name_ofs);
+    image_builder.add_default_schema_name(default_schema_name_ofs);
+    image_builder.add_next_database_id(next_database_id);
+    image_builder.add_next_schema_id(next_schema_id);
+    image_builder.add_descriptor_pools(pools_ofs);
+    builder.Finish(image_builder.Finish());
+
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    out.write(reinterpret_cast<const char*>(builder.GetBufferPointer()), builder.GetSize());
+    out.close();
+    return out.fail() ? buffers::StatusCode::CATALOG_IMAGE_IO_FAILED : buffers::StatusCode::OK;
+}
+
+buffers::StatusCode Catalog::LoadImage(const std::string& path, size_t worker_count) {
+    auto lock = LockForModification();
+    if (!entries.empty()) {
+        return buffers::StatusCode::CATALOG_NOT_EMPTY;
+    }
+    std::shared_ptr<const MappedFile> mapping = MappedFile::Open(path);
+    if (!mapping) {
+        return buffers::StatusCode::CATALOG_IMAGE_IO_FAILED;
+    }
+    // Verify the image once, including the nested descriptors, the loaded catalog then points into the mapping
+    auto data = mapping->GetData();
+    flatbuffers::Verifier verifier{reinterpret_cast<const uint8_t*>(data.data()), data.size()};
+    if (!verifier.VerifyBuffer<buffers::CatalogImage>(nullptr)) {
+        return buffers::StatusCode::CATALOG_IMAGE_INVALID;
+    }
+    auto& image = *flatbuffers::GetRoot<buffers::CatalogImage>(data.data());
+    if (image.version() != CATALOG_IMAGE_VERSION) {
+        return buffers::StatusCode::CATALOG_IMAGE_INVALID;
+    }
+    auto string_or_empty = [](const flatbuffers::String* str) { return str ? str->string_view() : ""; };
+    if (string_or_empty(image.default_database_name()) != default_database_name ||
+        string_or_empty(image.default_schema_name()) != default_schema_name) {
+        return buffers::StatusCode::CATALOG_MISMATCH;
+    }
+    auto bytes_of = [](const flatbuffers::Vector<uint8_t>& bytes) {
+        return std::span<const std::byte>{reinterpret_cast<const std::byte*>(bytes.data()), bytes.size()};
+    };
+
+    // Load the descriptor pools, dropping the loaded pools again if the image turns out to be inconsistent
+    std::vector<CatalogEntryID> loaded_pools;
+    auto fail = [&](buffers::StatusCode status) {
+        for (auto external_id : loaded_pools) {
+            DropDescriptorPool(external_id);
+        }
+        return status;
+    };
+    if (auto* pools = image.descriptor_pools()) {
+        for (auto* pool_image : *pools) {
+            auto external_id = pool_image->catalog_entry_id();
+            if (entries.contains(external_id)) {
+                return fail(buffers::StatusCode::EXTERNAL_ID_COLLISION);
+            }
+            // Fill the pool before publishing it.
+            // The merged name index of the catalog then uses the persisted suffix array instead of building a new one.
+            auto pool = CreateDescriptorPool(external_id, pool_image->rank());
+
+            // Declare the schemas with their previous catalog ids
+            if (auto* schemas = pool_image->schemas()) {
+                for (auto* schema : *schemas) {
+                    pool->DeclareSchema(string_or_empty(schema->database_name()), schema->catalog_database_id(),
+                                        string_or_empty(schema->schema_name()), schema->catalog_schema_id());
+                }
+            }
+            // Add the descriptors in place
+            if (auto* descriptors = pool_image->descriptors()) {
+                for (auto* descriptor : *descriptors) {
+                    buffers::StatusCode status;
+                    CatalogDatabaseID db_id;
+                    CatalogSchemaID schema_id;
+                    if (auto* single = descriptor->schema_descriptor()) {
+                        auto& root = *flatbuffers::GetRoot<buffers::SchemaDescriptor>(single->data());
+                        status = pool->AddSchemaDescriptor(root, bytes_of(*single), mapping, single->size(), db_id,
+                                                           schema_id);
+                    } else if (auto* multiple = descriptor->schema_descriptors()) {
+                        auto& root = *flatbuffers::GetRoot<buffers::SchemaDescriptors>(multiple->data());
+                        status = pool->AddSchemaDescriptor(root, bytes_of(*multiple), mapping, multiple->size(), db_id,
+                                                           schema_id, worker_count);
+                    } else {
+                        status = buffers::StatusCode::CATALOG_IMAGE_INVALID;
+                    }
+                    if (status != buffers::StatusCode::OK) {
+                        return fail(status);
+                    }
+                }
+            }
+            // Use the persisted suffix array as name search index
+            if (auto* bytes = pool_image->name_search_index()) {
+                auto suffix_array = SuffixArray::Open(bytes_of(*bytes));
+                if (!suffix_array.has_value() ||
+                    !pool->RestoreNameSearchIndex(
+                        std::make_shared<CatalogEntry::NameSearchIndex::SharedSuffixArray>(*suffix_array, mapping))) {
+                    return fail(buffers::StatusCode::CATALOG_IMAGE_INVALID);
+                }
+            }
+            if (auto status = PublishDescriptorPool(std::move(pool)); status != buffers::StatusCode::OK) {
+                return fail(status);
+            }
+            loaded_pools.push_back(external_id);
+        }
+    }
+    // Restore the id allocators
+    next_database_id = std::max(next_database_id.load(), image.next_database_id());
+    next_schema_id = std::max(next_schema_id.load(), image.next_schema_id());
+    return buffers::StatusCode::OK;
+}
+
 const CatalogEntry::TableDeclaration* Catalog::ResolveTable(ContextObjectID table_id) const {
     if (auto iter = entries.find(table_id.GetContext()); iter != entries.end()) {
         return iter->second->ResolveTable(table_id);
@@ -1092,35 +2347,212 @@ const CatalogEntry::TableDeclaration* Catalog::ResolveTable(ContextObjectID tabl
         return nullptr;
     }
 }
-const CatalogEntry::TableDeclaration* Catalog::ResolveTable(CatalogEntry::QualifiedTableName table_name,
-                                                            CatalogEntryID ignore_entry) const {
-    for (auto iter = entries_by_schema.lower_bound(
-             {table_name.database_name.get().text, table_name.schema_name.get().text, 0, 0});
-         iter != entries_by_schema.end(); ++iter) {
-        auto& [db_name, schema_name, rank, candidate] = iter->first;
-        if (db_name != table_name.database_name.get().text || schema_name != table_name.schema_name.get().text) {
-            break;
-        }
+const CatalogEntry::TableDeclaration* Catalog::ResolveTableUncached(
+    const CatalogEntry::QualifiedTableName::Key& table_name, std::optional<CatalogEntryID> ignore_entry) const {
+    auto& [db_name, schema_name, table] = table_name;
+    auto [lb, ub] = FindSchemaEntries(db_name, schema_name);
+    // Skip entries that don't declare the table name
+    auto table_hash = BloomFilter::HashFolded(table, CatalogEntry::NAME_FILTER_TABLE_SEED);
+    for (auto iter = lb; iter != ub; ++iter) {
+        auto& [db_name_id, schema_name_id, rank, candidate] = iter->first;
         if (candidate == ignore_entry) {
             continue;
         }
         assert(entries.contains(candidate));
         auto& schema = entries.at(candidate);
-        if (auto resolved = schema->ResolveTable(table_name)) {
-            return resolved;
+        if (!schema->MayContainTable(table_hash)) {
+            resolution_statistics.table_filter_skips.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        auto& tables_by_name = schema->GetTablesByName();
+        if (auto resolved = tables_by_name.find(table_name); resolved != tables_by_name.end()) {
+            return &resolved->second.get();
         }
     };
     return nullptr;
 }
 
+const CatalogEntry::TableDeclaration* Catalog::ResolveTable(CatalogEntry::QualifiedTableName table_name,
+                                                            CatalogEntryID ignore_entry) const {
+    resolution_statistics.table_lookups.fetch_add(1, std::memory_order_relaxed);
+
+    // The cache holds the resolutions of all tables that are declared by any catalog entry.
+    // If any of the names is unknown or the table is not cached, no entry declares the table.
+    std::optional<CatalogEntryID> resolved_entry;
+    auto db_name_id = name_interner.Find(table_name.database_name.get().text);
+    auto schema_name_id = name_interner.Find(table_name.schema_name.get().text);
+    auto table_name_id = name_interner.Find(table_name.table_name.get().text);
+    if (db_name_id.has_value() && schema_name_id.has_value() && table_name_id.has_value()) {
+        if (auto schema_iter = resolution_cache.find(NameInterner::Pack(*db_name_id, *schema_name_id));
+            schema_iter != resolution_cache.end()) {
+            auto& entries_by_table = schema_iter->second.entries_by_table;
+            if (auto table_iter = entries_by_table.find(*table_name_id); table_iter != entries_by_table.end()) {
+                resolved_entry = table_iter->second;
+            }
+        }
+    }
+    if (!resolved_entry.has_value()) {
+        resolution_statistics.table_cache_hits.fetch_add(1, std::memory_order_relaxed);
+        resolution_statistics.table_cache_negative_hits.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // If the table is declared by an entry with a higher priority, ignoring another entry won't change that.
+    // Only if the table is declared by the ignored entry, we have to search for the next one.
+    if (*resolved_entry == ignore_entry) {
+        return ResolveTableUncached(table_name, ignore_entry);
+    }
+    resolution_statistics.table_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    assert(entries.contains(*resolved_entry));
+    return entries.at(*resolved_entry)->ResolveTable(table_name);
+}
+
+void Catalog::UpdateResolutionCache(const CatalogEntry::QualifiedTableName::Key& table_name) {
+    auto& [db_name, schema_name, table] = table_name;
+    auto db_name_id = name_interner.Find(db_name);
+    auto schema_name_id = name_interner.Find(schema_name);
+    auto table_name_id = name_interner.Find(table);
+    if (!db_name_id.has_value() || !schema_name_id.has_value() || !table_name_id.has_value()) {
+        return;
+    }
+    auto schema_key = NameInterner::Pack(*db_name_id, *schema_name_id);
+    auto* resolved = ResolveTableUncached(table_name, std::nullopt);
+
+    // No entry declares the table (anymore), evict the resolution
+    if (resolved == nullptr) {
+        auto schema_iter = resolution_cache.find(schema_key);
+        if (schema_iter == resolution_cache.end()) {
+            return;
+        }
+        if (schema_iter->second.entries_by_table.erase(*table_name_id) > 0) {
+            resolution_statistics.table_cache_invalidations.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (schema_iter->second.entries_by_table.empty()) {
+            resolution_cache.erase(schema_iter);
+        }
+        return;
+    }
+    // Remember the entry that declares the table
+    auto resolved_entry = resolved->catalog_table_id.GetContext();
+    auto& entries_by_table = resolution_cache[schema_key].entries_by_table;
+    auto [table_iter, inserted] = entries_by_table.try_emplace(*table_name_id, resolved_entry);
+    if (!inserted && table_iter->second != resolved_entry) {
+        table_iter->second = resolved_entry;
+        resolution_statistics.table_cache_invalidations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Catalog::UpdateResolutionCache(const CatalogEntry& entry, size_t first_table) {
+    auto& tables = entry.GetTables();
+    tables.ForEachIn(first_table, tables.GetSize() - first_table,
+                     [&](size_t i, const CatalogEntry::TableDeclaration& table) {
+                         auto& name = table.table_name;
+                         UpdateResolutionCache(
+                             {name.database_name.get().text, name.schema_name.get().text, name.table_name.get().text});
+                     });
+}
+
+void Catalog::InternNames(const CatalogEntry& entry, size_t first_table) {
+    auto& tables = entry.GetTables();
+    tables.ForEachIn(first_table, tables.GetSize() - first_table,
+                     [&](size_t i, const CatalogEntry::TableDeclaration& table) {
+                         auto& name = table.table_name;
+                         for (auto& part : {name.database_name, name.schema_name, name.table_name}) {
+                             auto text = part.get().text;
+                             name_interner.Intern(text, entry.GetNameOwner(text));
+                         }
+                     });
+}
+
+/// Release the name of a catalog entry that is still interned
+static void releaseName(NameInterner& interner, std::string_view name) {
+    auto name_id = interner.Find(name);
+    assert(name_id.has_value());
+    if (name_id.has_value()) {
+        interner.Release(*name_id);
+    }
+}
+
+void Catalog::ReleaseNames(const CatalogEntry& entry) {
+    entry.GetTables().ForEach([&](size_t i, const CatalogEntry::TableDeclaration& table) {
+        auto& name = table.table_name;
+        releaseName(name_interner, name.database_name.get().text);
+        releaseName(name_interner, name.schema_name.get().text);
+        releaseName(name_interner, name.table_name.get().text);
+    });
+}
+
+void Catalog::AddSchemaEntry(std::string_view database_name, std::string_view schema_name, CatalogEntry::Rank rank,
+                             CatalogSchemaEntryInfo info) {
+    SchemaEntryKey key{name_interner.Intern(database_name), name_interner.Intern(schema_name), rank,
+                       info.catalog_entry_id};
+    // Every key holds one reference to its names
+    if (!entries_by_schema.insert({key, info}).second) {
+        name_interner.Release(std::get<0>(key));
+        name_interner.Release(std::get<1>(key));
+    }
+}
+
+void Catalog::RemoveSchemaEntry(std::string_view database_name, std::string_view schema_name,
+                                CatalogEntry::Rank rank, CatalogEntryID entry_id) {
+    auto db_name_id = name_interner.Find(database_name);
+    auto schema_name_id = name_interner.Find(schema_name);
+    if (!db_name_id.has_value() || !schema_name_id.has_value()) {
+        return;
+    }
+    if (entries_by_schema.erase({*db_name_id, *schema_name_id, rank, entry_id}) > 0) {
+        name_interner.Release(*db_name_id);
+        name_interner.Release(*schema_name_id);
+    }
+}
+
+std::pair<btree::map<Catalog::SchemaEntryKey, Catalog::CatalogSchemaEntryInfo>::const_iterator,
+          btree::map<Catalog::SchemaEntryKey, Catalog::CatalogSchemaEntryInfo>::const_iterator>
+Catalog::FindSchemaEntries(std::string_view database_name, std::string_view schema_name) const {
+    auto db_name_id = name_interner.Find(database_name);
+    auto schema_name_id = name_interner.Find(schema_name);
+    if (!db_name_id.has_value() || !schema_name_id.has_value()) {
+        return {entries_by_schema.end(), entries_by_schema.end()};
+    }
+    auto lb = entries_by_schema.lower_bound({*db_name_id, *schema_name_id, 0, 0});
+    auto ub = entries_by_schema.upper_bound({*db_name_id, *schema_name_id,
+                                             std::numeric_limits<CatalogEntry::Rank>::max(),
+                                             std::numeric_limits<CatalogEntryID>::max()});
+    return {lb, ub};
+}
+
+std::optional<CatalogDatabaseID> Catalog::FindSharedDatabaseId(std::string_view database) const {
+    // Only shared pools that are attached to this catalog determine its shared ids
+    for (auto& [entry_id, pool] : descriptor_pool_entries) {
+        if (!pool->IsShared()) {
+            continue;
+        }
+        auto& databases_by_name = pool->GetDatabasesByName();
+        if (auto iter = databases_by_name.find(database); iter != databases_by_name.end()) {
+            return iter->second.get().catalog_database_id;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<CatalogSchemaID> Catalog::FindSharedSchemaId(std::string_view database, std::string_view schema) const {
+    for (auto& [entry_id, pool] : descriptor_pool_entries) {
+        if (!pool->IsShared()) {
+            continue;
+        }
+        auto& schemas_by_name = pool->GetSchemasByName();
+        if (auto iter = schemas_by_name.find({database, schema}); iter != schemas_by_name.end()) {
+            return iter->second.get().catalog_schema_id;
+        }
+    }
+    return std::nullopt;
+}
+
 /// Resolve all schema tables
 void Catalog::ResolveSchemaTables(
     std::string_view database_name, std::string_view schema_name,
     std::vector<std::reference_wrapper<const CatalogEntry::TableDeclaration>>& out) const {
-    auto entries_lb = entries_by_schema.lower_bound({database_name, schema_name, 0, 0});
-    auto entries_ub =
-        entries_by_schema.upper_bound({database_name, schema_name, std::numeric_limits<CatalogEntry::Rank>::max(),
-                                       std::numeric_limits<CatalogEntryID>::max()});
+    auto [entries_lb, entries_ub] = FindSchemaEntries(database_name, schema_name);
     for (auto entry_iter = entries_lb; entry_iter != entries_ub; ++entry_iter) {
         CatalogEntryID entry_id = entry_iter->second.catalog_entry_id;
         CatalogEntry* entry = entries.at(entry_id);
@@ -1137,8 +2569,215 @@ void Catalog::ResolveSchemaTables(
     }
 }
 
+void Catalog::InvalidateTable(const CatalogEntry::QualifiedTableName::Key& table_name) {
+    for (auto iter = table_dependents.lower_bound(table_name);
+         iter != table_dependents.end() && iter->first == table_name; ++iter) {
+        outdated_statements[iter->second.catalog_entry_id].insert(iter->second.ast_statement_id);
+    }
+    // Resolve the table again when flattening the catalog the next time
+    if (!flat_catalog.all_tables_dirty) {
+        auto& [db_name, schema_name, table] = table_name;
+        flat_catalog.dirty_tables.insert({InternFlatName(db_name), InternFlatName(schema_name), InternFlatName(table)});
+    }
+}
+
+void Catalog::InvalidateTable(const CatalogEntry::TableDeclaration& table) {
+    auto& name = table.table_name;
+    InvalidateTable({name.database_name.get().text, name.schema_name.get().text, name.table_name.get().text});
+    for (auto& column : table.table_columns) {
+        InvalidateColumnName(column.column_name.get().text);
+    }
+}
+
+void Catalog::InvalidateSchema(std::string_view database_name, std::string_view schema_name) {
+    std::pair<std::string_view, std::string_view> key{database_name, schema_name};
+    for (auto iter = schema_dependents.lower_bound(key); iter != schema_dependents.end() && iter->first == key;
+         ++iter) {
+        outdated_statements[iter->second.catalog_entry_id].insert(iter->second.ast_statement_id);
+    }
+}
+
+void Catalog::InvalidateColumnName(std::string_view column_name) {
+    auto [begin, end] = column_dependents.equal_range(column_name);
+    for (auto iter = begin; iter != end; ++iter) {
+        outdated_statements[iter->second.catalog_entry_id].insert(iter->second.ast_statement_id);
+    }
+}
+
+Catalog::TableDelta Catalog::DiffTables(const AnalyzedScript& prev, const AnalyzedScript& next) {
+    auto same_columns = [](const CatalogEntry::TableDeclaration& l, const CatalogEntry::TableDeclaration& r) {
+        if (l.table_columns.size() != r.table_columns.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < l.table_columns.size(); ++i) {
+            if (l.table_columns[i].column_name.get().text != r.table_columns[i].column_name.get().text) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // Tables with the same name are unchanged if they kept their id and their columns.
+    // Dependents hold table ids, a moved table therefore counts as changed.
+    TableDelta delta;
+    auto& prev_tables = prev.tables_by_name;
+    auto& next_tables = next.tables_by_name;
+    for (auto& [key, prev_table] : prev_tables) {
+        auto next_iter = next_tables.find(key);
+        if (next_iter == next_tables.end()) {
+            InvalidateTable(prev_table.get());
+            delta.removed_tables.push_back(prev_table.get().catalog_table_id);
+        } else if (prev_table.get().catalog_table_id.GetObject() !=
+                       next_iter->second.get().catalog_table_id.GetObject() ||
+                   !same_columns(prev_table.get(), next_iter->second.get())) {
+            InvalidateTable(prev_table.get());
+            InvalidateTable(next_iter->second.get());
+            delta.changed_tables.push_back(next_iter->second.get().catalog_table_id);
+        }
+    }
+    for (auto& [key, next_table] : next_tables) {
+        if (!prev_tables.contains(key)) {
+            InvalidateTable(next_table.get());
+            delta.added_tables.push_back(next_table.get().catalog_table_id);
+        }
+    }
+    return delta;
+}
+
+void Catalog::RetireScript(const Script& script, std::shared_ptr<AnalyzedScript> analyzed) {
+    if (!analyzed) {
+        return;
+    }
+    // Dependents that were analyzed before still point into the retired script.
+    // They pinned a snapshot that holds the script, the script is released with the last of these snapshots.
+    //
+    // A replaced script is no longer read as a whole, only its declarations are.
+    // We therefore release the snapshot that it pinned, otherwise every retired version would keep the version
+    // before alive and edits would build an unbounded chain of old scripts.
+    // A dropped script may still be the current analysis of its script and keeps its snapshot.
+    if (script.analyzed_script != analyzed) {
+        analyzed->catalog_snapshot.reset();
+    }
+    // Don't keep the retired script alive through the cached snapshot of a previous version
+    ResetSnapshot();
+}
+
+void Catalog::ResetSnapshot() {
+    std::lock_guard<std::mutex> guard{snapshot_latch};
+    snapshot.reset();
+}
+
+bool Catalog::IsPinned(const std::shared_ptr<DescriptorPool>& pool) {
+    // The cached snapshot holds the pool as well
+    ResetSnapshot();
+    // Writers hold the latch exclusively, readers can therefore only release the pool concurrently but not pin it
+    return pool.use_count() > 1;
+}
+
+/// Visit the resolved table and column references of an analyzed script
+template <typename Fn> static void forEachObjectReference(AnalyzedScript& analyzed, Fn fn) {
+    auto external_id = analyzed.GetCatalogEntryId();
+    analyzed.table_references.ForEach([&](size_t ref_id, AnalyzedScript::TableReference& ref) {
+        auto* resolved = std::get_if<AnalyzedScript::TableReference::ResolvedRelationExpression>(&ref.inner);
+        if (resolved && ref.location.has_value()) {
+            fn(Catalog::ObjectReferenceKey{.table_id = resolved->catalog_table_id},
+               Catalog::ObjectReference{.catalog_entry_id = external_id,
+                                        .reference_id = static_cast<uint32_t>(ref_id),
+                                        .location = *ref.location});
+        }
+    });
+    analyzed.expressions.ForEach([&](size_t expr_id, AnalyzedScript::Expression& expr) {
+        auto* resolved = std::get_if<AnalyzedScript::Expression::ResolvedColumnRef>(&expr.inner);
+        if (resolved && expr.location.has_value()) {
+            fn(Catalog::ObjectReferenceKey{.table_id = resolved->catalog_table_id,
+                                           .column_id = resolved->table_column_id},
+               Catalog::ObjectReference{.catalog_entry_id = external_id,
+                                        .reference_id = static_cast<uint32_t>(expr_id),
+                                        .location = *expr.location});
+        }
+    });
+}
+
+void Catalog::RegisterDependencies(std::shared_ptr<AnalyzedScript> analyzed) {
+    assert(latch.IsHeldExclusively());
+    auto external_id = analyzed->GetCatalogEntryId();
+    UnregisterDependencies(external_id);
+
+    // Register the table and schema dependencies
+    for (auto& [statement_id, table_name] : analyzed->table_dependencies) {
+        DependentStatement dependent{.catalog_entry_id = external_id, .ast_statement_id = statement_id};
+        auto& [db_name, schema_name, _table_name] = table_name;
+        table_dependents.insert({table_name, dependent});
+        schema_dependents.insert({{db_name, schema_name}, dependent});
+    }
+    // Register the unresolved column names
+    for (auto& unresolved : analyzed->unresolved_column_names) {
+        DependentStatement dependent{.catalog_entry_id = external_id, .ast_statement_id = unresolved.ast_statement_id};
+        column_dependents.insert({unresolved.column_name.get().text, dependent});
+    }
+    // Register the references of tables and columns
+    forEachObjectReference(*analyzed, [&](const ObjectReferenceKey& key, const ObjectReference& ref) {
+        object_references[key].push_back(ref);
+    });
+    dependency_owners.insert({external_id, std::move(analyzed)});
+}
+
+void Catalog::UnregisterDependencies(CatalogEntryID external_id) {
+    assert(latch.IsHeldExclusively());
+    outdated_statements.erase(external_id);
+    auto owner_iter = dependency_owners.find(external_id);
+    if (owner_iter == dependency_owners.end()) {
+        return;
+    }
+    auto& analyzed = *owner_iter->second;
+
+    // Erase all dependents of the script with the given keys
+    auto erase_dependents = [&](auto& index, auto& key) {
+        for (auto iter = index.lower_bound(key); iter != index.end() && iter->first == key;) {
+            if (iter->second.catalog_entry_id == external_id) {
+                iter = index.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    };
+    for (auto& [statement_id, table_name] : analyzed.table_dependencies) {
+        auto& [db_name, schema_name, _table_name] = table_name;
+        std::pair<std::string_view, std::string_view> schema_key{db_name, schema_name};
+        erase_dependents(table_dependents, table_name);
+        erase_dependents(schema_dependents, schema_key);
+    }
+    for (auto& unresolved : analyzed.unresolved_column_names) {
+        auto [begin, end] = column_dependents.equal_range(unresolved.column_name.get().text);
+        for (auto iter = begin; iter != end;) {
+            if (iter->second.catalog_entry_id == external_id) {
+                iter = column_dependents.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+    // Erase the references of tables and columns.
+    // A script references the same object many times, we only filter the reference list once.
+    ankerl::unordered_dense::set<ObjectReferenceKey, ObjectReferenceKey::Hasher> filtered_keys;
+    forEachObjectReference(analyzed, [&](const ObjectReferenceKey& key, const ObjectReference&) {
+        if (!filtered_keys.insert(key).second) {
+            return;
+        }
+        auto iter = object_references.find(key);
+        if (iter == object_references.end()) {
+            return;
+        }
+        std::erase_if(iter->second, [&](const ObjectReference& ref) { return ref.catalog_entry_id == external_id; });
+        if (iter->second.empty()) {
+            object_references.erase(iter);
+        }
+    });
+    dependency_owners.erase(owner_iter);
+}
+
 /// Get statisics
 std::unique_ptr<buffers::CatalogStatisticsT> Catalog::GetStatistics() {
+    auto catalog_lock = LockShared();
     auto stats = std::make_unique<buffers::CatalogStatisticsT>();
     buffers::CatalogContentStatistics totals;
 
@@ -1163,9 +2802,11 @@ std::unique_ptr<buffers::CatalogStatisticsT> Catalog::GetStatistics() {
 
         entry_mem->mutate_descriptor_buffer_count(descriptors.size());
         entry_mem->mutate_descriptor_buffer_bytes(descriptor_bytes);
-        entry_mem->mutate_name_search_index_entries(name_index.size());
+        entry_mem->mutate_name_search_index_entries(name_index.GetEntryCount());
+        entry_mem->mutate_name_search_index_bytes(name_index.GetByteSize());
         entry_mem->mutate_name_registry_size(name_registry.GetSize());
         entry_mem->mutate_name_registry_bytes(name_registry.GetByteSize());
+        entry_mem->mutate_name_filter_bytes(entry->GetNameFilter().GetByteSize());
         entry_stats->memory = std::move(entry_mem);
 
         auto& dbs = entry->GetDatabases();
@@ -1193,5 +2834,24 @@ std::unique_ptr<buffers::CatalogStatisticsT> Catalog::GetStatistics() {
     content->mutate_table_column_count(total_columns);
     stats->content = std::move(content);
 
+    size_t cached_tables = 0;
+    for (auto& [schema_key, schema_cache] : resolution_cache) {
+        cached_tables += schema_cache.entries_by_table.size();
+    }
+    auto resolution = std::make_unique<buffers::CatalogResolutionStatistics>();
+    resolution->mutate_table_lookups(resolution_statistics.table_lookups.load(std::memory_order_relaxed));
+    resolution->mutate_table_cache_hits(resolution_statistics.table_cache_hits.load(std::memory_order_relaxed));
+    resolution->mutate_table_cache_negative_hits(
+        resolution_statistics.table_cache_negative_hits.load(std::memory_order_relaxed));
+    resolution->mutate_table_cache_invalidations(
+        resolution_statistics.table_cache_invalidations.load(std::memory_order_relaxed));
+    resolution->mutate_table_filter_skips(resolution_statistics.table_filter_skips.load(std::memory_order_relaxed));
+    resolution->mutate_table_cache_entries(cached_tables);
+    stats->resolution = std::move(resolution);
+    stats->name_index_names = name_index.GetNameCount();
+    stats->name_index_suffixes = name_index.GetSuffixCount();
+    stats->interned_names = name_interner.GetSize();
+    stats->interned_name_bytes = name_interner.GetByteSize();
+
     return stats;
 }
@@ -0,0 +1,211 @@
+#include "dashql/catalog_name_index.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <string>
+#include <tuple>
+
+#include "dashql/catalog.h"
+#include "dashql/text/prefix_edit_distance.h"
+
+namespace dashql {
+
+void CatalogNameIndex::AddEntryNames(CatalogEntry& entry, uint32_t rank, const NameRegistry& names) {
+    auto entry_id = entry.GetCatalogEntryId();
+    auto [indexed_iter, indexed_new] = entries.try_emplace(entry_id, IndexedEntry{.entry = &entry, .rank = rank});
+    auto& indexed = indexed_iter->second;
+    if (indexed_new) {
+        entries_ranked.insert({rank, entry_id});
+    }
+    auto& entry_names = indexed.names;
+    size_t name_index = 0;
+    for (auto& chunk : names.GetChunks()) {
+        for (auto& name : chunk) {
+            // Skip names that we indexed before
+            if (name_index++ < entry_names.size()) {
+                continue;
+            }
+            auto name_id = name_interner.Intern(name.text, entry.GetNameOwner(name.text));
+            entry_names.push_back(name_id);
+            if (name.text.empty()) {
+                continue;
+            }
+            // Remember the text when we see the name for the first time
+            auto [postings_iter, inserted] = postings_by_name.try_emplace(name_id);
+            auto& postings = postings_iter->second;
+            if (inserted) {
+                postings.text = name_interner.Get(name_id);
+                names_by_text.insert({fuzzy_ci_string_view{postings.text.data(), postings.text.size()}, name_id});
+            }
+            // Insert the posting ordered by <rank, entry id>
+            Posting posting{.catalog_entry_id = entry_id, .rank = rank, .name = &name};
+            auto pos = std::upper_bound(postings.postings.begin(), postings.postings.end(), posting,
+                                        [](const Posting& l, const Posting& r) {
+                                            return std::tie(l.rank, l.catalog_entry_id) <
+                                                   std::tie(r.rank, r.catalog_entry_id);
+                                        });
+            postings.postings.insert(pos, posting);
+        }
+    }
+    // Build the name search index now, scans only read it
+    entry.GetNameSearchIndex();
+}
+
+void CatalogNameIndex::RemoveEntry(CatalogEntryID entry_id) {
+    auto entry_iter = entries.find(entry_id);
+    if (entry_iter == entries.end()) {
+        return;
+    }
+    for (auto name_id : entry_iter->second.names) {
+        auto postings_iter = postings_by_name.find(name_id);
+        if (postings_iter != postings_by_name.end()) {
+            auto& postings = postings_iter->second.postings;
+            std::erase_if(postings, [&](const Posting& p) { return p.catalog_entry_id == entry_id; });
+            if (postings.empty()) {
+                // Drop names without postings
+                auto text_view = postings_iter->second.text;
+                auto [begin, end] = names_by_text.equal_range(fuzzy_ci_string_view{text_view.data(), text_view.size()});
+                for (auto iter = begin; iter != end; ++iter) {
+                    if (iter->second == name_id) {
+                        names_by_text.erase(iter);
+                        break;
+                    }
+                }
+                postings_by_name.erase(postings_iter);
+            }
+        }
+        // Every indexed name of the entry holds a reference
+        name_interner.Release(name_id);
+    }
+    entries_ranked.erase({entry_iter->second.rank, entry_id});
+    entries.erase(entry_iter);
+}
+
+void CatalogNameIndex::Clear() {
+    // Release the references of all entries
+    for (auto& [entry_id, indexed] : entries) {
+        for (auto name_id : indexed.names) {
+            name_interner.Release(name_id);
+        }
+    }
+    postings_by_name.clear();
+    names_by_text.clear();
+    entries.clear();
+    entries_ranked.clear();
+}
+
+size_t CatalogNameIndex::GetSuffixCount() const {
+    size_t count = 0;
+    for (auto& [entry_id, indexed] : entries) {
+        count += indexed.entry->GetNameSearchIndex().GetEntryCount();
+    }
+    return count;
+}
+
+void CatalogNameIndex::IteratePrefix(fuzzy_ci_string_view prefix, PrefixCallback callback, void* ctx) const {
+    bool stopped = false;
+    for (auto& [rank, entry_id] : entries_ranked) {
+        auto& indexed = entries.find(entry_id)->second;
+        indexed.entry->GetNameSearchIndex().IteratePrefix(prefix, [&](const RegisteredName& name) {
+            if (stopped) {
+                return;
+            }
+            // Map the name of the entry to its postings
+            auto name_id = name_interner.Find(name.text);
+            assert(name_id.has_value());
+            auto postings_iter = postings_by_name.find(*name_id);
+            assert(postings_iter != postings_by_name.end());
+            auto& postings = postings_iter->second;
+            auto posting = std::lower_bound(postings.postings.begin(), postings.postings.end(),
+                                            std::make_tuple(rank, entry_id), [](const Posting& p, auto& key) {
+                                                return std::tie(p.rank, p.catalog_entry_id) < key;
+                                            });
+            assert(posting != postings.postings.end() && posting->catalog_entry_id == entry_id);
+            stopped = !callback(ctx, postings, *posting);
+        });
+        if (stopped) {
+            break;
+        }
+    }
+}
+
+/// Get the smallest lowercase text that is larger than all texts starting with a prefix.
+/// Returns false if there is no such text.
+static bool getPrefixSuccessor(std::string& prefix) {
+    while (!prefix.empty()) {
+        auto c = static_cast<unsigned char>(prefix.back());
+        if (c == std::numeric_limits<unsigned char>::max()) {
+            prefix.pop_back();
+            continue;
+        }
+        // Uppercase letters compare as lowercase, the next distinct character after '@' is '['
+        ++c;
+        if (c >= 'A' && c <= 'Z') {
+            c = 'Z' + 1;
+        }
+        prefix.back() = static_cast<char>(c);
+        return true;
+    }
+    return false;
+}
+
+void CatalogNameIndex::FindFuzzyPrefixMatches(fuzzy_ci_string_view query, uint32_t max_distance,
+                                              std::vector<FuzzyMatch>& out) const {
+    PrefixEditDistance automaton{{query.data(), query.size()}, max_distance};
+    std::string seek_key;
+
+    // Typos in the first character are rare and would let short prefixes match almost every name.
+    // We therefore only walk the names that start with the first character of the query.
+    if (query.empty()) {
+        return;
+    }
+    std::string first_char{static_cast<char>(tolower_fuzzy(query[0]))};
+    auto iter = names_by_text.lower_bound(fuzzy_ci_string_view{first_char.data(), first_char.size()});
+    auto end = names_by_text.end();
+    if (getPrefixSuccessor(first_char)) {
+        end = names_by_text.lower_bound(fuzzy_ci_string_view{first_char.data(), first_char.size()});
+    }
+    while (iter != end) {
+        auto text = iter->first;
+
+        // Reuse the rows of the common prefix with the last name.
+        // The automaton remembers the best distance of the shared prefixes, a longer prefix may still be closer.
+        size_t common = 0;
+        size_t common_limit = std::min<size_t>(text.size(), automaton.GetDepth());
+        while (common < common_limit && tolower_fuzzy(text[common]) == automaton.GetChar(common)) {
+            ++common;
+        }
+        automaton.Truncate(common);
+
+        // Extend the prefix as long as a longer prefix can improve the distance
+        for (size_t i = common; i < text.size(); ++i) {
+            if (automaton.GetRowMinimum() >= std::min(max_distance + 1, automaton.GetBestDistance())) {
+                break;
+            }
+            automaton.Push(text[i]);
+        }
+        auto best = automaton.GetBestDistance();
+        if (best <= max_distance) {
+            auto postings_iter = postings_by_name.find(iter->second);
+            assert(postings_iter != postings_by_name.end());
+            out.push_back(FuzzyMatch{.postings = postings_iter->second, .distance = best});
+            ++iter;
+            continue;
+        }
+        if (automaton.CanMatch()) {
+            ++iter;
+            continue;
+        }
+
+        // Skip all names that share the hopeless prefix
+        seek_key = automaton.GetPrefix();
+        if (!getPrefixSuccessor(seek_key)) {
+            break;
+        }
+        // The successor never exceeds the successor of the first character, the seek cannot overshoot the end
+        iter = names_by_text.lower_bound(fuzzy_ci_string_view{seek_key.data(), seek_key.size()});
+    }
+}
+
+}  // namespace dashql
@@ -406,13 +406,13 @@ AnalyzedScript::AnalyzedScript(std::shared_ptr<ParsedScript> parsed, Catalog& ca
       default_database_name(parsed->scanned_script->name_registry.Register(catalog.GetDefaultDatabaseName())),
       default_schema_name(parsed->scanned_script->name_registry.Register(catalog.GetDefaultSchemaName())),
       parsed_script(std::move(parsed)),
-      catalog_version(catalog.GetVersion()) {}
+      catalog_version(catalog.GetVersion()),
+      catalog_snapshot(catalog.Pin(parsed_script->external_id)) {}
 
 /// Get the name search index
 flatbuffers::Offset<buffers::CatalogEntry> AnalyzedScript::DescribeEntry(flatbuffers::FlatBufferBuilder& builder) const {
     std::vector<flatbuffers::Offset<buffers::SchemaTable>> table_offsets;
     table_offsets.reserve(table_declarations.GetSize());
-    uint32_t table_id = 0;
     for (auto& table_chunk : table_declarations.GetChunks()) {
         for (auto& table : table_chunk) {
             auto table_name = builder.CreateString(table.table_name.table_name.get().text);
@@ -428,7 +428,7 @@ flatbuffers::Offset<buffers::CatalogEntry> AnalyzedScript::DescribeEntry(flatbuf
             auto columns_offset = builder.CreateVector(column_offsets);
 
             buffers::SchemaTableBuilder table_builder{builder};
-            table_builder.add_table_id(table_id++);
+            table_builder.add_table_id(table.catalog_table_id.GetObject());
             table_builder.add_table_name(table_name);
             table_builder.add_columns(columns_offset);
         }
@@ -451,22 +451,28 @@ flatbuffers::Offset<buffers::CatalogEntry> AnalyzedScript::DescribeEntry(flatbuf
 
 /// Get the name search index
 const CatalogEntry::NameSearchIndex& AnalyzedScript::GetNameSearchIndex() {
+    auto& name_registry = parsed_script->scanned_script->name_registry;
+    if (name_search_index_size.load(std::memory_order_acquire) == name_registry.GetSize()) {
+        return name_search_index.value();
+    }
+    // Sessions completing against the catalog may request the index of this script concurrently
+    std::lock_guard<std::mutex> guard{name_search_index_latch};
     if (!name_search_index.has_value()) {
-        auto& index = name_search_index.emplace();
-        auto& names = parsed_script->scanned_script->name_registry.GetChunks();
-        for (auto& names_chunk : names) {
-            for (auto& name : names_chunk) {
-                auto s = name.text;
-                for (size_t i = 1; i <= s.size(); ++i) {
-                    auto suffix = s.substr(s.size() - i);
-                    index.insert({{suffix.data(), suffix.size()}, name});
-                }
-            }
-        }
+        name_search_index.emplace(name_registry);
     }
+    name_search_index_size.store(name_registry.GetSize(), std::memory_order_release);
     return name_search_index.value();
 }
 
+std::span<const AnalyzedScript::UnresolvedColumnName> AnalyzedScript::GetUnresolvedColumnNames(
+    uint32_t statement_id) const {
+    if (statement_id >= unresolved_column_names_by_statement.size()) {
+        return {};
+    }
+    auto [begin, count] = unresolved_column_names_by_statement[statement_id];
+    return std::span<const UnresolvedColumnName>{unresolved_column_names}.subspan(begin, count);
+}
+
 template <typename In, typename Out, size_t ChunkSize>
 static flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Out>>> PackVector(
     flatbuffers::FlatBufferBuilder& builder, const ChunkBuffer<In, ChunkSize>& elems) {
@@ -498,12 +504,11 @@ flatbuffers::Offset<buffers::AnalyzedScript> AnalyzedScript::Pack(flatbuffers::F
     // Pack tables
     flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<buffers::Table>>> tables_ofs;
     {
+        // Tables are packed in id order, table ids are used as index into the packed tables
         std::vector<flatbuffers::Offset<buffers::Table>> table_offsets;
         table_offsets.reserve(table_declarations.GetSize());
-        for (auto& table_chunk : table_declarations.GetChunks()) {
-            for (auto& table : table_chunk) {
-                table_offsets.push_back(table.Pack(builder));
-            }
+        for (uint32_t table_id = 0; table_id < table_declarations.GetSize(); ++table_id) {
+            table_offsets.push_back(GetTableById(table_id).Pack(builder));
         }
         tables_ofs = builder.CreateVector(table_offsets);
     }
@@ -617,7 +622,11 @@ Script::Script(Catalog& catalog, uint32_t external_id) : catalog(catalog), catal
     assert(!catalog.Contains(external_id));
 }
 
-Script::~Script() { catalog.DropScript(*this); }
+Script::~Script() {
+    auto catalog_lock = catalog.LockExclusive();
+    catalog.DropScript(*this);
+    catalog.UnregisterDependencies(catalog_entry_id);
+}
 
 /// Insert a character at an offet
 void Script::InsertCharAt(size_t char_idx, uint32_t unicode) {
@@ -669,8 +678,8 @@ std::unique_ptr<buffers::ScriptMemoryStatistics> Script::GetMemoryStatistics() {
         size_t analyzer_name_index_bytes = 0;
         size_t analyzer_name_search_index_size = 0;
         if (auto& index = analyzed->name_search_index) {
-            analyzer_name_index_bytes = index->size() * index->average_bytes_per_value();
-            analyzer_name_search_index_size = index->size();
+            analyzer_name_index_bytes = index->GetByteSize();
+            analyzer_name_search_index_size = index->GetEntryCount();
         }
         stats.mutate_analyzer_description_bytes(analyzer_description_bytes);
         stats.mutate_analyzer_name_index_size(analyzer_name_search_index_size);
@@ -726,6 +735,15 @@ std::pair<ParsedScript*, buffers::StatusCode> Script::Parse() {
 std::pair<AnalyzedScript*, buffers::StatusCode> Script::Analyze() {
     auto time_start = std::chrono::steady_clock::now();
 
+    // Other sessions may analyze and complete at the same time.
+    // A script that is loaded into the catalog is read by these sessions, it is therefore analyzed exclusively.
+    auto shared_lock = catalog.LockShared();
+    Catalog::ExclusiveLock exclusive_lock;
+    if (catalog.Contains(catalog_entry_id)) {
+        shared_lock.unlock();
+        exclusive_lock = catalog.LockExclusive();
+    }
+
     // Check if the script was already analyzed.
     // In that case, we have to clean up anything that we "registered" in the scanned script before.
     if (analyzed_script && scanned_script) {
@@ -737,12 +755,25 @@ std::pair<AnalyzedScript*, buffers::StatusCode> Script::Analyze() {
         }
     }
 
-    // Analyze a script
-    auto [script, status] = Analyzer::Analyze(parsed_script, catalog);
+    // Analyze a script, keeping the table ids of the previous analysis stable
+    auto [script, status] = Analyzer::Analyze(parsed_script, catalog, analyzed_script.get());
     if (status != buffers::StatusCode::OK) {
         return {nullptr, status};
     }
+    // Update the name search index right away if the previous analysis had one, completion is in use then.
+    // The new index shares the suffix trie of the previous one and only scans the names that were added by the edit.
+    if (analyzed_script && analyzed_script->name_search_index.has_value()) {
+        script->name_search_index.emplace(script->parsed_script->scanned_script->name_registry,
+                                          &*analyzed_script->name_search_index);
+    }
     analyzed_script = std::move(script);
+    // Register the catalog dependencies
+    if (!exclusive_lock.owns_lock()) {
+        shared_lock.unlock();
+        exclusive_lock = catalog.LockExclusive();
+    }
+    catalog.RegisterDependencies(analyzed_script);
+    exclusive_lock.unlock();
 
     // Update step timings
     timing_statistics.mutate_analyzer_last_elapsed(
@@ -759,7 +790,8 @@ std::pair<const ScriptCursor*, buffers::StatusCode> Script::MoveCursor(size_t te
     return {cursor.get(), status};
 }
 /// Complete at the cursor
-std::pair<std::unique_ptr<Completion>, buffers::StatusCode> Script::CompleteAtCursor(size_t limit) const {
+std::pair<std::unique_ptr<Completion>, buffers::StatusCode> Script::CompleteAtCursor(
+    size_t limit, std::optional<std::chrono::steady_clock::time_point> deadline) {
     // Fail if the user forgot to move the cursor
     if (cursor == nullptr) {
         return {nullptr, buffers::StatusCode::COMPLETION_MISSES_CURSOR};
@@ -768,8 +800,12 @@ std::pair<std::unique_ptr<Completion>, buffers::StatusCode> Script::CompleteAtCu
     if (!cursor->scanner_location.has_value()) {
         return {nullptr, buffers::StatusCode::COMPLETION_MISSES_SCANNER_TOKEN};
     }
-    // Compute the completion
-    return Completion::Compute(*cursor, limit);
+    // Compute the completion, refining the names of the last completion if possible
+    if (!completion_cache) {
+        completion_cache = std::make_unique<CompletionCache>();
+    }
+    auto catalog_lock = catalog.LockShared();
+    return Completion::Compute(*cursor, limit, completion_cache.get(), deadline);
 }
 
 void AnalyzedScript::FollowPathUpwards(uint32_t ast_node_id, std::vector<uint32_t>& ast_node_path,
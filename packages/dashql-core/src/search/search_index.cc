@@ -0,0 +1,249 @@
+#include "dashql/search/search_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "dashql/utils/string_conversion.h"
+
+namespace dashql {
+
+namespace {
+
+/// Compact the index once the dead files make up more than this share of the indexed text
+constexpr size_t COMPACT_DEAD_SHARE = 2;
+
+/// Pack a trigram of folded characters
+inline SearchIndex::Trigram packTrigram(const char* chars) {
+    return (static_cast<SearchIndex::Trigram>(static_cast<unsigned char>(chars[0])) << 16) |
+           (static_cast<SearchIndex::Trigram>(static_cast<unsigned char>(chars[1])) << 8) |
+           static_cast<SearchIndex::Trigram>(static_cast<unsigned char>(chars[2]));
+}
+
+/// Collect the distinct trigrams of a folded text
+void collectTrigrams(std::string_view text, std::vector<SearchIndex::Trigram>& out) {
+    out.clear();
+    if (text.size() < 3) {
+        return;
+    }
+    out.reserve(text.size() - 2);
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        out.push_back(packTrigram(text.data() + i));
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+/// Fold a text to lowercase
+std::string foldText(std::string_view text) {
+    std::string folded;
+    folded.resize(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        folded[i] = tolower_fuzzy(text[i]);
+    }
+    return folded;
+}
+
+}  // namespace
+
+SearchIndex::SearchIndex() {}
+
+std::string_view SearchIndex::InternLabel(std::string_view text) {
+    auto iter = label_strings.find(text);
+    if (iter != label_strings.end()) {
+        return *iter;
+    }
+    auto copy = label_string_pool.AllocateCopy(text);
+    label_strings.insert(copy);
+    return copy;
+}
+
+const IndexedFileStatistics* SearchIndex::GetFileStatistics(std::string_view filename) const {
+    auto iter = indexed_files_by_name.find(std::string{filename});
+    if (iter == indexed_files_by_name.end()) {
+        return nullptr;
+    }
+    return &indexed_files.at(iter->second).stats;
+}
+
+void SearchIndex::AddFile(std::string_view filename, ScannedScript& script) {
+    // Replace an older version of the file
+    RemoveFile(filename);
+
+    auto file_id = next_file_id++;
+    IndexedFile file{.local_id = file_id, .name = std::string{filename}};
+
+    // Fold the user text, the scanner pads the text buffer with two zero bytes
+    std::string_view text = script.GetInput();
+    text = text.substr(0, std::max<size_t>(text.size(), 2) - 2);
+    file.folded_text = foldText(text);
+
+    // Collect the names as labels
+    for (auto& names_chunk : script.GetNames().GetChunks()) {
+        for (auto& name : names_chunk) {
+            if (name.text.empty() || name.location.length() == 0) {
+                continue;
+            }
+            file.labels.push_back(FileSearchLabel{
+                .local_file_id = file_id,
+                .text = InternLabel(name.text),
+                .location = name.location,
+            });
+        }
+    }
+    std::sort(file.labels.begin(), file.labels.end(),
+              [](auto& l, auto& r) { return l.location.offset() < r.location.offset(); });
+
+    // Append the file to the posting lists of its trigrams.
+    // File ids only grow, the posting lists therefore stay sorted.
+    std::vector<Trigram> trigrams;
+    collectTrigrams(file.folded_text, trigrams);
+    for (auto trigram : trigrams) {
+        trigram_postings[trigram].push_back(static_cast<uint32_t>(file_id));
+    }
+
+    file.stats = IndexedFileStatistics{
+        .label_count = file.labels.size(),
+        .text_bytes = file.folded_text.size(),
+        .trigram_count = trigrams.size(),
+    };
+    index_stats_total = index_stats_total + file.stats;
+    indexed_files_by_name.insert({file.name, file_id});
+    indexed_files.insert({file_id, std::move(file)});
+}
+
+void SearchIndex::RemoveFile(std::string_view filename) {
+    auto iter = indexed_files_by_name.find(std::string{filename});
+    if (iter == indexed_files_by_name.end()) {
+        return;
+    }
+    auto file_id = iter->second;
+    indexed_files_by_name.erase(iter);
+
+    // Mark the file as dead, the postings are dropped when compacting
+    auto& file = indexed_files.at(file_id);
+    indexed_files_tombstones.insert(file_id);
+    index_stats_dead = index_stats_dead + file.stats;
+    file.folded_text = {};
+    file.labels = {};
+
+    // Compact once the dead files dominate the index
+    if (index_stats_dead.text_bytes * COMPACT_DEAD_SHARE > index_stats_total.text_bytes) {
+        Compact();
+    }
+}
+
+void SearchIndex::VerifyFile(const IndexedFile& file, std::string_view folded_query,
+                             std::vector<FileSearchMatch>& out, size_t limit) const {
+    std::string_view text = file.folded_text;
+    // The substring search of the standard library scans for the first character with memchr and compares with
+    // memcmp, both of which are vectorized.
+    for (auto pos = text.find(folded_query); pos != std::string_view::npos && out.size() < limit;
+         pos = text.find(folded_query, pos + 1)) {
+        FileSearchMatch match{
+            .local_file_id = file.local_id,
+            .file_name = file.name,
+            .location = sx::Location(pos, folded_query.size()),
+            .label = nullptr,
+        };
+        // Find the label that contains the match
+        auto label_iter = std::upper_bound(file.labels.begin(), file.labels.end(), pos,
+                                           [](size_t offset, auto& label) { return offset < label.location.offset(); });
+        if (label_iter != file.labels.begin()) {
+            auto& label = *(label_iter - 1);
+            if ((pos + folded_query.size()) <= (label.location.offset() + label.location.length())) {
+                match.label = &label;
+            }
+        }
+        out.push_back(match);
+    }
+}
+
+std::vector<FileSearchMatch> SearchIndex::SearchFile(std::string_view text, size_t limit) const {
+    std::vector<FileSearchMatch> out;
+    if (text.empty() || limit == 0) {
+        return out;
+    }
+    auto folded_query = foldText(text);
+
+    // Collect the candidate files
+    std::vector<uint32_t> candidates;
+    if (folded_query.size() < 3) {
+        // Queries without trigrams have to check all live files
+        candidates.reserve(indexed_files_by_name.size());
+        for (auto& [name, file_id] : indexed_files_by_name) {
+            candidates.push_back(file_id);
+        }
+        std::sort(candidates.begin(), candidates.end());
+    } else {
+        // Find the posting lists of all query trigrams
+        std::vector<Trigram> trigrams;
+        collectTrigrams(folded_query, trigrams);
+        std::vector<const PostingList*> postings;
+        postings.reserve(trigrams.size());
+        for (auto trigram : trigrams) {
+            auto iter = trigram_postings.find(trigram);
+            if (iter == trigram_postings.end()) {
+                return out;
+            }
+            postings.push_back(&iter->second);
+        }
+        // Intersect the posting lists, starting with the shortest
+        std::sort(postings.begin(), postings.end(), [](auto* l, auto* r) { return l->size() < r->size(); });
+        candidates = *postings.front();
+        std::vector<uint32_t> tmp;
+        for (size_t i = 1; i < postings.size() && !candidates.empty(); ++i) {
+            tmp.clear();
+            std::set_intersection(candidates.begin(), candidates.end(), postings[i]->begin(), postings[i]->end(),
+                                  std::back_inserter(tmp));
+            std::swap(candidates, tmp);
+        }
+    }
+
+    // Verify the candidates.
+    // Trigrams only tell us that a file contains all trigrams of the query, not that they are adjacent.
+    for (auto file_id : candidates) {
+        if (out.size() >= limit) {
+            break;
+        }
+        if (indexed_files_tombstones.contains(file_id)) {
+            continue;
+        }
+        VerifyFile(indexed_files.at(file_id), folded_query, out, limit);
+    }
+    return out;
+}
+
+void SearchIndex::Compact() {
+    if (indexed_files_tombstones.empty()) {
+        return;
+    }
+    // Drop the postings of dead files
+    for (auto iter = trigram_postings.begin(); iter != trigram_postings.end();) {
+        auto& postings = iter->second;
+        std::erase_if(postings, [&](uint32_t file_id) { return indexed_files_tombstones.contains(file_id); });
+        if (postings.empty()) {
+            iter = trigram_postings.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    // Drop the dead files
+    for (auto file_id : indexed_files_tombstones) {
+        indexed_files.erase(file_id);
+    }
+    indexed_files_tombstones.clear();
+    index_stats_total = index_stats_total - index_stats_dead;
+    index_stats_dead = {};
+
+    // Rebuild the label strings of the live files
+    StringPool<1024> dead_string_pool;
+    std::swap(dead_string_pool, label_string_pool);
+    label_strings.clear();
+    for (auto& [file_id, file] : indexed_files) {
+        for (auto& label : file.labels) {
+            label.text = InternLabel(label.text);
+        }
+    }
+}
+
+}  // namespace dashql
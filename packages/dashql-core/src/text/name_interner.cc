@@ -0,0 +1,80 @@
+#include "dashql/text/name_interner.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace dashql {
+
+/// Constructor
+NameInterner::NameInterner() {
+    // The empty name always has the id 0 and is never released
+    Intern("");
+}
+
+/// Get the number of bytes used by the interner
+size_t NameInterner::GetByteSize() const {
+    return text_bytes + slots.capacity() * sizeof(Slot) + free_ids.capacity() * sizeof(InternedNameID) +
+           ids_by_text.size() * sizeof(std::pair<std::string_view, InternedNameID>);
+}
+
+/// Find the id of a name without interning it
+std::optional<InternedNameID> NameInterner::Find(std::string_view text) const {
+    auto iter = ids_by_text.find(text);
+    if (iter == ids_by_text.end()) {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+/// Intern a name
+InternedNameID NameInterner::Intern(std::string_view text, std::shared_ptr<const void> owner) {
+    auto iter = ids_by_text.find(text);
+    if (iter != ids_by_text.end()) {
+        ++slots[iter->second].references;
+        return iter->second;
+    }
+    // Reuse a released id if there is one
+    InternedNameID id;
+    if (!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = slots.size();
+        slots.emplace_back();
+    }
+    auto& slot = slots[id];
+    if (owner) {
+        slot.owner = std::move(owner);
+        slot.text = text;
+    } else {
+        if (!text.empty()) {
+            slot.buffer = std::unique_ptr<char[]>(new char[text.size()]);
+            std::memcpy(slot.buffer.get(), text.data(), text.size());
+        }
+        slot.text = {slot.buffer.get(), text.size()};
+        text_bytes += text.size();
+    }
+    slot.references = 1;
+    ids_by_text.insert({slot.text, id});
+    return id;
+}
+
+/// Release a reference to a name
+void NameInterner::Release(InternedNameID id) {
+    assert(id < slots.size());
+    auto& slot = slots[id];
+    assert(slot.references > 0);
+    if (--slot.references > 0 || id == 0) {
+        return;
+    }
+    ids_by_text.erase(slot.text);
+    if (slot.buffer) {
+        text_bytes -= slot.text.size();
+    }
+    slot.buffer.reset();
+    slot.owner.reset();
+    slot.text = {};
+    free_ids.push_back(id);
+}
+
+}  // namespace dashql
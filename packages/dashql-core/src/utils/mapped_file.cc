@@ -0,0 +1,56 @@
+#include "dashql/utils/mapped_file.h"
+
+#ifndef WASM
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dashql {
+
+#ifndef WASM
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        ::munmap(const_cast<std::byte*>(data), size);
+    }
+}
+
+void MappedFile::AdviseRandomAccess() const {
+    if (data != nullptr) {
+        ::madvise(const_cast<std::byte*>(data), size, MADV_RANDOM);
+    }
+}
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    auto size = static_cast<size_t>(file_stat.st_size);
+    // The mapping keeps the file referenced, we can close the descriptor right away
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    return std::unique_ptr<MappedFile>(new MappedFile(static_cast<const std::byte*>(mapping), size));
+}
+
+#else
+
+MappedFile::~MappedFile() {}
+
+void MappedFile::AdviseRandomAccess() const {}
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string&) { return nullptr; }
+
+#endif
+
+}  // namespace dashql
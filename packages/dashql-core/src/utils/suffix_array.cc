@@ -0,0 +1,214 @@
+#include "dashql/utils/suffix_array.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+namespace dashql {
+
+namespace {
+
+/// Get the byte offsets of the sections in a buffer
+struct SuffixArrayLayout {
+    /// The offset of the text offsets
+    size_t text_offsets;
+    /// The offset of the suffixes
+    size_t suffixes;
+    /// The offset of the LCP values
+    size_t lcp;
+    /// The offset of the text bytes
+    size_t text_bytes;
+    /// The total size
+    size_t total;
+
+    /// Constructor
+    SuffixArrayLayout(size_t text_count, size_t suffix_count, size_t text_byte_count) {
+        text_offsets = sizeof(SuffixArray::Header);
+        suffixes = text_offsets + (text_count + 1) * sizeof(uint32_t);
+        lcp = suffixes + suffix_count * sizeof(uint32_t);
+        text_bytes = lcp + suffix_count;
+        total = text_bytes + text_byte_count;
+    }
+};
+
+/// Compare two zero-terminated suffixes case-insensitively
+inline int compareSuffixes(const char* l, const char* r) {
+    for (;; ++l, ++r) {
+        auto lc = tolower_fuzzy(*l);
+        auto rc = tolower_fuzzy(*r);
+        if (lc != rc) {
+            return lc < rc ? -1 : 1;
+        }
+        if (lc == 0) {
+            return 0;
+        }
+    }
+}
+
+/// Count the common characters of two zero-terminated suffixes
+inline uint32_t countCommonPrefix(const char* l, const char* r) {
+    uint32_t n = 0;
+    for (; n < SuffixArray::MAX_LCP && l[n] != 0 && tolower_fuzzy(l[n]) == tolower_fuzzy(r[n]); ++n)
+        ;
+    return n;
+}
+
+}  // namespace
+
+SuffixArray::SuffixArray(const std::byte* buffer) {
+    header = reinterpret_cast<const Header*>(buffer);
+    SuffixArrayLayout layout{header->text_count, header->suffix_count, header->text_bytes};
+    text_offsets = reinterpret_cast<const uint32_t*>(buffer + layout.text_offsets);
+    suffixes = reinterpret_cast<const uint32_t*>(buffer + layout.suffixes);
+    lcp = reinterpret_cast<const uint8_t*>(buffer + layout.lcp);
+    text_bytes = reinterpret_cast<const char*>(buffer + layout.text_bytes);
+}
+
+size_t SuffixArray::GetByteSize() const {
+    if (!header) {
+        return 0;
+    }
+    return SuffixArrayLayout{header->text_count, header->suffix_count, header->text_bytes}.total;
+}
+
+int SuffixArray::ComparePrefix(const char* suffix, StringView prefix) {
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (suffix[i] == 0) {
+            return -1;
+        }
+        auto sc = tolower_fuzzy(suffix[i]);
+        auto pc = tolower_fuzzy(prefix[i]);
+        if (sc != pc) {
+            return sc < pc ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+size_t SuffixArray::GetTextId(size_t suffix_id) const {
+    auto offset = suffixes[suffix_id];
+    auto iter = std::upper_bound(text_offsets, text_offsets + header->text_count + 1, offset);
+    return (iter - text_offsets) - 1;
+}
+
+std::pair<size_t, size_t> SuffixArray::FindPrefix(StringView prefix) const {
+    size_t n = GetSuffixCount();
+    if (n == 0) {
+        return {0, 0};
+    }
+    // Find the first suffix that is not less than the prefix
+    size_t begin = 0;
+    for (size_t count = n; count > 0;) {
+        size_t step = count / 2;
+        if (ComparePrefix(GetSuffix(begin + step), prefix) < 0) {
+            begin += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    if (begin == n || ComparePrefix(GetSuffix(begin), prefix) != 0) {
+        return {begin, begin};
+    }
+    // All following suffixes that share the prefix with their predecessor match as well.
+    // The LCP values are saturated, longer prefixes are compared explicitly.
+    size_t end = begin + 1;
+    if (prefix.size() <= MAX_LCP) {
+        for (; end < n && lcp[end] >= prefix.size(); ++end)
+            ;
+    } else {
+        for (; end < n && ComparePrefix(GetSuffix(end), prefix) == 0; ++end)
+            ;
+    }
+    return {begin, end};
+}
+
+std::optional<size_t> SuffixArray::FindText(std::string_view text) const {
+    auto [begin, end] = FindPrefix(StringView{text.data(), text.size()});
+    // Suffixes that are equal to the text sort before all longer suffixes with the text as prefix
+    for (size_t i = begin; i < end && GetSuffix(i)[text.size()] == 0; ++i) {
+        auto text_id = GetTextId(i);
+        if (suffixes[i] == text_offsets[text_id] && GetText(text_id) == text) {
+            return text_id;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::byte> SuffixArray::Build(std::span<const std::string_view> texts) {
+    // Concatenate the texts with terminators
+    size_t text_byte_count = 0;
+    size_t suffix_count = 0;
+    for (auto text : texts) {
+        assert(text.find('\0') == std::string_view::npos);
+        text_byte_count += text.size() + 1;
+        suffix_count += text.size();
+    }
+    assert(text_byte_count <= std::numeric_limits<uint32_t>::max());
+    SuffixArrayLayout layout{texts.size(), suffix_count, text_byte_count};
+    std::vector<std::byte> buffer;
+    buffer.resize(layout.total);
+
+    auto* header = reinterpret_cast<Header*>(buffer.data());
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->text_count = texts.size();
+    header->suffix_count = suffix_count;
+    header->text_bytes = text_byte_count;
+    header->reserved = 0;
+    auto* text_offsets = reinterpret_cast<uint32_t*>(buffer.data() + layout.text_offsets);
+    auto* suffixes = reinterpret_cast<uint32_t*>(buffer.data() + layout.suffixes);
+    auto* lcp = reinterpret_cast<uint8_t*>(buffer.data() + layout.lcp);
+    auto* text_bytes = reinterpret_cast<char*>(buffer.data() + layout.text_bytes);
+
+    // Write the texts and collect the suffixes
+    uint32_t writer = 0;
+    uint32_t* suffix_writer = suffixes;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        auto text = texts[i];
+        text_offsets[i] = writer;
+        std::memcpy(text_bytes + writer, text.data(), text.size());
+        for (size_t j = 0; j < text.size(); ++j) {
+            *(suffix_writer++) = writer + j;
+        }
+        writer += text.size();
+        text_bytes[writer++] = 0;
+    }
+    text_offsets[texts.size()] = writer;
+
+    // Sort the suffixes, equal suffixes are ordered by their position
+    std::sort(suffixes, suffixes + suffix_count, [&](uint32_t l, uint32_t r) {
+        auto cmp = compareSuffixes(text_bytes + l, text_bytes + r);
+        return cmp < 0 || (cmp == 0 && l < r);
+    });
+
+    // Compute the LCP array
+    for (size_t i = 0; i < suffix_count; ++i) {
+        lcp[i] = i == 0 ? 0 : countCommonPrefix(text_bytes + suffixes[i - 1], text_bytes + suffixes[i]);
+    }
+    return buffer;
+}
+
+std::optional<SuffixArray> SuffixArray::Open(std::span<const std::byte> buffer) {
+    if (buffer.size() < sizeof(Header) || (reinterpret_cast<uintptr_t>(buffer.data()) % alignof(uint32_t)) != 0) {
+        return std::nullopt;
+    }
+    auto* header = reinterpret_cast<const Header*>(buffer.data());
+    if (header->magic != MAGIC || header->version != VERSION) {
+        return std::nullopt;
+    }
+    SuffixArrayLayout layout{header->text_count, header->suffix_count, header->text_bytes};
+    if (layout.total > buffer.size()) {
+        return std::nullopt;
+    }
+    SuffixArray array{buffer.data()};
+    // Check the bounds of the texts, suffixes are trusted
+    if (array.text_offsets[header->text_count] != header->text_bytes ||
+        (header->text_bytes > 0 && array.text_bytes[header->text_bytes - 1] != 0)) {
+        return std::nullopt;
+    }
+    return array;
+}
+
+}  // namespace dashql
@@ -39,27 +39,28 @@ SuffixTrie::InnerNode256::InnerNode256(StringView partial) : Node(NodeType::Inne
 
 SuffixTrie::Node *SuffixTrie::InnerNode4::Find(unsigned char c) {
     c = tolower_fuzzy(c);
-    size_t scratch[4];
-    size_t *writer = scratch;
-    *writer = 0;
-    writer += child_keys[0] == c;
-    *writer = 1;
-    writer += child_keys[1] == c;
-    *writer = 2;
-    writer += child_keys[2] == c;
-    *writer = 3;
-    return children[scratch[0]];
+    for (size_t i = 0; i < child_keys.size(); ++i) {
+        if (child_keys[i] == c && children[i] != nullptr) {
+            return children[i];
+        }
+    }
+    return nullptr;
 }
 
 SuffixTrie::Node *SuffixTrie::InnerNode16::Find(unsigned char c) {
     c = tolower_fuzzy(c);
-    size_t scratch[16];
-    size_t *writer = scratch;
-    for (size_t i = 0; i < 16; ++i) {
-        *writer = i;
-        writer += child_keys[i] == c;
+    for (size_t i = 0; i < child_keys.size(); ++i) {
+        if (child_keys[i] == c && children[i] != nullptr) {
+            return children[i];
+        }
     }
-    return children[scratch[0]];
+    return nullptr;
+}
+
+size_t SuffixTrie::GetByteSize() const {
+    return sizeof(SuffixTrie) + entries.capacity() * sizeof(Entry) + leaf_nodes.GetSize() * sizeof(LeafNode) +
+           inner_nodes_4.GetSize() * sizeof(InnerNode4) + inner_nodes_16.GetSize() * sizeof(InnerNode16) +
+           inner_nodes_48.GetSize() * sizeof(InnerNode48) + inner_nodes_256.GetSize() * sizeof(InnerNode256);
 }
 
 void SuffixTrie::VisitAll(Node *n, IterationCallback callback, ContextType context) {
@@ -121,7 +122,7 @@ void SuffixTrie::VisitAll(Node *n, IterationCallback callback, ContextType conte
     }
 }
 
-void SuffixTrie::IteratePrefix(StringView query, IterationCallback callback, ContextType context) {
+void SuffixTrie::IteratePrefix(StringView query, IterationCallback callback, ContextType context) const {
     Node *node = root;
     size_t depth = 0;
     while (node) {
@@ -295,7 +296,7 @@ std::unique_ptr<SuffixTrie> SuffixTrie::BulkLoad(std::vector<Entry> entries) {
             InnerNode48 &node = trie->inner_nodes_48.Append(InnerNode48(partial));
             node.num_children = partition_count;
             for (size_t i = 0; i < partition_count; ++i) {
-                node.child_ids[partition_keys[i]] = i;
+                node.child_ids[partition_keys[i]] = i + 1;
             }
             for (size_t i = 0; i < partition_count; ++i) {
                 unsigned char key = partition_keys[i];
@@ -0,0 +1,52 @@
+#include "dashql/utils/bloom_filter.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+using namespace dashql;
+
+namespace {
+
+TEST(BloomFilterTest, Empty) {
+    BloomFilter filter;
+    ASSERT_EQ(filter.GetByteSize(), 0);
+    ASSERT_FALSE(filter.MayContain(BloomFilter::HashFolded("foo")));
+}
+
+TEST(BloomFilterTest, NoFalseNegatives) {
+    BloomFilter filter;
+    filter.Reset(1000);
+    for (size_t i = 0; i < 1000; ++i) {
+        filter.Insert(BloomFilter::HashFolded("name_" + std::to_string(i)));
+    }
+    ASSERT_EQ(filter.GetKeyCount(), 1000);
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(filter.MayContain(BloomFilter::HashFolded("name_" + std::to_string(i)))) << i;
+    }
+}
+
+TEST(BloomFilterTest, CaseFolding) {
+    BloomFilter filter;
+    filter.Reset(1);
+    filter.Insert(BloomFilter::HashFolded("Customer", 1));
+    ASSERT_TRUE(filter.MayContain(BloomFilter::HashFolded("customer", 1)));
+    ASSERT_TRUE(filter.MayContain(BloomFilter::HashFolded("CUSTOMER", 1)));
+    // Seeds separate the keys of different kinds
+    ASSERT_NE(BloomFilter::HashFolded("customer", 1), BloomFilter::HashFolded("customer", 2));
+}
+
+TEST(BloomFilterTest, FalsePositiveRate) {
+    BloomFilter filter;
+    filter.Reset(10000);
+    for (size_t i = 0; i < 10000; ++i) {
+        filter.Insert(BloomFilter::HashFolded("name_" + std::to_string(i)));
+    }
+    size_t false_positives = 0;
+    for (size_t i = 0; i < 100000; ++i) {
+        false_positives += filter.MayContain(BloomFilter::HashFolded("other_" + std::to_string(i)));
+    }
+    ASSERT_LT(false_positives, 1000);
+}
+
+}  // namespace
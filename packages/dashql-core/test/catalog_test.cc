@@ -3,10 +3,18 @@
 #include <flatbuffers/buffer.h>
 #include <flatbuffers/flatbuffer_builder.h>
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "dashql/analyzer/analyzer.h"
 #include "dashql/buffers/index_generated.h"
 #include "dashql/script.h"
+#include "dashql/text/prefix_edit_distance.h"
 
 using namespace dashql;
 
@@ -62,6 +70,50 @@ std::tuple<std::span<const std::byte>, std::unique_ptr<const std::byte[]>, size_
     return {data_span, std::move(buffer_owned), buffer_size};
 }
 
+std::tuple<std::span<const std::byte>, std::unique_ptr<const std::byte[]>, size_t> PackSchemas(
+    const std::vector<Schema>& schemas) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<buffers::SchemaDescriptor>> descriptors;
+    std::vector<flatbuffers::Offset<buffers::SchemaTable>> tables;
+    std::vector<flatbuffers::Offset<buffers::SchemaTableColumn>> table_columns;
+    for (auto& schema : schemas) {
+        tables.clear();
+        for (auto& table : schema.tables) {
+            table_columns.clear();
+            for (auto& column : table.table_columns) {
+                auto column_name = fbb.CreateString(column.column_name);
+                buffers::SchemaTableColumnBuilder column_builder{fbb};
+                column_builder.add_column_name(column_name);
+                table_columns.push_back(column_builder.Finish());
+            }
+            auto table_columns_ofs = fbb.CreateVector(table_columns);
+            auto table_name_ofs = fbb.CreateString(table.table_name);
+            buffers::SchemaTableBuilder table_builder{fbb};
+            table_builder.add_table_name(table_name_ofs);
+            table_builder.add_columns(table_columns_ofs);
+            tables.push_back(table_builder.Finish());
+        }
+        auto tables_ofs = fbb.CreateVector(tables);
+        auto database_name = fbb.CreateString(schema.database_name);
+        auto schema_name = fbb.CreateString(schema.schema_name);
+        buffers::SchemaDescriptorBuilder descriptor_builder{fbb};
+        descriptor_builder.add_database_name(database_name);
+        descriptor_builder.add_schema_name(schema_name);
+        descriptor_builder.add_tables(tables_ofs);
+        descriptors.push_back(descriptor_builder.Finish());
+    }
+    auto descriptors_ofs = fbb.CreateVector(descriptors);
+    buffers::SchemaDescriptorsBuilder descriptors_builder{fbb};
+    descriptors_builder.add_schemas(descriptors_ofs);
+    fbb.Finish(descriptors_builder.Finish());
+    size_t buffer_size = 0;
+    size_t buffer_offset = 0;
+    auto buffer = fbb.ReleaseRaw(buffer_size, buffer_offset);
+    auto buffer_owned = std::unique_ptr<const std::byte[]>(reinterpret_cast<const std::byte*>(buffer));
+    std::span<const std::byte> data_span{buffer_owned.get() + buffer_offset, buffer_size - buffer_offset};
+    return {data_span, std::move(buffer_owned), buffer_size};
+}
+
 TEST(CatalogTest, Clear) {
     Catalog catalog;
     ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
@@ -152,6 +204,543 @@ TEST(CatalogTest, DescriptorPoolIDCollision) {
     ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::EXTERNAL_ID_COLLISION);
 }
 
+TEST(CatalogTest, ParallelDescriptorLoading) {
+    // Enough tables to keep several workers busy, with shared and unique column names
+    std::vector<Schema> schemas;
+    for (size_t i = 0; i < 6; ++i) {
+        auto& schema = schemas.emplace_back(Schema{.database_name = "db", .schema_name = std::format("schema_{}", i)});
+        for (size_t j = 0; j < 1000; ++j) {
+            auto& table = schema.tables.emplace_back(SchemaTable{.table_name = std::format("table_{}", j)});
+            table.table_columns.push_back(SchemaTableColumn{.column_name = "id"});
+            table.table_columns.push_back(SchemaTableColumn{.column_name = std::format("column_{}", j % 7)});
+            table.table_columns.push_back(SchemaTableColumn{.column_name = std::format("column_{}_{}", i, j)});
+        }
+    }
+    // Describe the loaded pool
+    auto describe = [](Catalog& catalog) {
+        std::vector<std::string> out;
+        catalog.Iterate([&](CatalogEntryID, CatalogEntry& entry) {
+            auto& pool = dynamic_cast<DescriptorPool&>(entry);
+            for (auto& chunk : pool.GetNameRegistry().GetChunks()) {
+                for (auto& name : chunk) {
+                    out.push_back(std::format("{} {} {} {}", name.name_id, name.text, name.occurrences,
+                                              static_cast<uint8_t>(name.coarse_analyzer_tags)));
+                }
+            }
+            pool.GetTables().ForEach([&](size_t, const CatalogEntry::TableDeclaration& table) {
+                auto& name = table.table_name;
+                auto desc = std::format("{} {}.{}.{}", table.catalog_table_id.GetObject(),
+                                        name.database_name.get().text, name.schema_name.get().text,
+                                        name.table_name.get().text);
+                for (auto& column : table.table_columns) {
+                    desc += std::format(" {}:{}", column.column_index, column.column_name.get().text);
+                }
+                out.push_back(std::move(desc));
+            });
+            out.push_back(std::format("{} {}", pool.GetTablesByName().size(), pool.GetTableColumnsByName().size()));
+        });
+        return out;
+    };
+    auto load = [&](Catalog& catalog, const std::vector<Schema>& schemas, size_t worker_count) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchemas(schemas);
+        return catalog.AddSchemaDescriptors(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size,
+                                            worker_count);
+    };
+
+    // The loaded pool does not depend on the number of workers
+    Catalog sequential;
+    ASSERT_EQ(sequential.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    ASSERT_EQ(load(sequential, schemas, 1), buffers::StatusCode::OK);
+    auto expected = describe(sequential);
+    ASSERT_EQ(sequential.ResolveTable(ContextObjectID{1, 0})->table_columns.size(), 3);
+    for (size_t worker_count : {2, 3, 4, 8}) {
+        Catalog parallel;
+        ASSERT_EQ(parallel.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+        ASSERT_EQ(load(parallel, schemas, worker_count), buffers::StatusCode::OK);
+        ASSERT_EQ(describe(parallel), expected) << worker_count;
+    }
+
+    // Collisions with previous descriptors are reported deterministically and leave the pool unchanged
+    std::vector<Schema> more{Schema{.database_name = "db", .schema_name = "schema_6"},
+                             Schema{.database_name = "db", .schema_name = "schema_5"}};
+    for (size_t j = 0; j < 3000; ++j) {
+        more[0].tables.push_back(SchemaTable{.table_name = std::format("table_{}", j)});
+    }
+    more[1].tables.push_back(SchemaTable{.table_name = "table_999"});
+    for (size_t worker_count : {1, 4}) {
+        Catalog catalog;
+        ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+        ASSERT_EQ(load(catalog, schemas, worker_count), buffers::StatusCode::OK);
+        ASSERT_EQ(load(catalog, more, worker_count), buffers::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_COLLISION);
+        ASSERT_EQ(describe(catalog), expected) << worker_count;
+    }
+
+    // So are duplicate table names within the same descriptors, also if different workers read them
+    std::vector<Schema> duplicates{Schema{.database_name = "db", .schema_name = "schema_7"},
+                                   Schema{.database_name = "db", .schema_name = "schema_7"}};
+    for (size_t j = 0; j < 3000; ++j) {
+        duplicates[0].tables.push_back(SchemaTable{.table_name = std::format("table_{}", j)});
+    }
+    duplicates[1].tables.push_back(SchemaTable{.table_name = "table_10"});
+    for (size_t worker_count : {1, 4}) {
+        Catalog catalog;
+        ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+        ASSERT_EQ(load(catalog, schemas, worker_count), buffers::StatusCode::OK);
+        ASSERT_EQ(load(catalog, duplicates, worker_count),
+                  buffers::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_COLLISION);
+        ASSERT_EQ(describe(catalog), expected) << worker_count;
+    }
+}
+
+TEST(CatalogTest, MappedDescriptorFile) {
+    auto dir = std::filesystem::temp_directory_path();
+    auto write_file = [&](std::string_view name, std::span<const std::byte> data) {
+        auto path = (dir / name).string();
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        return path;
+    };
+    auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchemas({Schema{
+        .database_name = "db1",
+        .schema_name = "schema1",
+        .tables = {SchemaTable{.table_name = "table1",
+                               .table_columns = {SchemaTableColumn{.column_name = "column1"},
+                                                 SchemaTableColumn{.column_name = "column2"}}}},
+    }});
+    auto path = write_file("dashql_catalog_test_descriptors.fb", descriptor);
+
+    Catalog catalog;
+    ASSERT_EQ(catalog.AddSchemaDescriptorsFile(1, path), buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_UNKNOWN);
+    ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.AddSchemaDescriptorsFile(1, path), buffers::StatusCode::OK);
+
+    // The names point into the mapping
+    auto* table = catalog.ResolveTable(ContextObjectID{1, 0});
+    ASSERT_NE(table, nullptr);
+    ASSERT_EQ(table->table_name.table_name.get().text, "table1");
+    ASSERT_EQ(table->table_columns.size(), 2);
+    const DescriptorPool* pool = nullptr;
+    catalog.Iterate([&](CatalogEntryID, CatalogEntry& entry) { pool = dynamic_cast<const DescriptorPool*>(&entry); });
+    ASSERT_NE(pool, nullptr);
+    ASSERT_EQ(pool->GetDescriptors().size(), 1);
+    auto& mapping = std::get<1>(pool->GetDescriptors()[0].descriptor_buffer);
+    auto mapped = mapping->GetData();
+    auto table_name = table->table_name.table_name.get().text;
+    ASSERT_GE(reinterpret_cast<const std::byte*>(table_name.data()), mapped.data());
+    ASSERT_LT(reinterpret_cast<const std::byte*>(table_name.data()), mapped.data() + mapped.size());
+    // The catalog-wide interner borrows the names instead of copying them
+    auto& interner = catalog.GetNameInterner();
+    auto table_name_id = interner.Find("table1");
+    ASSERT_TRUE(table_name_id.has_value());
+    ASSERT_EQ(interner.Get(*table_name_id).data(), table_name.data());
+
+    // Missing files and files without descriptors are rejected
+    ASSERT_EQ(catalog.AddSchemaDescriptorsFile(1, (dir / "dashql_catalog_test_missing.fb").string()),
+              buffers::StatusCode::CATALOG_DESCRIPTOR_FILE_UNREADABLE);
+    std::vector<std::byte> garbage(64, std::byte{0xFF});
+    auto garbage_path = write_file("dashql_catalog_test_garbage.fb", garbage);
+    ASSERT_EQ(catalog.AddSchemaDescriptorsFile(1, garbage_path), buffers::StatusCode::CATALOG_DESCRIPTOR_INVALID);
+    ASSERT_EQ(pool->GetDescriptors().size(), 1);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(garbage_path);
+}
+
+TEST(CatalogTest, CatalogImage) {
+    auto dir = std::filesystem::temp_directory_path();
+    auto path = (dir / "dashql_catalog_test_image.fb").string();
+    // Collect the tables with their database and schema ids
+    using TableIds = std::vector<std::tuple<std::string, CatalogDatabaseID, CatalogSchemaID>>;
+    auto collect_tables = [](Catalog& catalog) {
+        TableIds tables;
+        for (auto table_id : {ContextObjectID{1, 0}, ContextObjectID{2, 0}, ContextObjectID{2, 1}}) {
+            auto* table = catalog.ResolveTable(table_id);
+            EXPECT_NE(table, nullptr);
+            if (table) {
+                tables.emplace_back(std::string{table->table_name.table_name.get().text}, table->catalog_database_id,
+                                    table->catalog_schema_id);
+            }
+        }
+        return tables;
+    };
+    TableIds saved_tables;
+    CatalogDatabaseID saved_next_database_id;
+
+    // Save a catalog with a single descriptor and a descriptor set
+    {
+        Catalog catalog;
+        ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+        ASSERT_EQ(catalog.AddDescriptorPool(2, 20), buffers::StatusCode::OK);
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+            .database_name = "db1",
+            .schema_name = "schema1",
+            .tables = {SchemaTable{.table_name = "table1",
+                                   .table_columns = {SchemaTableColumn{.column_name = "column1"},
+                                                     SchemaTableColumn{.column_name = "column2"}}}},
+        });
+        ASSERT_EQ(catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size),
+                  buffers::StatusCode::OK);
+        auto [descriptors, descriptors_buffer, descriptors_buffer_size] = PackSchemas({
+            Schema{.database_name = "db1",
+                   .schema_name = "schema2",
+                   .tables = {SchemaTable{.table_name = "table2",
+                                          .table_columns = {SchemaTableColumn{.column_name = "column3"}}}}},
+            Schema{.database_name = "db2",
+                   .schema_name = "schema1",
+                   .tables = {SchemaTable{.table_name = "table3",
+                                          .table_columns = {SchemaTableColumn{.column_name = "column4"}}}}},
+        });
+        ASSERT_EQ(catalog.AddSchemaDescriptors(2, descriptors, std::move(descriptors_buffer), descriptors_buffer_size),
+                  buffers::StatusCode::OK);
+        ASSERT_EQ(catalog.SaveImage(path), buffers::StatusCode::OK);
+        saved_tables = collect_tables(catalog);
+        saved_next_database_id = catalog.AllocateDatabaseId("db3");
+    }
+
+    // Load the image into a fresh catalog
+    Catalog catalog;
+    ASSERT_EQ(catalog.LoadImage(path), buffers::StatusCode::OK);
+    // The tables keep their database and schema ids
+    ASSERT_EQ(saved_tables.size(), 3);
+    ASSERT_EQ(collect_tables(catalog), saved_tables);
+    ASSERT_EQ(catalog.AllocateDatabaseId("db3"), saved_next_database_id);
+
+    // The name search index is opened in place
+    std::vector<DescriptorPool*> pools;
+    catalog.Iterate([&](CatalogEntryID, CatalogEntry& entry) {
+        if (auto* pool = dynamic_cast<DescriptorPool*>(&entry)) {
+            pools.push_back(pool);
+        }
+    });
+    ASSERT_EQ(pools.size(), 2);
+    for (auto* pool : pools) {
+        auto& index = pool->GetNameSearchIndex();
+        ASSERT_EQ(index.GetLayout(), CatalogEntry::NameSearchIndex::Layout::SuffixArray);
+        ASSERT_EQ(index.GetDeltaCount(), 0);
+    }
+    std::vector<std::string_view> found;
+    pools[0]->GetNameSearchIndex().IteratePrefix(fuzzy_ci_string_view{"table", 5},
+                                                 [&](const RegisteredName& name) { found.push_back(name.text); });
+    ASSERT_FALSE(found.empty());
+    // The merged name index answers lookups with the persisted suffix arrays
+    for (auto* pool : pools) {
+        ASSERT_NE(pool->GetNameSearchIndex().GetSharedSuffixArray()->external_owner, nullptr);
+    }
+    std::vector<std::string_view> merged;
+    catalog.GetNameIndex().IteratePrefix(
+        fuzzy_ci_string_view{"table", 5},
+        [&](const CatalogNameIndex::NamePostings& postings, const CatalogNameIndex::Posting&) {
+            merged.push_back(postings.text);
+            return true;
+        });
+    std::sort(merged.begin(), merged.end());
+    ASSERT_EQ(merged, std::vector<std::string_view>({"table1", "table2", "table3"}));
+
+    // Images are only loaded into empty catalogs
+    ASSERT_EQ(catalog.LoadImage(path), buffers::StatusCode::CATALOG_NOT_EMPTY);
+    Catalog empty;
+    ASSERT_EQ(empty.LoadImage((dir / "dashql_catalog_test_missing.fb").string()),
+              buffers::StatusCode::CATALOG_IMAGE_IO_FAILED);
+    auto garbage_path = (dir / "dashql_catalog_test_garbage_image.fb").string();
+    {
+        std::vector<char> garbage(64, static_cast<char>(0xFF));
+        std::ofstream out{garbage_path, std::ios::binary | std::ios::trunc};
+        out.write(garbage.data(), garbage.size());
+    }
+    ASSERT_EQ(empty.LoadImage(garbage_path), buffers::StatusCode::CATALOG_IMAGE_INVALID);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(garbage_path);
+}
+
+TEST(CatalogTest, PinnedSnapshots) {
+    auto make_schema = [](std::string table_name) {
+        return PackSchema(Schema{
+            .database_name = "db1",
+            .schema_name = "schema1",
+            .tables = {SchemaTable{.table_name = table_name,
+                                   .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+        });
+    };
+    Catalog catalog;
+    ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = make_schema("table1");
+        ASSERT_EQ(catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size),
+                  buffers::StatusCode::OK);
+    }
+
+    // Pinning the same version twice shares the snapshot
+    auto pinned = catalog.Pin();
+    ASSERT_EQ(pinned->version, catalog.GetVersion());
+    ASSERT_EQ(pinned->descriptor_pools.size(), 1);
+    ASSERT_EQ(catalog.Pin(), pinned);
+    auto* pinned_table = catalog.ResolveTable(ContextObjectID{1, 0});
+    ASSERT_NE(pinned_table, nullptr);
+
+    // Build the next version of the pool without touching the catalog
+    auto next = catalog.CreateDescriptorPool(1, 10);
+    {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = make_schema("table2");
+        auto& schema = *flatbuffers::GetRoot<buffers::SchemaDescriptor>(descriptor.data());
+        CatalogDatabaseID db_id;
+        CatalogSchemaID schema_id;
+        ASSERT_EQ(next->AddSchemaDescriptor(schema, descriptor, std::move(descriptor_buffer), descriptor_buffer_size,
+                                            db_id, schema_id),
+                  buffers::StatusCode::OK);
+    }
+    ASSERT_EQ(catalog.GetVersion(), pinned->version);
+    ASSERT_EQ(catalog.ResolveTable(ContextObjectID{1, 0})->table_name.table_name.get().text, "table1");
+
+    // Publish the next version, the pinned version stays alive
+    ASSERT_EQ(catalog.PublishDescriptorPool(next), buffers::StatusCode::OK);
+    ASSERT_GT(catalog.GetVersion(), pinned->version);
+    ASSERT_EQ(catalog.ResolveTable(ContextObjectID{1, 0})->table_name.table_name.get().text, "table2");
+    ASSERT_EQ(pinned_table->table_name.table_name.get().text, "table1");
+    ASSERT_NE(catalog.Pin(), pinned);
+    ASSERT_EQ(catalog.Pin()->descriptor_pools[0], next);
+
+    // The previous version is released with the last snapshot
+    std::weak_ptr<const DescriptorPool> previous = pinned->descriptor_pools[0];
+    pinned.reset();
+    ASSERT_TRUE(previous.expired());
+}
+
+TEST(CatalogTest, CopyPinnedDescriptorPools) {
+    auto add_table = [](Catalog& catalog, std::string schema_name, std::string table_name) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+            .database_name = "db1",
+            .schema_name = schema_name,
+            .tables = {SchemaTable{.table_name = table_name,
+                                   .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+        });
+        return catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size);
+    };
+    Catalog catalog;
+    ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    ASSERT_EQ(add_table(catalog, "schema1", "table1"), buffers::StatusCode::OK);
+    auto* table1 = catalog.ResolveTable(ContextObjectID{1, 0});
+    ASSERT_NE(table1, nullptr);
+    auto schema_id = table1->catalog_schema_id;
+
+    // Adding a descriptor to a pinned pool publishes a copy, the pinned version is not modified
+    auto pinned = catalog.Pin();
+    auto pinned_pool = pinned->descriptor_pools[0];
+    ASSERT_EQ(add_table(catalog, "schema2", "table2"), buffers::StatusCode::OK);
+    ASSERT_EQ(pinned_pool->GetTables().GetSize(), 1);
+    ASSERT_EQ(table1->table_name.table_name.get().text, "table1");
+    auto current = catalog.Pin();
+    ASSERT_NE(current->descriptor_pools[0], pinned_pool);
+    ASSERT_EQ(current->descriptor_pools[0]->GetTables().GetSize(), 2);
+
+    // The copy keeps the table and schema ids
+    auto* copied_table1 = catalog.ResolveTable(ContextObjectID{1, 0});
+    ASSERT_NE(copied_table1, table1);
+    ASSERT_EQ(copied_table1->table_name.table_name.get().text, "table1");
+    ASSERT_EQ(copied_table1->catalog_schema_id, schema_id);
+    ASSERT_EQ(catalog.ResolveTable(ContextObjectID{1, 1})->table_name.table_name.get().text, "table2");
+
+    // Pools that nobody pinned are modified in place
+    const DescriptorPool* unpinned_pool = current->descriptor_pools[0].get();
+    pinned.reset();
+    pinned_pool.reset();
+    current.reset();
+    ASSERT_EQ(add_table(catalog, "schema1", "table3"), buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.Pin()->descriptor_pools[0].get(), unpinned_pool);
+    ASSERT_EQ(unpinned_pool->GetTables().GetSize(), 3);
+}
+
+TEST(CatalogTest, ConcurrentModifications) {
+    auto add_table = [](Catalog& catalog, CatalogEntryID external_id) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+            .database_name = "db1",
+            .schema_name = "schema1",
+            .tables = {SchemaTable{.table_name = "table1",
+                                   .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+        });
+        return catalog.AddSchemaDescriptor(external_id, descriptor, std::move(descriptor_buffer),
+                                           descriptor_buffer_size);
+    };
+    Catalog catalog;
+    ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    ASSERT_EQ(add_table(catalog, 1), buffers::StatusCode::OK);
+
+    // Modifications take the latch themselves, a writer may still group several of them under one exclusive lock
+    {
+        auto lock = catalog.LockExclusive();
+        ASSERT_EQ(catalog.AddDescriptorPool(2, 5), buffers::StatusCode::OK);
+        ASSERT_EQ(catalog.DropDescriptorPool(2), buffers::StatusCode::OK);
+    }
+
+    // A writer shadows and restores the table while sessions analyze scripts that resolve it
+    std::atomic<bool> writing = true;
+    std::thread writer{[&] {
+        for (size_t i = 0; i < 100; ++i) {
+            EXPECT_EQ(catalog.AddDescriptorPool(2, 5), buffers::StatusCode::OK);
+            EXPECT_EQ(add_table(catalog, 2), buffers::StatusCode::OK);
+            EXPECT_EQ(catalog.DropDescriptorPool(2), buffers::StatusCode::OK);
+        }
+        writing = false;
+    }};
+    using Resolved = AnalyzedScript::TableReference::ResolvedRelationExpression;
+    std::vector<size_t> failures(4, 0);
+    std::vector<std::thread> sessions;
+    for (size_t i = 0; i < failures.size(); ++i) {
+        sessions.emplace_back([&, i] {
+            Script script{catalog, static_cast<CatalogEntryID>(3 + i)};
+            script.ReplaceText("select column1 from db1.schema1.table1");
+            script.Scan();
+            script.Parse();
+            do {
+                auto [analyzed, status] = script.Analyze();
+                if (status != buffers::StatusCode::OK || analyzed->table_references.GetSize() != 1 ||
+                    !std::holds_alternative<Resolved>(analyzed->table_references[0].inner)) {
+                    ++failures[i];
+                    continue;
+                }
+                auto context = std::get<Resolved>(analyzed->table_references[0].inner).catalog_table_id.GetContext();
+                failures[i] += context != 1 && context != 2;
+            } while (writing);
+        });
+    }
+    writer.join();
+    for (auto& session : sessions) {
+        session.join();
+    }
+    for (auto failed : failures) {
+        ASSERT_EQ(failed, 0);
+    }
+    ASSERT_EQ(catalog.ResolveTable(ContextObjectID{1, 0})->table_name.table_name.get().text, "table1");
+}
+
+TEST(CatalogTest, SharedDescriptorPools) {
+    auto make_schema = [](std::string table_name) {
+        return PackSchema(Schema{
+            .database_name = "shared_db",
+            .schema_name = "shared_schema",
+            .tables = {SchemaTable{.table_name = table_name,
+                                   .table_columns = {SchemaTableColumn{.column_name = "shared_column"}}}},
+        });
+    };
+    auto add_schema = [&](DescriptorPool& pool, std::string table_name) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = make_schema(table_name);
+        auto& schema = *flatbuffers::GetRoot<buffers::SchemaDescriptor>(descriptor.data());
+        CatalogDatabaseID db_id;
+        CatalogSchemaID schema_id;
+        auto status = pool.AddSchemaDescriptor(schema, descriptor, std::move(descriptor_buffer),
+                                               descriptor_buffer_size, db_id, schema_id);
+        return std::make_tuple(status, db_id, schema_id);
+    };
+
+    // Shared pools allocate their ids in the shared ids
+    auto ids = std::make_shared<SharedCatalogIds>();
+    auto pool = DescriptorPool::CreateShared(ids, 1, 10);
+    auto [status, db_id, schema_id] = add_schema(*pool, "shared_table");
+    ASSERT_EQ(status, buffers::StatusCode::OK);
+    ASSERT_GE(db_id, SHARED_DATABASE_ID_BASE);
+    ASSERT_GE(schema_id, SHARED_SCHEMA_ID_BASE);
+    ASSERT_EQ(ids->FindSchemaId("shared_db", "shared_schema"), schema_id);
+
+    // Catalogs only reuse the shared ids of pools that are attached
+    {
+        Catalog catalog;
+        ASSERT_LT(catalog.AllocateSchemaId("shared_db", "shared_schema"), SHARED_SCHEMA_ID_BASE);
+    }
+
+    // Only frozen pools can be attached, frozen pools are immutable
+    Catalog catalog1;
+    Catalog catalog2;
+    ASSERT_EQ(catalog1.AttachDescriptorPool(pool), buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_NOT_FROZEN);
+    pool->Freeze();
+    ASSERT_EQ(std::get<0>(add_schema(*pool, "other_table")), buffers::StatusCode::CATALOG_DESCRIPTOR_POOL_FROZEN);
+    ASSERT_EQ(catalog1.AttachDescriptorPool(pool), buffers::StatusCode::OK);
+    ASSERT_EQ(catalog2.AttachDescriptorPool(pool), buffers::StatusCode::OK);
+
+    // Both catalogs resolve the same table declaration
+    auto* table1 = catalog1.ResolveTable(ContextObjectID{1, 0});
+    auto* table2 = catalog2.ResolveTable(ContextObjectID{1, 0});
+    ASSERT_NE(table1, nullptr);
+    ASSERT_EQ(table1, table2);
+    ASSERT_EQ(table1->catalog_schema_id, schema_id);
+
+    // The catalogs don't copy the names of the pool into their own name index
+    ASSERT_EQ(catalog1.GetNameIndex().GetNameCount(), 0);
+    std::vector<std::string_view> names;
+    catalog1.IterateNameIndexes([&](const CatalogNameIndex& index) {
+        index.IteratePrefix("shared_col",
+                            [&](const CatalogNameIndex::NamePostings& postings, const CatalogNameIndex::Posting&) {
+                                names.push_back(postings.text);
+                                return true;
+                            });
+    });
+    ASSERT_EQ(names, std::vector<std::string_view>{"shared_column"});
+
+    // Scripts reuse the shared ids of the pool
+    Script script{catalog1, 2};
+    script.InsertTextAt(0, "create table shared_db.shared_schema.script_table (x integer)");
+    ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+    auto [analyzed, analyzer_status] = script.Analyze();
+    ASSERT_EQ(analyzer_status, buffers::StatusCode::OK);
+    ASSERT_EQ(analyzed->GetSchemasByName().size(), 1);
+    ASSERT_EQ(analyzed->GetSchemasByName().begin()->second.get().catalog_schema_id, schema_id);
+    ASSERT_EQ(catalog1.LoadScript(script, 1), buffers::StatusCode::OK);
+
+    // Dropping the pool from one catalog keeps it attached to the other
+    ASSERT_EQ(catalog1.DropDescriptorPool(1), buffers::StatusCode::OK);
+    ASSERT_EQ(catalog1.ResolveTable(ContextObjectID{1, 0}), nullptr);
+    ASSERT_EQ(catalog2.ResolveTable(ContextObjectID{1, 0}), table2);
+
+    // A pool can't be attached if the catalog allocated local ids for one of its schemas before.
+    // The catalogs declare the schema with a loaded script and with a descriptor pool of their own.
+    Catalog catalog3;
+    Script local_script{catalog3, 5};
+    local_script.InsertTextAt(0, "create table local_db.local_schema.script_table (x integer)");
+    ASSERT_EQ(local_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(local_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(local_script.Analyze().second, buffers::StatusCode::OK);
+    ASSERT_EQ(catalog3.LoadScript(local_script, 1), buffers::StatusCode::OK);
+    Catalog catalog4;
+    ASSERT_EQ(catalog4.AddDescriptorPool(3, 10), buffers::StatusCode::OK);
+    auto [local_descriptor, local_descriptor_buffer, local_descriptor_buffer_size] = PackSchema(Schema{
+        .database_name = "local_db",
+        .schema_name = "local_schema",
+        .tables = {SchemaTable{.table_name = "local_table",
+                               .table_columns = {SchemaTableColumn{.column_name = "local_column"}}}},
+    });
+    ASSERT_EQ(catalog4.AddSchemaDescriptor(3, local_descriptor, std::move(local_descriptor_buffer),
+                                           local_descriptor_buffer_size),
+              buffers::StatusCode::OK);
+    auto conflicting_pool = DescriptorPool::CreateShared(ids, 4, 10);
+    {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+            .database_name = "local_db",
+            .schema_name = "local_schema",
+            .tables = {SchemaTable{.table_name = "shared_table",
+                                   .table_columns = {SchemaTableColumn{.column_name = "shared_column"}}}},
+        });
+        auto& schema = *flatbuffers::GetRoot<buffers::SchemaDescriptor>(descriptor.data());
+        CatalogDatabaseID conflicting_db_id;
+        CatalogSchemaID conflicting_schema_id;
+        ASSERT_EQ(conflicting_pool->AddSchemaDescriptor(schema, descriptor, std::move(descriptor_buffer),
+                                                        descriptor_buffer_size, conflicting_db_id,
+                                                        conflicting_schema_id),
+                  buffers::StatusCode::OK);
+    }
+    conflicting_pool->Freeze();
+    ASSERT_EQ(catalog3.AttachDescriptorPool(conflicting_pool), buffers::StatusCode::CATALOG_ID_OUT_OF_SYNC);
+    ASSERT_EQ(catalog4.AttachDescriptorPool(conflicting_pool), buffers::StatusCode::CATALOG_ID_OUT_OF_SYNC);
+    ASSERT_EQ(catalog4.ResolveTable(ContextObjectID{4, 0}), nullptr);
+    ASSERT_EQ(catalog2.AttachDescriptorPool(conflicting_pool), buffers::StatusCode::OK);
+
+    // Pools with other shared ids reuse the same ids for other names and can't be attached next to them
+    auto other_pool = DescriptorPool::CreateShared(std::make_shared<SharedCatalogIds>(), 6, 10);
+    ASSERT_EQ(std::get<0>(add_schema(*other_pool, "other_table")), buffers::StatusCode::OK);
+    other_pool->Freeze();
+    ASSERT_EQ(catalog2.AttachDescriptorPool(other_pool), buffers::StatusCode::CATALOG_ID_OUT_OF_SYNC);
+    ASSERT_EQ(catalog3.AttachDescriptorPool(other_pool), buffers::StatusCode::OK);
+}
+
 TEST(CatalogTest, FlattenEmpty) {
     Catalog catalog;
     flatbuffers::FlatBufferBuilder fb;
@@ -322,4 +911,741 @@ TEST(CatalogTest, FlattenExampleSchema) {
     ASSERT_EQ(flat->schemas()->size(), 1);
 }
 
+TEST(CatalogTest, FlattenDelta) {
+    Catalog catalog;
+    auto add_pool = [&](std::vector<SchemaTable> tables) {
+        ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+            .database_name = "db1",
+            .schema_name = "schema1",
+            .tables = std::move(tables),
+        });
+        ASSERT_EQ(catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size),
+                  buffers::StatusCode::OK);
+    };
+    add_pool({SchemaTable{.table_name = "table1",
+                          .table_columns = {SchemaTableColumn{.column_name = "column1"},
+                                            SchemaTableColumn{.column_name = "column2"}}},
+              SchemaTable{.table_name = "table2", .table_columns = {SchemaTableColumn{.column_name = "column1"}}}});
+
+    // Flatten the catalog once
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(catalog.Flatten(fb));
+    auto flat = flatbuffers::GetRoot<buffers::FlatCatalog>(fb.GetBufferPointer());
+    auto base_version = flat->catalog_version();
+    std::vector<std::string> names;
+    for (auto* name : *flat->name_dictionary()) {
+        names.push_back(name->str());
+    }
+
+    // Collect the table and column changes of a delta, patching the name dictionary
+    using ChangeType = buffers::FlatCatalogChangeType;
+    using ObjectType = buffers::FlatCatalogObjectType;
+    using Change = std::tuple<ChangeType, ObjectType, std::string, std::string>;
+    auto read_delta = [&](Catalog::Version since_version) {
+        flatbuffers::FlatBufferBuilder delta_fb;
+        delta_fb.Finish(catalog.FlattenDelta(delta_fb, since_version));
+        auto delta = flatbuffers::GetRoot<buffers::FlatCatalogDelta>(delta_fb.GetBufferPointer());
+        EXPECT_TRUE(delta->complete());
+        EXPECT_EQ(delta->catalog_version(), catalog.GetVersion());
+        EXPECT_EQ(delta->name_dictionary_offset(), names.size());
+        for (auto* name : *delta->name_dictionary()) {
+            names.push_back(name->str());
+        }
+        std::vector<Change> changes;
+        for (auto* change : *delta->changes()) {
+            if (change->object_type() == ObjectType::DATABASE || change->object_type() == ObjectType::SCHEMA) {
+                continue;
+            }
+            auto previous_name =
+                change->change_type() == ChangeType::RENAMED ? names[change->previous_name_id()] : std::string{};
+            changes.emplace_back(change->change_type(), change->object_type(), names[change->name_id()],
+                                 previous_name);
+        }
+        return changes;
+    };
+    ASSERT_EQ(read_delta(base_version), std::vector<Change>{});
+
+    // Replace the pool, the second table keeps its id under a new name
+    ASSERT_EQ(catalog.DropDescriptorPool(1), buffers::StatusCode::OK);
+    add_pool({SchemaTable{.table_name = "table1",
+                          .table_columns = {SchemaTableColumn{.column_name = "column1"},
+                                            SchemaTableColumn{.column_name = "column3"}}},
+              SchemaTable{.table_name = "table3", .table_columns = {SchemaTableColumn{.column_name = "column1"}}},
+              SchemaTable{.table_name = "table4", .table_columns = {SchemaTableColumn{.column_name = "column4"}}}});
+    auto changes = read_delta(base_version);
+    ASSERT_EQ(changes, (std::vector<Change>{
+                           {ChangeType::RENAMED, ObjectType::COLUMN, "column3", "column2"},
+                           {ChangeType::RENAMED, ObjectType::TABLE, "table3", "table2"},
+                           {ChangeType::ADDED, ObjectType::TABLE, "table4", ""},
+                           {ChangeType::ADDED, ObjectType::COLUMN, "column4", ""},
+                       }));
+
+    // Name ids are stable, a full flatten uses the same dictionary
+    fb.Clear();
+    fb.Finish(catalog.Flatten(fb));
+    flat = flatbuffers::GetRoot<buffers::FlatCatalog>(fb.GetBufferPointer());
+    ASSERT_EQ(flat->name_dictionary()->size(), names.size());
+    ASSERT_EQ(flat->tables()->size(), 3);
+    for (size_t i = 0; i < names.size(); ++i) {
+        ASSERT_EQ(flat->name_dictionary()->Get(i)->str(), names[i]);
+    }
+    ASSERT_EQ(names[flat->tables()->Get(1)->name_id()], "table3");
+    ASSERT_EQ(flat->tables()->Get(1)->catalog_object_id(), ContextObjectID(1, 1).Pack());
+
+    // Dropping the pool removes the tables, their columns are implied
+    auto dropped_version = catalog.GetVersion();
+    ASSERT_EQ(catalog.DropDescriptorPool(1), buffers::StatusCode::OK);
+    changes = read_delta(dropped_version);
+    ASSERT_EQ(changes, (std::vector<Change>{
+                           {ChangeType::REMOVED, ObjectType::TABLE, "table1", ""},
+                           {ChangeType::REMOVED, ObjectType::TABLE, "table3", ""},
+                           {ChangeType::REMOVED, ObjectType::TABLE, "table4", ""},
+                       }));
+
+    // A full flatten compacts the dictionary once most names are unreferenced, earlier versions can't be patched
+    fb.Clear();
+    fb.Finish(catalog.Flatten(fb));
+    flat = flatbuffers::GetRoot<buffers::FlatCatalog>(fb.GetBufferPointer());
+    ASSERT_EQ(flat->databases()->size(), 0);
+    ASSERT_EQ(flat->tables()->size(), 0);
+    ASSERT_EQ(flat->name_dictionary()->size(), 0);
+    {
+        flatbuffers::FlatBufferBuilder delta_fb;
+        delta_fb.Finish(catalog.FlattenDelta(delta_fb, dropped_version));
+        auto delta = flatbuffers::GetRoot<buffers::FlatCatalogDelta>(delta_fb.GetBufferPointer());
+        ASSERT_FALSE(delta->complete());
+    }
+    names.clear();
+    add_pool({SchemaTable{.table_name = "table5", .table_columns = {SchemaTableColumn{.column_name = "column5"}}}});
+    changes = read_delta(flat->catalog_version());
+    ASSERT_EQ(changes, (std::vector<Change>{
+                           {ChangeType::ADDED, ObjectType::TABLE, "table5", ""},
+                           {ChangeType::ADDED, ObjectType::COLUMN, "column5", ""},
+                       }));
+}
+
+TEST(CatalogTest, FlattenWindow) {
+    Catalog catalog;
+    ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    auto add_schema = [&](Schema schema) {
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(schema);
+        ASSERT_EQ(catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size),
+                  buffers::StatusCode::OK);
+    };
+    add_schema(Schema{
+        .database_name = "db1",
+        .schema_name = "schema1",
+        .tables = {SchemaTable{.table_name = "table1",
+                               .table_columns = {SchemaTableColumn{.column_name = "column1"},
+                                                 SchemaTableColumn{.column_name = "column2"}}},
+                   SchemaTable{.table_name = "table2", .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+    });
+    add_schema(Schema{
+        .database_name = "db1",
+        .schema_name = "schema2",
+        .tables = {SchemaTable{.table_name = "table3", .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+    });
+    add_schema(Schema{
+        .database_name = "db2",
+        .schema_name = "schema3",
+        .tables = {SchemaTable{.table_name = "table4", .table_columns = {SchemaTableColumn{.column_name = "column3"}}}},
+    });
+
+    // Get the object ids
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(catalog.Flatten(fb));
+    auto flat = flatbuffers::GetRoot<buffers::FlatCatalog>(fb.GetBufferPointer());
+    ASSERT_EQ(flat->databases()->size(), 2);
+    ASSERT_EQ(flat->schemas()->size(), 3);
+    auto db1 = static_cast<CatalogDatabaseID>(flat->databases()->Get(0)->catalog_object_id());
+    auto db2 = static_cast<CatalogDatabaseID>(flat->databases()->Get(1)->catalog_object_id());
+    auto schema1 = static_cast<CatalogSchemaID>(flat->schemas()->Get(0)->catalog_object_id());
+    auto schema3 = static_cast<CatalogSchemaID>(flat->schemas()->Get(2)->catalog_object_id());
+
+    // Read the names and subtree sizes of a window
+    auto read_window = [&](const Catalog::FlatCatalogExpansion& expanded, size_t offset, size_t count,
+                           size_t expected_row_count) {
+        flatbuffers::FlatBufferBuilder window_fb;
+        window_fb.Finish(catalog.FlattenWindow(window_fb, expanded, offset, count));
+        auto window = flatbuffers::GetRoot<buffers::FlatCatalogWindow>(window_fb.GetBufferPointer());
+        EXPECT_EQ(window->row_count(), expected_row_count);
+        std::unordered_map<uint32_t, std::string> names;
+        for (size_t i = 0; i < window->names()->size(); ++i) {
+            names.insert({window->name_ids()->Get(i), window->names()->Get(i)->str()});
+        }
+        std::vector<std::pair<std::string, uint32_t>> rows;
+        for (auto* row : *window->rows()) {
+            rows.emplace_back(names.at(row->name_id()), row->subtree_rows());
+        }
+        return rows;
+    };
+    using Rows = std::vector<std::pair<std::string, uint32_t>>;
+
+    // Only the databases are visible without expanded nodes
+    ASSERT_EQ(read_window({}, 0, 100, 2), (Rows{{"db1", 1}, {"db2", 1}}));
+
+    // Expand the first database, its first schema and the first table
+    Catalog::FlatCatalogExpansion expanded{
+        .databases = {db1},
+        .schemas = {schema1},
+        .tables = {ContextObjectID(1, 0).Pack()},
+    };
+    ASSERT_EQ(read_window(expanded, 0, 100, 8), (Rows{{"db1", 7},
+                                                      {"schema1", 5},
+                                                      {"table1", 3},
+                                                      {"column1", 1},
+                                                      {"column2", 1},
+                                                      {"table2", 1},
+                                                      {"schema2", 1},
+                                                      {"db2", 1}}));
+    // Windows start in the middle of expanded subtrees
+    ASSERT_EQ(read_window(expanded, 3, 4, 8), (Rows{{"column1", 1}, {"column2", 1}, {"table2", 1}, {"schema2", 1}}));
+    ASSERT_EQ(read_window(expanded, 7, 100, 8), (Rows{{"db2", 1}}));
+    ASSERT_EQ(read_window(expanded, 8, 100, 8), Rows{});
+
+    // Expanded nodes below collapsed nodes stay hidden
+    expanded.databases.push_back(db2);
+    expanded.tables.push_back(ContextObjectID(1, 3).Pack());
+    ASSERT_EQ(read_window(expanded, 6, 100, 9), (Rows{{"schema2", 1}, {"db2", 2}, {"schema3", 1}}));
+    expanded.schemas.push_back(schema3);
+    ASSERT_EQ(read_window(expanded, 6, 100, 11),
+              (Rows{{"schema2", 1}, {"db2", 4}, {"schema3", 3}, {"table4", 2}, {"column3", 1}}));
+}
+
+TEST(CatalogTest, ResolutionCache) {
+    Catalog catalog;
+    ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+        .database_name = "db1",
+        .schema_name = "schema1",
+        .tables = {SchemaTable{.table_name = "table1", .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+    });
+    ASSERT_EQ(catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size),
+              buffers::StatusCode::OK);
+
+    Script script{catalog, 2};
+    script.ReplaceText(
+        "select * from db1.schema1.table1; select * from db1.schema1.table1; select * from db1.schema1.table2; "
+        "select * from db1.schema1.table2;");
+    ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    {
+        auto stats = catalog.GetStatistics();
+        ASSERT_EQ(stats->resolution->table_lookups(), 4);
+        ASSERT_EQ(stats->resolution->table_cache_hits(), 4);
+        ASSERT_EQ(stats->resolution->table_cache_negative_hits(), 2);
+        ASSERT_EQ(stats->resolution->table_cache_entries(), 1);
+    }
+
+    // Adding a table to the schema caches its resolution
+    auto [descriptor2, descriptor_buffer2, descriptor_buffer_size2] = PackSchema(Schema{
+        .database_name = "db1",
+        .schema_name = "schema1",
+        .tables = {SchemaTable{.table_name = "table2", .table_columns = {SchemaTableColumn{.column_name = "column2"}}}},
+    });
+    ASSERT_EQ(catalog.AddSchemaDescriptor(1, descriptor2, std::move(descriptor_buffer2), descriptor_buffer_size2),
+              buffers::StatusCode::OK);
+    {
+        auto stats = catalog.GetStatistics();
+        ASSERT_EQ(stats->resolution->table_cache_invalidations(), 0);
+        ASSERT_EQ(stats->resolution->table_cache_entries(), 2);
+    }
+    ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    {
+        auto stats = catalog.GetStatistics();
+        ASSERT_EQ(stats->resolution->table_lookups(), 8);
+        ASSERT_EQ(stats->resolution->table_cache_hits(), 8);
+        ASSERT_EQ(stats->resolution->table_cache_negative_hits(), 2);
+        ASSERT_EQ(stats->resolution->table_cache_entries(), 2);
+    }
+    using Resolved = AnalyzedScript::TableReference::ResolvedRelationExpression;
+    auto& table_refs = script.analyzed_script->table_references;
+    ASSERT_EQ(table_refs.GetSize(), 4);
+    for (size_t i = 0; i < table_refs.GetSize(); ++i) {
+        ASSERT_TRUE(std::holds_alternative<Resolved>(table_refs[i].inner));
+    }
+
+    // A pool with a higher priority replaces the cached resolution
+    ASSERT_EQ(catalog.AddDescriptorPool(3, 5), buffers::StatusCode::OK);
+    auto [descriptor3, descriptor_buffer3, descriptor_buffer_size3] = PackSchema(Schema{
+        .database_name = "db1",
+        .schema_name = "schema1",
+        .tables = {SchemaTable{.table_name = "table1", .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+    });
+    ASSERT_EQ(catalog.AddSchemaDescriptor(3, descriptor3, std::move(descriptor_buffer3), descriptor_buffer_size3),
+              buffers::StatusCode::OK);
+    {
+        auto stats = catalog.GetStatistics();
+        ASSERT_EQ(stats->resolution->table_cache_invalidations(), 1);
+        ASSERT_EQ(stats->resolution->table_cache_entries(), 2);
+    }
+    ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    ASSERT_EQ(std::get<Resolved>(script.analyzed_script->table_references[0].inner).catalog_table_id.GetContext(), 3);
+
+    // Dropping the pool restores the previous resolution
+    ASSERT_EQ(catalog.DropDescriptorPool(3), buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.GetStatistics()->resolution->table_cache_invalidations(), 2);
+    ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    ASSERT_EQ(std::get<Resolved>(script.analyzed_script->table_references[0].inner).catalog_table_id.GetContext(), 1);
+}
+
+TEST(CatalogTest, ResolutionCacheMisses) {
+    Catalog catalog;
+    ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+        .database_name = "db1",
+        .schema_name = "schema1",
+        .tables = {SchemaTable{.table_name = "table1", .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+    });
+    ASSERT_EQ(catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size),
+              buffers::StatusCode::OK);
+
+    // Lookups of unknown tables, schemas and databases don't grow the cache
+    Script script{catalog, 2};
+    script.ReplaceText(
+        "select * from db1.schema1.missing1; select * from db1.schema2.table1; select * from db2.schema1.table1; "
+        "select * from db1.table1.schema1;");
+    ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    }
+    auto stats = catalog.GetStatistics();
+    ASSERT_EQ(stats->resolution->table_lookups(), 12);
+    ASSERT_EQ(stats->resolution->table_cache_negative_hits(), 12);
+    ASSERT_EQ(stats->resolution->table_cache_entries(), 1);
+}
+
+TEST(CatalogTest, ReleaseInternedNames) {
+    Catalog catalog;
+    auto interned_names = catalog.GetStatistics()->interned_names;
+
+    // Register a descriptor pool and a schema script
+    ASSERT_EQ(catalog.AddDescriptorPool(1, 10), buffers::StatusCode::OK);
+    auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+        .database_name = "db1",
+        .schema_name = "schema1",
+        .tables = {SchemaTable{.table_name = "table1", .table_columns = {SchemaTableColumn{.column_name = "column1"}}}},
+    });
+    ASSERT_EQ(catalog.AddSchemaDescriptor(1, descriptor, std::move(descriptor_buffer), descriptor_buffer_size),
+              buffers::StatusCode::OK);
+    Script script{catalog, 2};
+    script.ReplaceText("create table db1.schema1.table2 (column2 integer)");
+    ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.LoadScript(script, 1), buffers::StatusCode::OK);
+    ASSERT_GT(catalog.GetStatistics()->interned_names, interned_names);
+
+    // Edits of the script release the names that are gone
+    script.ReplaceText("create table db1.schema1.table3 (column3 integer)");
+    ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    auto before_update = catalog.GetStatistics()->interned_names;
+    ASSERT_EQ(catalog.LoadScript(script, 1), buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.GetStatistics()->interned_names, before_update);
+    ASSERT_FALSE(catalog.GetNameInterner().Find("table2").has_value());
+    ASSERT_TRUE(catalog.GetNameInterner().Find("table3").has_value());
+
+    // Dropping all entries releases all names, the flat catalog keeps its own copies
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(catalog.Flatten(fb));
+    catalog.DropScript(script);
+    ASSERT_EQ(catalog.DropDescriptorPool(1), buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.GetStatistics()->interned_names, interned_names);
+}
+
+TEST(CatalogTest, NameFilters) {
+    Catalog catalog;
+    auto add_pool = [&](CatalogEntryID external_id, std::string table_name, std::string column_name) {
+        auto pool = catalog.CreateDescriptorPool(external_id, external_id * 10);
+        auto [descriptor, descriptor_buffer, descriptor_buffer_size] = PackSchema(Schema{
+            .database_name = "db1",
+            .schema_name = "schema1",
+            .tables = {SchemaTable{.table_name = table_name,
+                                   .table_columns = {SchemaTableColumn{.column_name = column_name}}}},
+        });
+        auto& schema = *flatbuffers::GetRoot<buffers::SchemaDescriptor>(descriptor.data());
+        CatalogDatabaseID db_id;
+        CatalogSchemaID schema_id;
+        EXPECT_EQ(pool->AddSchemaDescriptor(schema, descriptor, std::move(descriptor_buffer), descriptor_buffer_size,
+                                            db_id, schema_id),
+                  buffers::StatusCode::OK);
+        EXPECT_EQ(catalog.PublishDescriptorPool(pool), buffers::StatusCode::OK);
+        return pool;
+    };
+    auto pool1 = add_pool(1, "table1", "column1");
+    auto pool2 = add_pool(2, "table2", "column2");
+
+    // The filters cover the case-folded table and column names separately
+    auto table_hash = [](std::string_view name) {
+        return BloomFilter::HashFolded(name, CatalogEntry::NAME_FILTER_TABLE_SEED);
+    };
+    auto column_hash = [](std::string_view name) {
+        return BloomFilter::HashFolded(name, CatalogEntry::NAME_FILTER_COLUMN_SEED);
+    };
+    ASSERT_TRUE(pool1->MayContainTable(table_hash("TABLE1")));
+    ASSERT_TRUE(pool1->MayContainColumn(column_hash("Column1")));
+    ASSERT_FALSE(pool1->MayContainTable(table_hash("table2")));
+    ASSERT_FALSE(pool1->MayContainTable(table_hash("column1")));
+    ASSERT_FALSE(pool1->MayContainColumn(column_hash("column2")));
+    ASSERT_GT(pool1->GetNameFilter().GetByteSize(), 0);
+
+    // Resolving table2 skips the first pool without probing it
+    Script script{catalog, 3};
+    script.ReplaceText("select column2 from db1.schema1.table2");
+    ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    auto stats = catalog.GetStatistics();
+    ASSERT_EQ(stats->resolution->table_lookups(), 1);
+    ASSERT_EQ(stats->resolution->table_filter_skips(), 1);
+    auto& table_refs = script.analyzed_script->table_references;
+    ASSERT_EQ(table_refs.GetSize(), 1);
+    using Resolved = AnalyzedScript::TableReference::ResolvedRelationExpression;
+    ASSERT_TRUE(std::holds_alternative<Resolved>(table_refs[0].inner));
+
+    // Analyzed scripts filter their own declarations
+    Script schema_script{catalog, 4};
+    schema_script.ReplaceText("create table script_table (script_column integer)");
+    ASSERT_EQ(schema_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(schema_script.Parse().second, buffers::StatusCode::OK);
+    auto [analyzed, analyzer_status] = schema_script.Analyze();
+    ASSERT_EQ(analyzer_status, buffers::StatusCode::OK);
+    ASSERT_TRUE(analyzed->MayContainTable(table_hash("script_table")));
+    ASSERT_TRUE(analyzed->MayContainColumn(column_hash("script_column")));
+    ASSERT_GT(analyzed->GetNameFilter().GetByteSize(), 0);
+}
+
+TEST(CatalogTest, DependentStatements) {
+    Catalog catalog;
+    Script schema_script{catalog, 1};
+    auto analyze = [](Script& script, std::string_view text) {
+        script.ReplaceText(text);
+        ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    };
+    analyze(schema_script, "create table a (x integer); create table b (y integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+
+    Script query_script{catalog, 2};
+    analyze(query_script, "select x from a; select y from b; select w from c;");
+    ASSERT_TRUE(catalog.GetOutdatedStatements().empty());
+
+    // Changing table b only invalidates the second statement
+    analyze(schema_script, "create table a (x integer); create table b (y integer, z integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    Catalog::OutdatedStatements expected{{2, {1}}};
+    ASSERT_EQ(catalog.TakeOutdatedStatements(), expected);
+
+    // Declaring the missing table c invalidates the third statement
+    analyze(schema_script,
+            "create table a (x integer); create table b (y integer, z integer); create table c (w integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    expected = {{2, {2}}};
+    ASSERT_EQ(catalog.TakeOutdatedStatements(), expected);
+
+    // Re-analyzing the query script clears its outdated statements
+    analyze(schema_script, "create table a (x integer, v integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    expected = {{2, {0, 1, 2}}};
+    ASSERT_EQ(catalog.GetOutdatedStatements(), expected);
+    analyze(query_script, "select x from a; select y from b; select w from c;");
+    ASSERT_TRUE(catalog.GetOutdatedStatements().empty());
+}
+
+TEST(CatalogTest, StableTableIds) {
+    Catalog catalog;
+    Script schema_script{catalog, 1};
+    auto analyze = [](Script& script, std::string_view text) {
+        script.ReplaceText(text);
+        ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    };
+    auto table_name = [&](uint32_t table_id) -> std::string_view {
+        auto* table = catalog.ResolveTable(ContextObjectID{1, table_id});
+        return table ? table->table_name.table_name.get().text : "";
+    };
+    auto object_ids = [](const std::vector<ContextObjectID>& ids) {
+        std::vector<uint32_t> out;
+        for (auto& id : ids) {
+            out.push_back(id.GetObject());
+        }
+        return out;
+    };
+    analyze(schema_script, "create table a (x integer); create table b (y integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    ASSERT_NE(catalog.GetTableDelta(1), nullptr);
+    ASSERT_EQ(object_ids(catalog.GetTableDelta(1)->added_tables), std::vector<uint32_t>({0, 1}));
+
+    Script query_script{catalog, 2};
+    analyze(query_script, "select x from a; select y from b;");
+    ASSERT_TRUE(catalog.GetOutdatedStatements().empty());
+
+    // Prepending a table keeps the ids of the other tables and invalidates nothing
+    analyze(schema_script, "create table c (z integer); create table a (x integer); create table b (y integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    ASSERT_TRUE(catalog.GetOutdatedStatements().empty());
+    EXPECT_EQ(table_name(0), "a");
+    EXPECT_EQ(table_name(1), "b");
+    EXPECT_EQ(table_name(2), "c");
+    auto* delta = catalog.GetTableDelta(1);
+    ASSERT_NE(delta, nullptr);
+    EXPECT_EQ(object_ids(delta->added_tables), std::vector<uint32_t>({2}));
+    EXPECT_TRUE(delta->changed_tables.empty());
+    EXPECT_TRUE(delta->removed_tables.empty());
+
+    // The tables know their statements
+    auto& analyzed = *schema_script.analyzed_script;
+    EXPECT_EQ(analyzed.GetTableById(0).ast_statement_id, 1);
+    EXPECT_EQ(analyzed.GetTableById(1).ast_statement_id, 2);
+    EXPECT_EQ(analyzed.GetTableById(2).ast_statement_id, 0);
+
+    // Dropping a table keeps the ids dense, the moved table counts as changed
+    analyze(schema_script, "create table c (z integer); create table b (y integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    EXPECT_EQ(table_name(0), "c");
+    EXPECT_EQ(table_name(1), "b");
+    EXPECT_EQ(table_name(2), "");
+    delta = catalog.GetTableDelta(1);
+    ASSERT_NE(delta, nullptr);
+    EXPECT_TRUE(delta->added_tables.empty());
+    EXPECT_EQ(object_ids(delta->changed_tables), std::vector<uint32_t>({0}));
+    EXPECT_EQ(object_ids(delta->removed_tables), std::vector<uint32_t>({0}));
+    Catalog::OutdatedStatements expected{{2, {0}}};
+    ASSERT_EQ(catalog.TakeOutdatedStatements(), expected);
+}
+
+TEST(CatalogTest, ReleaseRetiredScripts) {
+    Catalog catalog;
+    auto analyze = [](Script& script, std::string_view text) {
+        script.ReplaceText(text);
+        ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    };
+    Script schema_script{catalog, 1};
+    analyze(schema_script, "create table a (x integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    std::weak_ptr<AnalyzedScript> first = schema_script.analyzed_script;
+
+    // A dependent that resolved against the first version keeps it alive after an edit
+    Script query_script{catalog, 2};
+    analyze(query_script, "select x from a;");
+    analyze(schema_script, "create table a (x integer, y integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    ASSERT_FALSE(first.expired());
+
+    // Analyzing the dependent again releases it
+    analyze(query_script, "select x from a;");
+    ASSERT_TRUE(first.expired());
+
+    // Schema scripts that reference each other don't keep their previous versions alive
+    Script other_script{catalog, 3};
+    analyze(other_script, "create table b (z integer); select x from a;");
+    ASSERT_EQ(catalog.LoadScript(other_script, 1), buffers::StatusCode::OK);
+    std::vector<std::weak_ptr<AnalyzedScript>> versions;
+    for (size_t i = 0; i < 4; ++i) {
+        versions.push_back(schema_script.analyzed_script);
+        versions.push_back(other_script.analyzed_script);
+        analyze(schema_script, "create table a (x integer); select z from b;");
+        ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+        analyze(other_script, "create table b (z integer); select x from a;");
+        ASSERT_EQ(catalog.LoadScript(other_script, 1), buffers::StatusCode::OK);
+    }
+    analyze(query_script, "select x from a;");
+    for (size_t i = 0; i < versions.size(); ++i) {
+        ASSERT_TRUE(versions[i].expired()) << i;
+    }
+
+    // A dropped script is released with its last dependent
+    std::weak_ptr<AnalyzedScript> dropped = other_script.analyzed_script;
+    catalog.DropScript(other_script);
+    other_script.ReplaceText("");
+    ASSERT_EQ(other_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(other_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(other_script.Analyze().second, buffers::StatusCode::OK);
+    ASSERT_FALSE(dropped.expired());
+    analyze(schema_script, "create table a (x integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    analyze(query_script, "select x from a;");
+    ASSERT_TRUE(dropped.expired());
+}
+
+TEST(CatalogTest, FindReferences) {
+    Catalog catalog;
+    Script schema_script{catalog, 1};
+    auto analyze = [](Script& script, std::string_view text) {
+        script.ReplaceText(text);
+        ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    };
+    auto collect = [](std::span<const Catalog::ObjectReference> refs) {
+        std::vector<std::pair<CatalogEntryID, size_t>> out;
+        for (auto& ref : refs) {
+            out.emplace_back(ref.catalog_entry_id, ref.location.offset());
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    using Refs = std::vector<std::pair<CatalogEntryID, size_t>>;
+    analyze(schema_script, "create table a (x integer, y integer); create table b (z integer);");
+    ASSERT_EQ(catalog.LoadScript(schema_script, 0), buffers::StatusCode::OK);
+    ContextObjectID table_a{1, 0};
+    ContextObjectID table_b{1, 1};
+
+    Script query_script_2{catalog, 2};
+    Script query_script_3{catalog, 3};
+    analyze(query_script_2, "select x from a");
+    analyze(query_script_3, "select y, x from a, b");
+    EXPECT_EQ(collect(catalog.FindReferences(table_a)), Refs({{2, 14}, {3, 17}}));
+    EXPECT_EQ(collect(catalog.FindReferences(table_b)), Refs({{3, 20}}));
+    EXPECT_EQ(collect(catalog.FindReferences(table_a, 0)), Refs({{2, 7}, {3, 10}}));
+    EXPECT_EQ(collect(catalog.FindReferences(table_a, 1)), Refs({{3, 7}}));
+    EXPECT_TRUE(catalog.FindReferences(table_b, 0).empty());
+
+    // The references are ids into the referencing script
+    auto refs = catalog.FindReferences(table_b);
+    ASSERT_EQ(refs.size(), 1);
+    auto& table_ref = query_script_3.analyzed_script->table_references[refs[0].reference_id];
+    EXPECT_EQ(table_ref.location->offset(), refs[0].location.offset());
+
+    // Re-analyzing a script replaces its references
+    analyze(query_script_3, "select 1 from b where z = 42");
+    EXPECT_EQ(collect(catalog.FindReferences(table_a)), Refs({{2, 14}}));
+    EXPECT_EQ(collect(catalog.FindReferences(table_b)), Refs({{3, 14}}));
+    EXPECT_TRUE(catalog.FindReferences(table_a, 1).empty());
+    EXPECT_EQ(collect(catalog.FindReferences(table_b, 0)), Refs({{3, 22}}));
+
+    // Unresolved references are not indexed
+    analyze(query_script_3, "select x from c");
+    EXPECT_TRUE(catalog.FindReferences(table_b).empty());
+    EXPECT_EQ(collect(catalog.FindReferences(table_a, 0)), Refs({{2, 7}}));
+
+    // Destroying a script drops its references
+    {
+        Script query_script_4{catalog, 4};
+        analyze(query_script_4, "select x from a");
+        EXPECT_EQ(catalog.FindReferences(table_a).size(), 2);
+    }
+    EXPECT_EQ(collect(catalog.FindReferences(table_a)), Refs({{2, 14}}));
+}
+
+TEST(CatalogTest, MergedNameIndex) {
+    Catalog catalog;
+    auto analyze = [](Script& script, std::string_view text) {
+        script.ReplaceText(text);
+        ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    };
+    // Collect the names with a suffix prefix and their entries in the order of the visits
+    auto lookup = [&](std::string_view prefix) {
+        std::vector<std::pair<std::string_view, std::vector<CatalogEntryID>>> out;
+        catalog.GetNameIndex().IteratePrefix(
+            fuzzy_ci_string_view{prefix.data(), prefix.size()},
+            [&](const CatalogNameIndex::NamePostings& postings, const CatalogNameIndex::Posting& posting) {
+                auto iter =
+                    std::find_if(out.begin(), out.end(), [&](auto& name) { return name.first == postings.text; });
+                if (iter == out.end()) {
+                    iter = out.insert(out.end(), {postings.text, {}});
+                }
+                iter->second.push_back(posting.catalog_entry_id);
+                return true;
+            });
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    using Names = std::vector<std::pair<std::string_view, std::vector<CatalogEntryID>>>;
+
+    Script schema1{catalog, 1};
+    Script schema2{catalog, 2};
+    analyze(schema1, "create table foo (abc integer);");
+    analyze(schema2, "create table bar (abc integer, xabc integer);");
+    ASSERT_EQ(catalog.LoadScript(schema1, 1), buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.LoadScript(schema2, 0), buffers::StatusCode::OK);
+
+    // Names are visited once per entry, entries are visited in the order of their rank
+    ASSERT_EQ(lookup("abc"), Names({{"abc", {2, 1}}, {"xabc", {2}}}));
+    ASSERT_EQ(lookup("o"), Names({{"foo", {1}}}));
+
+    // Updating an entry replaces its postings
+    analyze(schema2, "create table bar (xyz integer);");
+    ASSERT_EQ(catalog.LoadScript(schema2, 0), buffers::StatusCode::OK);
+    ASSERT_EQ(lookup("abc"), Names({{"abc", {1}}}));
+    ASSERT_EQ(lookup("xyz"), Names({{"xyz", {2}}}));
+
+    // Dropping an entry removes names without postings
+    catalog.DropScript(schema1);
+    ASSERT_EQ(lookup("abc"), Names());
+    ASSERT_EQ(lookup("o"), Names());
+}
+
+TEST(CatalogTest, FuzzyNameIndex) {
+    Catalog catalog;
+    Script schema{catalog, 1};
+    schema.ReplaceText("create table customer (cust_id integer, region integer); create table costs (c integer);");
+    ASSERT_EQ(schema.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(schema.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(schema.Analyze().second, buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.LoadScript(schema, 0), buffers::StatusCode::OK);
+
+    // Collect the names that match a query with typos
+    auto lookup = [&](std::string_view query, uint32_t max_distance) {
+        std::vector<CatalogNameIndex::FuzzyMatch> matches;
+        catalog.GetNameIndex().FindFuzzyPrefixMatches(fuzzy_ci_string_view{query.data(), query.size()}, max_distance,
+                                                      matches);
+        std::vector<std::pair<std::string_view, uint32_t>> out;
+        for (auto& match : matches) {
+            out.emplace_back(match.postings.text, match.distance);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    using Matches = std::vector<std::pair<std::string_view, uint32_t>>;
+
+    ASSERT_EQ(lookup("custmer", 2), Matches({{"customer", 1}}));
+    ASSERT_EQ(lookup("CUSTMER", 2), Matches({{"customer", 1}}));
+    ASSERT_EQ(lookup("reigon", 2), Matches({{"region", 2}}));
+    ASSERT_EQ(lookup("reigon", 1), Matches());
+    ASSERT_EQ(lookup("cost", 1), Matches({{"costs", 0}, {"cust_id", 1}, {"customer", 1}}));
+    // The first character has to match
+    ASSERT_EQ(lookup("xustomer", 2), Matches());
+
+    // The automaton reports the closest prefix of a single name
+    PrefixEditDistance automaton{"custmer", 2};
+    ASSERT_EQ(automaton.Match("customer"), 1);
+    ASSERT_EQ(automaton.Match("CUSTOMERS"), 1);
+    ASSERT_EQ(automaton.Match("cust"), std::nullopt);
+    ASSERT_EQ(automaton.Match("region"), std::nullopt);
+}
+
+TEST(CatalogTest, FuzzyNameIndexSharedPrefix) {
+    Catalog catalog;
+    Script schema{catalog, 1};
+    schema.ReplaceText("create table cust (custmx integer, custom_id integer, cuxtom integer);");
+    ASSERT_EQ(schema.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(schema.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(schema.Analyze().second, buffers::StatusCode::OK);
+    ASSERT_EQ(catalog.LoadScript(schema, 0), buffers::StatusCode::OK);
+
+    std::vector<CatalogNameIndex::FuzzyMatch> matches;
+    catalog.GetNameIndex().FindFuzzyPrefixMatches("custom", 2, matches);
+    std::vector<std::pair<std::string_view, uint32_t>> found;
+    for (auto& match : matches) {
+        found.emplace_back(match.postings.text, match.distance);
+    }
+    std::sort(found.begin(), found.end());
+
+    // Names that share a matching prefix report their own closest prefix, not the one of the shared prefix
+    using Matches = std::vector<std::pair<std::string_view, uint32_t>>;
+    ASSERT_EQ(found, Matches({{"cust", 2}, {"custmx", 1}, {"custom_id", 0}, {"cuxtom", 1}}));
+}
+
 }  // namespace
@@ -1,5 +1,10 @@
 #include "dashql/analyzer/completion.h"
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <tuple>
+
 #include "gtest/gtest.h"
 #include "dashql/catalog.h"
 #include "dashql/buffers/index_generated.h"
@@ -60,4 +65,243 @@ SELECT s_co
     ASSERT_EQ(names, expected_names);
 }
 
+TEST(CompletionTest, UnresolvedColumnsByStatement) {
+    const std::string_view main_script_text = R"SQL(
+SELECT ps_comment, s_acctbal, ps_comment + 1;
+SELECT n_name;
+    )SQL";
+
+    Catalog catalog;
+    Script external_script{catalog, 1};
+    external_script.InsertTextAt(0, TPCH_SCHEMA);
+    ASSERT_EQ(external_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Analyze().second, buffers::StatusCode::OK);
+    catalog.LoadScript(external_script, 0);
+
+    Script main_script{catalog, 2};
+    main_script.InsertTextAt(0, main_script_text);
+    ASSERT_EQ(main_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(main_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(main_script.Analyze().second, buffers::StatusCode::OK);
+    auto& analyzed = *main_script.analyzed_script;
+
+    // Helper to collect (name, expression count, candidate tables) of a statement
+    auto collect = [&](uint32_t statement_id) {
+        std::vector<std::tuple<std::string, uint32_t, std::vector<std::string>>> out;
+        for (auto& unresolved : analyzed.GetUnresolvedColumnNames(statement_id)) {
+            std::vector<std::string> tables;
+            for (auto& table : unresolved.candidate_tables) {
+                tables.emplace_back(table.get().table_name.table_name.get().text);
+            }
+            out.emplace_back(unresolved.column_name.get().text, unresolved.expression_count, std::move(tables));
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    using Expected = std::vector<std::tuple<std::string, uint32_t, std::vector<std::string>>>;
+    ASSERT_EQ(collect(0), (Expected{{"ps_comment", 2, {"partsupp"}}, {"s_acctbal", 1, {"supplier"}}}));
+    ASSERT_EQ(collect(1), (Expected{{"n_name", 1, {"nation"}}}));
+    ASSERT_TRUE(analyzed.GetUnresolvedColumnNames(2).empty());
+}
+
+TEST(CompletionTest, RefineCachedNames) {
+    Catalog catalog;
+    Script external_script{catalog, 1};
+    external_script.InsertTextAt(0, TPCH_SCHEMA);
+    ASSERT_EQ(external_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Analyze().second, buffers::StatusCode::OK);
+    catalog.LoadScript(external_script, 0);
+
+    // Helper to collect the scored candidates of a completion
+    auto collect = [](Completion& completion) {
+        std::vector<std::pair<std::string, uint32_t>> out;
+        auto& entries = completion.GetHeap().GetEntries();
+        for (auto iter = entries.rbegin(); iter != entries.rend(); ++iter) {
+            out.emplace_back(iter->name, iter->score);
+        }
+        return out;
+    };
+
+    // Type a column name character by character
+    Script main_script{catalog, 2};
+    main_script.InsertTextAt(0, "SELECT s_\n");
+    size_t cursor_ofs = 9;
+    std::vector<std::pair<std::string, uint32_t>> refined;
+    for (char c : std::string_view{"com"}) {
+        main_script.InsertCharAt(cursor_ofs++, c);
+        ASSERT_EQ(main_script.Scan().second, buffers::StatusCode::OK);
+        ASSERT_EQ(main_script.Parse().second, buffers::StatusCode::OK);
+        ASSERT_EQ(main_script.Analyze().second, buffers::StatusCode::OK);
+        main_script.MoveCursor(cursor_ofs);
+        auto [completion, status] = main_script.CompleteAtCursor();
+        ASSERT_EQ(status, buffers::StatusCode::OK);
+
+        // The refined candidates must match a completion without cache
+        auto [uncached, uncached_status] = Completion::Compute(*main_script.cursor, 10);
+        ASSERT_EQ(uncached_status, buffers::StatusCode::OK);
+        ASSERT_EQ(collect(*completion), collect(*uncached));
+        refined = collect(*completion);
+    }
+    ASSERT_EQ(main_script.completion_cache->misses, 1);
+    ASSERT_EQ(main_script.completion_cache->hits, 2);
+    ASSERT_FALSE(refined.empty());
+    ASSERT_EQ(refined[0].first, "s_comment");
+
+    // A catalog change invalidates the cache
+    catalog.LoadScript(external_script, 1);
+    main_script.MoveCursor(cursor_ofs);
+    ASSERT_EQ(main_script.CompleteAtCursor().second, buffers::StatusCode::OK);
+    ASSERT_EQ(main_script.completion_cache->misses, 2);
+}
+
+TEST(CompletionTest, SelectTopCandidates) {
+    Catalog catalog;
+    Script external_script{catalog, 1};
+    external_script.InsertTextAt(0, TPCH_SCHEMA);
+    ASSERT_EQ(external_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Analyze().second, buffers::StatusCode::OK);
+    catalog.LoadScript(external_script, 0);
+
+    Script main_script{catalog, 2};
+    main_script.InsertTextAt(0, "SELECT s\n");
+    ASSERT_EQ(main_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(main_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(main_script.Analyze().second, buffers::StatusCode::OK);
+    main_script.MoveCursor(8);
+
+    // Helper to collect the scored candidates of a completion
+    auto collect = [](Completion& completion) {
+        std::vector<std::pair<std::string, uint32_t>> out;
+        auto& entries = completion.GetHeap().GetEntries();
+        for (auto iter = entries.rbegin(); iter != entries.rend(); ++iter) {
+            out.emplace_back(iter->name, iter->score);
+        }
+        return out;
+    };
+
+    // The pruned top-k must be the prefix of a completion that keeps all candidates
+    auto [all, all_status] = Completion::Compute(*main_script.cursor, 1000);
+    ASSERT_EQ(all_status, buffers::StatusCode::OK);
+    auto all_candidates = collect(*all);
+    ASSERT_GT(all_candidates.size(), 10u);
+    ASSERT_TRUE(std::is_sorted(all_candidates.begin(), all_candidates.end(),
+                               [](auto& l, auto& r) { return l.second > r.second; }));
+    for (size_t k : {1, 3, 10}) {
+        auto [top, top_status] = Completion::Compute(*main_script.cursor, k);
+        ASSERT_EQ(top_status, buffers::StatusCode::OK);
+        auto top_candidates = collect(*top);
+        ASSERT_EQ(top_candidates.size(), k);
+        std::vector<std::pair<std::string, uint32_t>> expected{all_candidates.begin(), all_candidates.begin() + k};
+        ASSERT_EQ(top_candidates, expected) << k;
+    }
+}
+
+TEST(CompletionTest, ConcurrentSessions) {
+    Catalog catalog;
+    Script external_script{catalog, 1};
+    external_script.InsertTextAt(0, TPCH_SCHEMA);
+    ASSERT_EQ(external_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Analyze().second, buffers::StatusCode::OK);
+    catalog.LoadScript(external_script, 0);
+
+    // Every session analyzes and completes its own script against the shared catalog
+    auto complete = [&](CatalogEntryID external_id) {
+        Script script{catalog, external_id};
+        script.InsertTextAt(0, "SELECT s_co\n");
+        std::vector<std::string> names;
+        for (size_t i = 0; i < 20; ++i) {
+            script.Scan();
+            script.Parse();
+            script.Analyze();
+            script.MoveCursor(11);
+            auto [completion, status] = script.CompleteAtCursor();
+            names.clear();
+            if (status != buffers::StatusCode::OK) {
+                break;
+            }
+            auto& entries = completion->GetHeap().GetEntries();
+            for (auto iter = entries.rbegin(); iter != entries.rend(); ++iter) {
+                names.emplace_back(iter->name);
+            }
+        }
+        return names;
+    };
+    auto expected = complete(2);
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected.front(), "s_comment");
+
+    std::vector<std::vector<std::string>> results(8);
+    std::vector<std::thread> sessions;
+    for (size_t i = 0; i < results.size(); ++i) {
+        sessions.emplace_back([&, i] { results[i] = complete(3 + i); });
+    }
+    for (auto& session : sessions) {
+        session.join();
+    }
+    for (auto& names : results) {
+        ASSERT_EQ(names, expected);
+    }
+}
+
+TEST(CompletionTest, DeadlineReturnsPartialResults) {
+    Catalog catalog;
+    Script external_script{catalog, 1};
+    external_script.InsertTextAt(0, TPCH_SCHEMA);
+    ASSERT_EQ(external_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(external_script.Analyze().second, buffers::StatusCode::OK);
+    catalog.LoadScript(external_script, 0);
+
+    Script main_script{catalog, 2};
+    main_script.InsertTextAt(0, "SELECT s_\n");
+    ASSERT_EQ(main_script.Scan().second, buffers::StatusCode::OK);
+    ASSERT_EQ(main_script.Parse().second, buffers::StatusCode::OK);
+    ASSERT_EQ(main_script.Analyze().second, buffers::StatusCode::OK);
+    main_script.MoveCursor(9);
+
+    // Helper to collect the scored candidates of a completion
+    auto collect = [](Completion& completion) {
+        std::vector<std::pair<std::string, uint32_t>> out;
+        auto& entries = completion.GetHeap().GetEntries();
+        for (auto iter = entries.rbegin(); iter != entries.rend(); ++iter) {
+            out.emplace_back(iter->name, iter->score);
+        }
+        return out;
+    };
+
+    // Without a deadline, the completion is complete
+    auto [complete, complete_status] = Completion::Compute(*main_script.cursor, 10);
+    ASSERT_EQ(complete_status, buffers::StatusCode::OK);
+    ASSERT_FALSE(complete->IsPartial());
+    auto complete_candidates = collect(*complete);
+    ASSERT_FALSE(complete_candidates.empty());
+
+    // A distant deadline finds the same candidates
+    auto distant = std::chrono::steady_clock::now() + std::chrono::hours{1};
+    auto [ranked, ranked_status] = Completion::Compute(*main_script.cursor, 10, nullptr, distant);
+    ASSERT_EQ(ranked_status, buffers::StatusCode::OK);
+    ASSERT_FALSE(ranked->IsPartial());
+    ASSERT_EQ(collect(*ranked), complete_candidates);
+
+    // A passed deadline skips the catalog and marks the result as partial
+    auto passed = std::chrono::steady_clock::now() - std::chrono::milliseconds{1};
+    auto [partial, partial_status] = main_script.CompleteAtCursor(10, passed);
+    ASSERT_EQ(partial_status, buffers::StatusCode::OK);
+    ASSERT_TRUE(partial->IsPartial());
+    for (auto& [name, score] : collect(*partial)) {
+        // The cursor name itself may be registered in the script
+        ASSERT_TRUE(name.size() <= 2 || !name.starts_with("s_")) << name;
+    }
+
+    // The packed completion carries the flag
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(partial->Pack(fb));
+    auto packed = flatbuffers::GetRoot<buffers::Completion>(fb.GetBufferPointer());
+    ASSERT_TRUE(packed->partial());
+}
+
 }  // namespace
@@ -0,0 +1,109 @@
+#include "dashql/text/name_interner.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using namespace dashql;
+
+namespace {
+
+TEST(NameInternerTest, EmptyName) {
+    NameInterner interner;
+    ASSERT_EQ(interner.GetSize(), 1);
+    ASSERT_EQ(interner.Find(""), 0);
+    ASSERT_EQ(interner.Intern(""), 0);
+}
+
+TEST(NameInternerTest, StableIds) {
+    NameInterner interner;
+    auto a = interner.Intern("foo");
+    auto b = interner.Intern("bar");
+    ASSERT_NE(a, b);
+    ASSERT_EQ(interner.Intern("foo"), a);
+    ASSERT_EQ(interner.Intern("bar"), b);
+    ASSERT_EQ(interner.Get(a), "foo");
+    ASSERT_EQ(interner.Get(b), "bar");
+    ASSERT_EQ(interner.Find("baz"), std::nullopt);
+    ASSERT_EQ(interner.GetSize(), 3);
+}
+
+TEST(NameInternerTest, CopiesText) {
+    NameInterner interner;
+    InternedNameID id;
+    {
+        std::string text{"some_rather_long_column_name_that_is_not_inlined"};
+        id = interner.Intern(text);
+        text[0] = 'X';
+    }
+    ASSERT_EQ(interner.Get(id), "some_rather_long_column_name_that_is_not_inlined");
+    ASSERT_EQ(interner.Find("some_rather_long_column_name_that_is_not_inlined"), id);
+}
+
+TEST(NameInternerTest, ManyNames) {
+    NameInterner interner;
+    std::vector<InternedNameID> ids;
+    for (size_t i = 0; i < 10000; ++i) {
+        ids.push_back(interner.Intern(std::to_string(i)));
+    }
+    for (size_t i = 0; i < 10000; ++i) {
+        ASSERT_EQ(interner.Get(ids[i]), std::to_string(i));
+        ASSERT_EQ(interner.Find(std::to_string(i)), ids[i]);
+    }
+}
+
+TEST(NameInternerTest, ReleasedNames) {
+    NameInterner interner;
+    auto foo = interner.Intern("foo");
+    ASSERT_EQ(interner.Intern("foo"), foo);
+    ASSERT_EQ(interner.GetReferenceCount(foo), 2);
+
+    // The name stays interned until the last reference is released
+    interner.Release(foo);
+    ASSERT_EQ(interner.Find("foo"), foo);
+    ASSERT_EQ(interner.Get(foo), "foo");
+    auto bytes = interner.GetByteSize();
+    interner.Release(foo);
+    ASSERT_EQ(interner.Find("foo"), std::nullopt);
+    ASSERT_EQ(interner.GetSize(), 1);
+    ASSERT_LT(interner.GetByteSize(), bytes);
+
+    // Released ids are recycled
+    auto bar = interner.Intern("bar");
+    ASSERT_EQ(bar, foo);
+    ASSERT_EQ(interner.Get(bar), "bar");
+    ASSERT_EQ(interner.GetReferenceCount(bar), 1);
+}
+
+TEST(NameInternerTest, BorrowedNames) {
+    NameInterner interner;
+    auto owner = std::make_shared<std::string>("borrowed");
+    std::weak_ptr<std::string> weak_owner = owner;
+    std::string_view text = *owner;
+
+    // The text is not copied, the name keeps its owner alive
+    auto id = interner.Intern(text, owner);
+    ASSERT_EQ(interner.Get(id).data(), text.data());
+    ASSERT_EQ(interner.Intern("borrowed"), id);
+    owner.reset();
+    ASSERT_FALSE(weak_owner.expired());
+    ASSERT_EQ(interner.Find("borrowed"), id);
+
+    // Releasing the last reference releases the owner
+    interner.Release(id);
+    interner.Release(id);
+    ASSERT_TRUE(weak_owner.expired());
+    ASSERT_EQ(interner.Find("borrowed"), std::nullopt);
+}
+
+TEST(NameInternerTest, EmptyNameIsNeverReleased) {
+    NameInterner interner;
+    ASSERT_EQ(interner.Intern(""), 0);
+    interner.Release(0);
+    interner.Release(0);
+    ASSERT_EQ(interner.Find(""), 0);
+    ASSERT_EQ(interner.GetSize(), 1);
+}
+
+}  // namespace
@@ -1,5 +1,7 @@
 #include "dashql/script.h"
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
 #include "dashql/catalog.h"
 #include "dashql/buffers/index_generated.h"
@@ -108,4 +110,84 @@ TEST(ScriptTest, ReplaceText) {
     ASSERT_EQ(script.ToString(), "bar");
 }
 
+TEST(ScriptTest, IncrementalNameSearchIndex) {
+    Catalog catalog;
+    Script script{catalog, 1};
+    auto analyze = [&](std::string_view text) {
+        script.ReplaceText(text);
+        ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Parse().second, buffers::StatusCode::OK);
+        ASSERT_EQ(script.Analyze().second, buffers::StatusCode::OK);
+    };
+    // Collect the names with a suffix prefix, every name is visited once
+    auto lookup = [&](std::string_view prefix) {
+        std::vector<std::string_view> out;
+        script.analyzed_script->GetNameSearchIndex().IteratePrefix(
+            fuzzy_ci_string_view{prefix.data(), prefix.size()},
+            [&](const RegisteredName& name) { out.push_back(name.text); });
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    using Names = std::vector<std::string_view>;
+
+    analyze("select customer_id, customer_name from customers");
+    auto shared_trie = script.analyzed_script->GetNameSearchIndex().GetSharedTrie();
+    ASSERT_NE(shared_trie, nullptr);
+    ASSERT_EQ(script.analyzed_script->GetNameSearchIndex().GetDeltaCount(), 0);
+
+    // The analysis after an edit reuses the trie and only scans the new name
+    analyze("select customer_id, customer_region from customers");
+    auto& index = script.analyzed_script->GetNameSearchIndex();
+    ASSERT_EQ(index.GetSharedTrie(), shared_trie);
+    ASSERT_EQ(index.GetDeltaCount(), 1);
+    ASSERT_EQ(lookup("customer_"), Names({"customer_id", "customer_region"}));
+    ASSERT_EQ(lookup("region"), Names({"customer_region"}));
+    // Names that were removed by the edit are no longer found
+    ASSERT_EQ(lookup("name"), Names());
+}
+
+TEST(ScriptTest, SuccinctNameSearchIndex) {
+    Catalog catalog;
+    Script script{catalog, 1};
+    script.InsertTextAt(0, "select customer_id, Customer_Name, region from customers, orders");
+    ASSERT_EQ(script.Scan().second, buffers::StatusCode::OK);
+    auto& registry = script.scanned_script->name_registry;
+    using Index = CatalogEntry::NameSearchIndex;
+
+    // Collect the names with a suffix prefix, every name is visited once
+    auto lookup = [&](const Index& index, std::string_view prefix) {
+        std::vector<std::string_view> out;
+        index.IteratePrefix(fuzzy_ci_string_view{prefix.data(), prefix.size()},
+                            [&](const RegisteredName& name) { out.push_back(name.text); });
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+
+    // The suffix array finds the same names as the suffix trie
+    Index trie_index{registry};
+    Index array_index{registry, nullptr, Index::Layout::SuffixArray};
+    ASSERT_EQ(trie_index.GetLayout(), Index::Layout::SuffixTrie);
+    ASSERT_EQ(array_index.GetLayout(), Index::Layout::SuffixArray);
+    ASSERT_EQ(array_index.GetEntryCount(), trie_index.GetEntryCount());
+    ASSERT_LT(array_index.GetByteSize(), trie_index.GetByteSize());
+    for (std::string_view prefix : {"", "c", "customer_", "NAME", "ers", "region", "x"}) {
+        ASSERT_EQ(lookup(array_index, prefix), lookup(trie_index, prefix)) << prefix;
+    }
+    // Names with several matching suffixes are visited once
+    using Names = std::vector<std::string_view>;
+    ASSERT_EQ(lookup(array_index, "s"), Names({"customers", "orders"}));
+    ASSERT_EQ(lookup(trie_index, "s"), Names({"customers", "orders"}));
+
+    // The flat buffer can be copied elsewhere, e.g. to a file that is memory-mapped again
+    auto flat = array_index.GetSharedSuffixArray()->GetBuffer();
+    auto copy = std::make_shared<std::vector<std::byte>>(flat.begin(), flat.end());
+    auto opened = SuffixArray::Open(*copy);
+    ASSERT_TRUE(opened.has_value());
+    Index mapped_index{registry, std::make_shared<Index::SharedSuffixArray>(*opened, copy)};
+    ASSERT_EQ(mapped_index.GetDeltaCount(), 0);
+    for (std::string_view prefix : {"", "c", "customer_", "NAME", "ers", "region", "x"}) {
+        ASSERT_EQ(lookup(mapped_index, prefix), lookup(trie_index, prefix)) << prefix;
+    }
+}
+
 }  // namespace
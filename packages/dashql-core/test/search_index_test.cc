@@ -0,0 +1,114 @@
+#include "dashql/search/search_index.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "dashql/catalog.h"
+#include "dashql/script.h"
+
+using namespace dashql;
+
+namespace {
+
+struct SearchIndexTest : public ::testing::Test {
+    /// The catalog
+    Catalog catalog;
+    /// The scripts
+    std::vector<std::unique_ptr<Script>> scripts;
+
+    /// Scan a text
+    ScannedScript& Scan(std::string_view text) {
+        auto& script = scripts.emplace_back(std::make_unique<Script>(catalog, static_cast<CatalogEntryID>(scripts.size() + 1)));
+        script->InsertTextAt(0, text);
+        auto [scanned, status] = script->Scan();
+        EXPECT_EQ(status, buffers::StatusCode::OK);
+        return *scanned;
+    }
+    /// Collect the file names and offsets of the matches
+    static std::vector<std::pair<std::string, size_t>> Collect(const std::vector<FileSearchMatch>& matches) {
+        std::vector<std::pair<std::string, size_t>> out;
+        for (auto& match : matches) {
+            out.emplace_back(match.file_name, match.location.offset());
+        }
+        return out;
+    }
+};
+
+using Matches = std::vector<std::pair<std::string, size_t>>;
+
+TEST_F(SearchIndexTest, FindText) {
+    SearchIndex index;
+    index.AddFile("a.sql", Scan("select customer_id from customers"));
+    index.AddFile("b.sql", Scan("select o_orderkey from orders where o_custkey = 42"));
+    ASSERT_EQ(index.GetFileCount(), 2);
+
+    ASSERT_EQ(Collect(index.SearchFile("customer")), Matches({{"a.sql", 7}, {"a.sql", 24}}));
+    ASSERT_EQ(Collect(index.SearchFile("CUSTOMERS")), Matches({{"a.sql", 24}}));
+    ASSERT_EQ(Collect(index.SearchFile("select")), Matches({{"a.sql", 0}, {"b.sql", 0}}));
+    ASSERT_EQ(Collect(index.SearchFile("42")), Matches({{"b.sql", 48}}));
+    ASSERT_EQ(Collect(index.SearchFile("custkey")), Matches({{"b.sql", 38}}));
+    // All trigrams occur in b.sql, but not adjacent
+    ASSERT_EQ(Collect(index.SearchFile("o_orders")), Matches());
+    ASSERT_EQ(Collect(index.SearchFile("not_exists")), Matches());
+    ASSERT_EQ(Collect(index.SearchFile("")), Matches());
+    ASSERT_EQ(index.SearchFile("e", 3).size(), 3);
+
+    // Matches within names reference the label
+    auto matches = index.SearchFile("orderkey");
+    ASSERT_EQ(matches.size(), 1);
+    ASSERT_NE(matches[0].label, nullptr);
+    ASSERT_EQ(matches[0].label->text, "o_orderkey");
+}
+
+TEST_F(SearchIndexTest, RemoveAndCompact) {
+    SearchIndex index;
+    for (size_t i = 0; i < 4; ++i) {
+        index.AddFile("file_" + std::to_string(i) + ".sql", Scan("select * from table_" + std::to_string(i)));
+    }
+    auto total = index.GetTotalStatistics();
+    ASSERT_EQ(total.label_count, 4);
+    ASSERT_GT(total.trigram_count, 0);
+    auto file_stats = *index.GetFileStatistics("file_0.sql");
+    ASSERT_EQ(file_stats.text_bytes, 21);
+
+    // Removed files leave a tombstone and are no longer found
+    index.RemoveFile("file_0.sql");
+    ASSERT_EQ(index.GetFileCount(), 3);
+    ASSERT_EQ(index.GetTombstoneCount(), 1);
+    ASSERT_EQ(index.GetFileStatistics("file_0.sql"), nullptr);
+    ASSERT_EQ(index.GetDeadStatistics().text_bytes, file_stats.text_bytes);
+    ASSERT_EQ(Collect(index.SearchFile("table_0")), Matches());
+    ASSERT_EQ(Collect(index.SearchFile("table_1")), Matches({{"file_1.sql", 14}}));
+
+    // Replacing a file removes its old version
+    index.AddFile("file_1.sql", Scan("select 1"));
+    ASSERT_EQ(index.GetTombstoneCount(), 2);
+    ASSERT_EQ(Collect(index.SearchFile("table_1")), Matches());
+    ASSERT_EQ(Collect(index.SearchFile("select 1")), Matches({{"file_1.sql", 0}}));
+
+    // Compacting drops the dead files
+    index.Compact();
+    ASSERT_EQ(index.GetTombstoneCount(), 0);
+    ASSERT_EQ(index.GetDeadStatistics().text_bytes, 0);
+    ASSERT_EQ(index.GetTotalStatistics().label_count, 2);
+    ASSERT_EQ(Collect(index.SearchFile("table_")), Matches({{"file_2.sql", 14}, {"file_3.sql", 14}}));
+    auto matches = index.SearchFile("table_3");
+    ASSERT_EQ(matches.size(), 1);
+    ASSERT_NE(matches[0].label, nullptr);
+    ASSERT_EQ(matches[0].label->text, "table_3");
+}
+
+TEST_F(SearchIndexTest, CompactWhenMostlyDead) {
+    SearchIndex index;
+    index.AddFile("a.sql", Scan("select 1"));
+    index.AddFile("b.sql", Scan("select 2"));
+    index.AddFile("c.sql", Scan("select 3"));
+    index.RemoveFile("a.sql");
+    ASSERT_EQ(index.GetTombstoneCount(), 1);
+    // Two of three files are dead, the index compacts itself
+    index.RemoveFile("b.sql");
+    ASSERT_EQ(index.GetTombstoneCount(), 0);
+    ASSERT_EQ(Collect(index.SearchFile("select")), Matches({{"c.sql", 0}}));
+}
+
+}  // namespace
@@ -0,0 +1,97 @@
+#include "dashql/utils/suffix_array.h"
+
+#include <initializer_list>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using namespace dashql;
+
+namespace {
+
+void test_prefix(const SuffixArray& array, std::string_view prefix, std::initializer_list<std::string_view> suffixes) {
+    std::vector<std::string_view> have;
+    array.IteratePrefix(SuffixArray::StringView{prefix.data(), prefix.size()},
+                        [&](size_t text_id, size_t offset) { have.push_back(array.GetText(text_id).substr(offset)); });
+    std::vector<std::string_view> want{suffixes};
+    ASSERT_EQ(have, want) << prefix;
+}
+
+TEST(SuffixArrayTest, Prefixes0) {
+    std::vector<std::string_view> texts{"foo", "bar"};
+    auto buffer = SuffixArray::Build(texts);
+    auto array = SuffixArray::Open(buffer);
+    ASSERT_TRUE(array.has_value());
+    ASSERT_EQ(array->GetTextCount(), 2);
+    ASSERT_EQ(array->GetSuffixCount(), 6);
+    test_prefix(*array, "f", {"foo"});
+    test_prefix(*array, "fo", {"foo"});
+    test_prefix(*array, "foo", {"foo"});
+    test_prefix(*array, "b", {"bar"});
+    test_prefix(*array, "bar", {"bar"});
+    test_prefix(*array, "barr", {});
+    test_prefix(*array, "baar", {});
+    test_prefix(*array, "", {"ar", "bar", "foo", "o", "oo", "r"});
+    test_prefix(*array, "not_exists", {});
+}
+
+TEST(SuffixArrayTest, CaseSensitivity) {
+    std::vector<std::string_view> texts{"Some", "CaSE", "SensitiVe", "sensitive"};
+    auto buffer = SuffixArray::Build(texts);
+    auto array = SuffixArray::Open(buffer);
+    ASSERT_TRUE(array.has_value());
+    test_prefix(*array, "Som", {"Some"});
+    test_prefix(*array, "som", {"Some"});
+    test_prefix(*array, "cas", {"CaSE"});
+    test_prefix(*array, "sens", {"SensitiVe", "sensitive"});
+    test_prefix(*array, "TIVE", {"tiVe", "tive"});
+
+    // Texts are found with their exact characters
+    ASSERT_EQ(array->FindText("SensitiVe"), 2);
+    ASSERT_EQ(array->FindText("sensitive"), 3);
+    ASSERT_EQ(array->FindText("SENSITIVE"), std::nullopt);
+    ASSERT_EQ(array->FindText("Sensiti"), std::nullopt);
+    ASSERT_EQ(array->FindText("ase"), std::nullopt);
+}
+
+TEST(SuffixArrayTest, LongCommonPrefixes) {
+    // The LCP values saturate, longer prefixes have to be compared explicitly
+    std::string a(300, 'a');
+    std::string b = a + "b";
+    std::string c = a + "c";
+    std::vector<std::string_view> texts{b, c};
+    auto buffer = SuffixArray::Build(texts);
+    auto array = SuffixArray::Open(buffer);
+    ASSERT_TRUE(array.has_value());
+    std::string ab = a + "b";
+    test_prefix(*array, ab, {b});
+    // Suffixes with at least 256 leading characters
+    std::string_view prefix{a.data(), 256};
+    size_t matches = 0;
+    array->IteratePrefix(SuffixArray::StringView{prefix.data(), prefix.size()}, [&](size_t, size_t offset) {
+        ASSERT_LE(offset, 44);
+        ++matches;
+    });
+    ASSERT_EQ(matches, 90);
+}
+
+TEST(SuffixArrayTest, Empty) {
+    std::vector<std::string_view> texts;
+    auto buffer = SuffixArray::Build(texts);
+    auto array = SuffixArray::Open(buffer);
+    ASSERT_TRUE(array.has_value());
+    test_prefix(*array, "", {});
+    test_prefix(*array, "a", {});
+}
+
+TEST(SuffixArrayTest, InvalidBuffers) {
+    std::vector<std::string_view> texts{"foo", "bar"};
+    auto buffer = SuffixArray::Build(texts);
+    ASSERT_FALSE(SuffixArray::Open(std::span<const std::byte>{buffer.data(), buffer.size() - 1}).has_value());
+    ASSERT_FALSE(SuffixArray::Open(std::span<const std::byte>{buffer.data(), 8}).has_value());
+    auto corrupted = buffer;
+    corrupted[0] = std::byte{0};
+    ASSERT_FALSE(SuffixArray::Open(corrupted).has_value());
+}
+
+}  // namespace
@@ -79,4 +79,35 @@ TEST(SuffixTrieTest, CaseSensitivity) {
     test_prefix(*trie, "sens", {"SensitiVe", "sensitive"});
 }
 
+TEST(SuffixTrieTest, MissingChildren) {
+    std::vector<SuffixTrie::StringView> entries;
+    // The root is an inner node with 4 children, the last child is an inner node
+    entries = {"a", "b", "c", "da", "db"};
+    auto trie4 = SuffixTrie::BulkLoad(entries, [&](size_t i, auto& name) {
+        return SuffixTrie::Entry{name, i, buffers::NameTag::NONE};
+    });
+    test_prefix(*trie4, "x", {});
+    test_prefix(*trie4, "d", {"da", "db"});
+    test_prefix(*trie4, "a", {"a", "a"});
+
+    // The root is an inner node with 48 children, the first child is an inner node
+    entries = {"abcdefghijklmnopqrs", "ax"};
+    auto trie48 = SuffixTrie::BulkLoad(entries, [&](size_t i, auto& name) {
+        return SuffixTrie::Entry{name, i, buffers::NameTag::NONE};
+    });
+    test_prefix(*trie48, "z", {});
+    test_prefix(*trie48, "a", {"abcdefghijklmnopqrs", "ax"});
+    test_prefix(*trie48, "ab", {"abcdefghijklmnopqrs"});
+    test_prefix(*trie48, "s", {"s"});
+}
+
+TEST(SuffixTrieTest, Empty) {
+    std::vector<SuffixTrie::StringView> entries;
+    auto trie = SuffixTrie::BulkLoad(entries, [&](size_t i, auto& name) {
+        return SuffixTrie::Entry{name, i, buffers::NameTag::NONE};
+    });
+    test_prefix(*trie, "", {});
+    test_prefix(*trie, "a", {});
+}
+
 }  // namespace